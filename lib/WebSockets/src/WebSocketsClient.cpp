@@ -19,6 +19,7 @@ WebSocketsClient::WebSocketsClient() {
     _reconnectInterval   = 500;
     _port                = 0;
     _host                = "";
+    _lastHandshakeCode   = 0;
 }
 
 WebSocketsClient::~WebSocketsClient() {
@@ -28,6 +29,7 @@ WebSocketsClient::~WebSocketsClient() {
 void WebSocketsClient::begin(const char * host, uint16_t port, const char * url, const char * protocol) {
     _host = host;
     _port = port;
+    _lastHandshakeCode = 0;
 
     _client.num                 = 0;
     _client.status              = WSC_NOT_CONNECTED;
@@ -388,6 +390,7 @@ void WebSocketsClient::handleHeader(WSclient_t * client, String * headerLine) {
     client->status = WSC_HEADER;
 
     bool ok = (client->cIsUpgrade && client->cIsWebsocket);
+    _lastHandshakeCode = client->cCode;
 
     if(ok && client->cCode != 101) {
         Serial.printf("[WS-Client] Bad HTTP code %d, expected 101\n", client->cCode);
@@ -104,6 +104,16 @@ class WebSocketsClient : protected WebSockets {
 
     bool isConnected(void);
 
+    // HTTP status of the last handshake response (101 on success, e.g. 401
+    // when the server rejected the credentials). Survives the disconnect.
+    uint16_t getLastHandshakeCode(void) { return _lastHandshakeCode; }
+
+    // For callers that sleep in select() between loop() calls: the socket
+    // (-1 without a TCP connection) and bytes already buffered by the
+    // client, which select() does not report.
+    int getSocketFd(void) { return (_client.tcp && _client.tcp->connected()) ? _client.tcp->fd() : -1; }
+    int getPendingBytes(void) { return _client.tcp ? _client.tcp->available() : 0; }
+
   protected:
     String _host;
     uint16_t _port;
@@ -129,6 +139,7 @@ class WebSocketsClient : protected WebSockets {
     WebSocketClientEvent _cbEvent;
 
     unsigned long _lastConnectionFail;
+    uint16_t _lastHandshakeCode;
     unsigned long _reconnectInterval;
     unsigned long _lastHeaderSent;
 
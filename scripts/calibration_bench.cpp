@@ -0,0 +1,451 @@
+// Host check and benchmark for the compiled calibration tables
+// (src/calibration_lut.h).
+//
+//   g++ -O2 -std=c++17 -pthread -Isrc -Iinclude scripts/calibration_bench.cpp
+//       src/calibration_lut.cpp -o calibration_bench && ./calibration_bench [--full]
+//
+// For a set of curves (the shipped defaults plus awkward ones: descending
+// angles or values, non-monotone points, duplicate points, negative values,
+// an all-zero blank config) it compares the compiled table against a verbatim
+// copy of the float gauge_value_to_angle_screen() it replaced, and the
+// clamped legacy mapping against gauge_top_value_to_angle(). The default run
+// checks a strided sweep over every float bit pattern plus a dense window
+// around every calibration point and every table step; --full checks all
+// 2^32 inputs. It then times both lookups, and a "precomputed slope" segment
+// table to show why that form cannot reproduce the current output.
+//
+// A second set of longer curves (up to 32 points, linear, cubic and log)
+// checks each table against its reference mapping the same way and compares
+// the lookup with a budget: no slower than the old float function on the
+// 5-point RPM curve. The 5-point rows above double as the migration check,
+// since a stored 5-point calibration becomes a CAL_LINEAR curve.
+//
+// The budget is measured next to each table, not once up front: budget and
+// lookup rounds alternate (BUDGET_ROUNDS of each, a pinned 4 x 65536 calls
+// per round) and the medians are compared, so both see the same machine
+// state. A mismatch or a table over budget fails the run.
+#include "calibration_lut.h"
+#include "calibration_types.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+// --- verbatim copies of the functions being replaced --------------------------
+
+static int16_t orig_screen(float value, const GaugeCalibrationPoint *cal) {
+    for (int i = 0; i < 4; i++) {
+        float val1 = cal[i].value;
+        float val2 = cal[i + 1].value;
+        int16_t angle1 = cal[i].angle;
+        int16_t angle2 = cal[i + 1].angle;
+        if ((val1 <= val2 && value >= val1 && value <= val2) ||
+            (val1 > val2 && value >= val2 && value <= val1)) {
+            float value_range = val2 - val1;
+            if (fabs(value_range) < 0.001) return angle1;
+            float normalized = (value - val1) / value_range;
+            int16_t result;
+            if (angle2 < angle1) {
+                result = angle1 - (int16_t)(normalized * abs(angle2 - angle1));
+            } else {
+                result = angle1 + (int16_t)(normalized * abs(angle2 - angle1));
+            }
+            return result;
+        }
+    }
+    if (value < cal[0].value) return cal[0].angle;
+    return cal[4].angle;
+}
+
+struct Legacy {
+    float top_values[5];
+    int16_t top_angles[5];
+};
+
+static int16_t orig_top(float value, const Legacy &cfg) {
+    if (value <= cfg.top_values[0]) return cfg.top_angles[0];
+    if (value >= cfg.top_values[5 - 1]) return cfg.top_angles[5 - 1];
+    for (int i = 0; i < 5 - 1; i++) {
+        if (value >= cfg.top_values[i] && value <= cfg.top_values[i + 1]) {
+            float value_range = cfg.top_values[i + 1] - cfg.top_values[i];
+            if (value_range <= 0) return cfg.top_angles[i];
+            float normalized = (value - cfg.top_values[i]) / value_range;
+            int16_t angle_range = cfg.top_angles[i + 1] - cfg.top_angles[i];
+            return cfg.top_angles[i] + (int16_t)(normalized * angle_range);
+        }
+    }
+    return cfg.top_angles[0];
+}
+
+// --- precomputed-slope segment table (the rejected design) -------------------
+
+struct SlopeTable {
+    float lo[4], hi[4], base[4], slope[4];
+    int16_t below, above;
+};
+
+static SlopeTable slope_compile(const GaugeCalibrationPoint *cal) {
+    SlopeTable t;
+    for (int i = 0; i < 4; i++) {
+        float v1 = cal[i].value, v2 = cal[i + 1].value;
+        t.lo[i] = std::min(v1, v2);
+        t.hi[i] = std::max(v1, v2);
+        t.base[i] = (float)cal[i].angle - v1 * ((float)(cal[i + 1].angle - cal[i].angle) / (v2 - v1));
+        t.slope[i] = fabsf(v2 - v1) < 0.001f ? 0 : (float)(cal[i + 1].angle - cal[i].angle) / (v2 - v1);
+        if (t.slope[i] == 0) t.base[i] = (float)cal[i].angle;
+    }
+    t.below = (int16_t)cal[0].angle;
+    t.above = (int16_t)cal[4].angle;
+    return t;
+}
+
+static int16_t slope_lookup(const SlopeTable &t, float v, const GaugeCalibrationPoint *cal) {
+    for (int i = 0; i < 4; i++) {
+        if (v >= t.lo[i] && v <= t.hi[i]) return (int16_t)(t.base[i] + v * t.slope[i]);
+    }
+    return v < cal[0].value ? t.below : t.above;
+}
+
+// --- curves ------------------------------------------------------------------
+
+struct TestCurve {
+    const char *name;
+    GaugeCalibrationPoint cal[5];
+};
+
+static const TestCurve curves[] = {
+    {"rpm 0-60 Hz", {{0, 0.0f}, {90, 15.0f}, {180, 30.0f}, {270, 45.0f}, {360, 60.0f}}},
+    {"coolant K", {{0, 313.15f}, {90, 333.15f}, {180, 353.15f}, {270, 373.15f}, {360, 393.15f}}},
+    {"exhaust K", {{0, 473.15f}, {90, 548.15f}, {180, 623.15f}, {270, 698.15f}, {360, 973.15f}}},
+    {"oil Pa", {{0, 0.0f}, {90, 150000.0f}, {180, 300000.0f}, {270, 450000.0f}, {360, 600000.0f}}},
+    {"fuel ratio ccw", {{300, 0.0f}, {240, 0.25f}, {180, 0.5f}, {120, 0.75f}, {60, 1.0f}}},
+    {"values desc", {{0, 100.0f}, {90, 75.0f}, {180, 50.0f}, {270, 25.0f}, {360, 0.0f}}},
+    {"non-monotone", {{0, 0.0f}, {120, 50.0f}, {60, 20.0f}, {300, 80.0f}, {200, 60.0f}}},
+    {"duplicates", {{0, 0.0f}, {45, 0.0f}, {90, 10.0f}, {200, 10.0f}, {300, 20.0f}}},
+    {"near-dup", {{10, 1.0f}, {20, 1.0005f}, {30, 2.0f}, {40, 2.0f}, {50, 3.0f}}},
+    {"negatives", {{-30, -40.0f}, {0, -10.0f}, {45, 0.0f}, {180, 25.0f}, {270, 120.0f}}},
+    {"blank", {{0, 0.0f}, {0, 0.0f}, {0, 0.0f}, {0, 0.0f}, {0, 0.0f}}},
+    {"wide angles", {{0, 0.0f}, {700, 1.0f}, {1400, 2.0f}, {2100, 3.0f}, {2800, 4.0f}}},
+};
+static const int NCURVES = sizeof(curves) / sizeof(curves[0]);
+
+static CalCurve to_curve(const GaugeCalibrationPoint *cal) {
+    CalCurve c;
+    for (int i = 0; i < 5; i++) {
+        c.values[i] = cal[i].value;
+        c.angles[i] = (int16_t)cal[i].angle;
+    }
+    c.n = 5;
+    c.mode = CAL_LINEAR;
+    return c;
+}
+
+static Legacy to_legacy(const GaugeCalibrationPoint *cal) {
+    Legacy l;
+    for (int i = 0; i < 5; i++) {
+        l.top_values[i] = cal[i].value;
+        l.top_angles[i] = (int16_t)cal[i].angle;
+    }
+    return l;
+}
+
+static float bits_float(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static uint32_t float_bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+// Runs check(u) for u in [lo, hi) step `stride` on all cores; returns mismatches
+template <typename F>
+static uint64_t sweep(uint64_t lo, uint64_t hi, uint64_t stride, F check) {
+    unsigned nt = std::max(1u, std::thread::hardware_concurrency());
+    std::atomic<uint64_t> bad(0);
+    std::vector<std::thread> threads;
+    uint64_t steps = (hi - lo + stride - 1) / stride;
+    for (unsigned t = 0; t < nt; t++) {
+        threads.emplace_back([&, t]() {
+            uint64_t local = 0;
+            for (uint64_t s = t; s < steps; s += nt) {
+                if (!check((uint32_t)(lo + s * stride))) local++;
+            }
+            bad += local;
+        });
+    }
+    for (auto &th : threads) th.join();
+    return bad;
+}
+
+// Dense windows of +-span bit patterns around each point (both signs of
+// zero included) and around every table step
+static std::vector<uint32_t> window_centres(const CalCurve &curve, const CalLut &lut) {
+    std::vector<uint32_t> c = {0x00000000u, 0x80000000u, 0x7F800000u, 0xFF800000u};
+    for (int i = 0; i < curve.n; i++) c.push_back(float_bits(curve.values[i]));
+    for (int i = 0; i < lut.count; i++) {
+        uint32_t k = lut.keys[i];
+        c.push_back((k & 0x80000000u) ? (k & 0x7FFFFFFFu) : ~k);
+    }
+    return c;
+}
+
+template <typename F>
+static uint64_t check_windows(const std::vector<uint32_t> &centres, uint32_t span, F check) {
+    uint64_t bad = 0;
+    for (uint32_t centre : centres) {
+        for (int64_t d = -(int64_t)span; d <= (int64_t)span; d++) {
+            if (!check((uint32_t)((int64_t)centre + d))) bad++;
+        }
+    }
+    return bad;
+}
+
+// Best of five rounds, ns per call
+static double time_ns(const std::vector<float> &in, int16_t (*fn)(float, const void *), const void *ctx) {
+    volatile int32_t sink = 0;
+    double best = 1e30;
+    for (int round = 0; round < 5; round++) {
+        int32_t acc = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < 4; rep++) {
+            for (float v : in) acc += fn(v, ctx);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        sink = acc;
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / (4.0 * in.size()));
+    }
+    (void)sink;
+    return best;
+}
+
+// One timing round: a pinned number of calls, ns per call
+static double time_round(const std::vector<float> &in, int16_t (*fn)(float, const void *), const void *ctx) {
+    volatile int32_t sink = 0;
+    int32_t acc = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < 4; rep++) {
+        for (float v : in) acc += fn(v, ctx);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    sink = acc;
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / (4.0 * in.size());
+}
+
+static double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+static const int BUDGET_ROUNDS = 15;
+
+static std::vector<float> timing_inputs(std::mt19937 &rng, float lo, float hi) {
+    float margin = (hi - lo) * 0.1f + 1.0f;
+    std::uniform_real_distribution<float> dist(lo - margin, hi + margin);
+    std::vector<float> in(1 << 16);
+    for (float &v : in) v = dist(rng);
+    return in;
+}
+
+static int16_t run_orig(float v, const void *ctx) {
+    return orig_screen(v, (const GaugeCalibrationPoint *)ctx);
+}
+static int16_t run_lut(float v, const void *ctx) {
+    return cal_lut_lookup((const CalLut *)ctx, v);
+}
+struct SlopeCtx {
+    SlopeTable t;
+    const GaugeCalibrationPoint *cal;
+};
+static int16_t run_slope(float v, const void *ctx) {
+    const SlopeCtx *s = (const SlopeCtx *)ctx;
+    return slope_lookup(s->t, v, s->cal);
+}
+
+// --- longer curves in every mode ---------------------------------------------
+
+struct ModeCurve {
+    char name[24];
+    CalCurve c;
+};
+
+static void add_curve(std::vector<ModeCurve> &out, const char *name, uint8_t mode,
+                      const std::vector<std::pair<float, int>> &pts) {
+    ModeCurve m = {};
+    snprintf(m.name, sizeof(m.name), "%s", name);
+    m.c.mode = mode;
+    m.c.n = (uint8_t)pts.size();
+    for (size_t i = 0; i < pts.size(); i++) {
+        m.c.values[i] = pts[i].first;
+        m.c.angles[i] = (int16_t)pts[i].second;
+    }
+    const char *err = cal_curve_prepare(&m.c);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", name, err);
+        exit(2);
+    }
+    out.push_back(m);
+}
+
+static std::vector<ModeCurve> mode_curves() {
+    std::vector<ModeCurve> out;
+    // Tank level (ratio) on a hull-shaped tank, sender read through the
+    // gauge face's uneven scale
+    std::vector<std::pair<float, int>> tank = {{0.0f, 0},    {0.05f, 10},  {0.1f, 24},  {0.2f, 58},
+                                               {0.3f, 95},   {0.4f, 130},  {0.5f, 165}, {0.6f, 198},
+                                               {0.7f, 228},  {0.8f, 262},  {0.9f, 300}, {1.0f, 330}};
+    add_curve(out, "tank 12 linear", CAL_LINEAR, tank);
+    add_curve(out, "tank 12 cubic", CAL_CUBIC, tank);
+    // Exhaust pyrometer face compressed at the top: 20 points, K
+    std::vector<std::pair<float, int>> pyro;
+    for (int i = 0; i < 20; i++) pyro.push_back({373.15f + 40.0f * i, (int)lround(270 * sqrt(i / 19.0))});
+    add_curve(out, "pyro 20 linear", CAL_LINEAR, pyro);
+    add_curve(out, "pyro 20 cubic", CAL_CUBIC, pyro);
+    // Counter-clockwise 32 points
+    std::vector<std::pair<float, int>> ccw;
+    for (int i = 0; i < 32; i++) ccw.push_back({2.0f * i, 300 - i * i * 300 / 961});
+    add_curve(out, "ccw 32 cubic", CAL_CUBIC, ccw);
+    add_curve(out, "ccw 32 linear", CAL_LINEAR, ccw);
+    // Up then down (an extremum for the cubic's tangent limiter)
+    std::vector<std::pair<float, int>> hump;
+    for (int i = 0; i < 32; i++) hump.push_back({0.5f * i, i < 16 ? i * 17 : (31 - i) * 17});
+    add_curve(out, "hump 32 cubic", CAL_CUBIC, hump);
+    // Decades, for log
+    std::vector<std::pair<float, int>> decades = {{0.1f, 0}, {1.0f, 90}, {10.0f, 180}, {100.0f, 270}, {1000.0f, 360}};
+    add_curve(out, "decades 5 log", CAL_LOG, decades);
+    std::vector<std::pair<float, int>> wide;
+    for (int i = 0; i < 32; i++) wide.push_back({powf(10.0f, i / 5.0f), i * 10});
+    add_curve(out, "1-1e6 32 log", CAL_LOG, wide);
+    return out;
+}
+
+static int16_t run_mode_ref(float v, const void *ctx) {
+    const CalCurve *c = (const CalCurve *)ctx;
+    return cal_ref_for_mode(c->mode)(v, c);
+}
+
+int main(int argc, char **argv) {
+    bool full = argc > 1 && strcmp(argv[1], "--full") == 0;
+    uint64_t stride = full ? 1 : 257;
+    printf("%-16s %6s %6s %12s %12s %12s %9s %9s %9s\n", "curve", "steps", "build", "lut bad",
+           "legacy bad", "slope bad", "ref ns", "lut ns", "slope ns");
+    std::mt19937 rng(1);
+    uint64_t total_bad = 0;
+    for (int n = 0; n < NCURVES; n++) {
+        const GaugeCalibrationPoint *cal = curves[n].cal;
+        CalCurve curve = to_curve(cal);
+        CalLut lut = {};
+        auto b0 = std::chrono::steady_clock::now();
+        bool built = cal_lut_build(&lut, cal_ref_segments, &curve);
+        auto b1 = std::chrono::steady_clock::now();
+        double build_us = std::chrono::duration<double, std::micro>(b1 - b0).count();
+
+        // What the firmware returns: table when built, float reference otherwise
+        auto check_lut = [&](uint32_t u) {
+            float v = bits_float(u);
+            int16_t want = orig_screen(v, cal);
+            int16_t got = built ? cal_lut_lookup(&lut, v) : cal_ref_segments(v, &curve);
+            return want == got;
+        };
+        uint64_t bad = sweep(0, 1ull << 32, stride, check_lut);
+        if (!full) bad += check_windows(window_centres(curve, lut), 1 << 16, check_lut);
+
+        Legacy legacy = to_legacy(cal);
+        CalLut legacy_lut = {};
+        bool legacy_built = cal_lut_build(&legacy_lut, cal_ref_clamped, &curve);
+        auto check_legacy = [&](uint32_t u) {
+            float v = bits_float(u);
+            int16_t want = orig_top(v, legacy);
+            int16_t got = legacy_built ? cal_lut_lookup(&legacy_lut, v) : cal_ref_clamped(v, &curve);
+            return want == got;
+        };
+        uint64_t legacy_bad = sweep(0, 1ull << 32, stride, check_legacy);
+        if (!full) legacy_bad += check_windows(window_centres(curve, legacy_lut), 1 << 16, check_legacy);
+
+        SlopeCtx sc = {slope_compile(cal), cal};
+        uint64_t slope_bad = sweep(0, 1ull << 32, full ? 1 : 4099, [&](uint32_t u) {
+            float v = bits_float(u);
+            return std::isnan(v) || orig_screen(v, cal) == slope_lookup(sc.t, v, cal);
+        });
+
+        // Timing: values across the calibrated range plus 10% either side
+        float lo = cal[0].value, hi = cal[0].value;
+        for (int i = 1; i < 5; i++) {
+            lo = std::min(lo, cal[i].value);
+            hi = std::max(hi, cal[i].value);
+        }
+        std::vector<float> in = timing_inputs(rng, lo, hi);
+        double ref_ns = time_ns(in, run_orig, cal);
+        double lut_ns = built ? time_ns(in, run_lut, &lut) : 0;
+        double slope_ns = time_ns(in, run_slope, &sc);
+
+        char build[16];
+        if (built) {
+            snprintf(build, sizeof(build), "%.0fus", build_us);
+        } else {
+            snprintf(build, sizeof(build), "fallbk");
+        }
+        printf("%-16s %6u %6s %12llu %12llu %12llu %9.2f %9.2f %9.2f\n", curves[n].name, lut.count, build,
+               (unsigned long long)bad, (unsigned long long)legacy_bad, (unsigned long long)slope_bad,
+               ref_ns, lut_ns, slope_ns);
+        total_bad += bad + legacy_bad;
+        cal_lut_free(&lut);
+        cal_lut_free(&legacy_lut);
+    }
+
+    // Budget: a table lookup on any curve must cost no more than the float
+    // 5-point function did on the default RPM curve
+    std::vector<float> rpm_in = timing_inputs(rng, 0.0f, 60.0f);
+    printf("\nbudget: float 5-point rpm, median of %d rounds alternating with the lookup's\n", BUDGET_ROUNDS);
+    printf("%-16s %6s %6s %12s %9s %9s %9s\n", "curve", "steps", "build", "lut bad", "ref ns", "budget", "lut ns");
+    int over_budget = 0;
+    for (ModeCurve &m : mode_curves()) {
+        CalLut lut = {};
+        CalRefFn ref = cal_ref_for_mode(m.c.mode);
+        auto b0 = std::chrono::steady_clock::now();
+        bool built = cal_lut_build(&lut, ref, &m.c);
+        auto b1 = std::chrono::steady_clock::now();
+        if (!built) {
+            printf("%-16s table not built\n", m.name);
+            total_bad++;
+            continue;
+        }
+        auto check = [&](uint32_t u) {
+            float v = bits_float(u);
+            return ref(v, &m.c) == cal_lut_lookup(&lut, v);
+        };
+        uint64_t bad = sweep(0, 1ull << 32, stride, check);
+        if (!full) bad += check_windows(window_centres(m.c, lut), 1 << 16, check);
+        std::vector<float> in = timing_inputs(rng, m.c.values[0], m.c.values[m.c.n - 1]);
+        double ref_ns = time_ns(in, run_mode_ref, &m.c);
+        std::vector<double> budget_rounds, lut_rounds;
+        for (int r = 0; r < BUDGET_ROUNDS; r++) {
+            budget_rounds.push_back(time_round(rpm_in, run_orig, curves[0].cal));
+            lut_rounds.push_back(time_round(in, run_lut, &lut));
+        }
+        double budget_ns = median(budget_rounds);
+        double lut_ns = median(lut_rounds);
+        bool over = lut_ns > budget_ns;
+        if (over) over_budget++;
+        printf("%-16s %6u %4.0fus %12llu %9.2f %9.2f %9.2f%s\n", m.name, lut.count,
+               std::chrono::duration<double, std::micro>(b1 - b0).count(), (unsigned long long)bad, ref_ns,
+               budget_ns, lut_ns, over ? "  over budget" : "");
+        total_bad += bad;
+        cal_lut_free(&lut);
+    }
+
+    printf("%s: %llu mismatches, %d over budget (%s)\n", total_bad || over_budget ? "FAIL" : "OK",
+           (unsigned long long)total_bad, over_budget,
+           full ? "all 2^32 inputs" : "strided sweep + windows; --full for all 2^32 inputs");
+    return total_bad || over_budget ? 1 : 0;
+}
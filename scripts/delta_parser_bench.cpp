@@ -0,0 +1,211 @@
+// Host benchmark for the streaming Signal K delta parser.
+//
+//   g++ -O2 -std=c++17 -Isrc scripts/delta_parser_bench.cpp src/signalk_delta_parser.cpp
+//       -o delta_parser_bench && ./delta_parser_bench [sk_0001.skr] [--seconds 2]
+//
+// Replays a delta corpus through sk_parse_delta(), the parser wsEvent runs,
+// and reports messages/sec, MB/s, per-frame parse latency and the heap bytes
+// allocated while parsing (expected: 0). The corpus is a recording made with
+// the display's /record page (src/signalk_record_format.h) or, without one, a
+// built-in engine-room mix: numeric engine values, position objects, string
+// values, meta-only deltas and a truncated frame.
+//
+// Allocations are counted by interposing malloc/calloc/realloc and operator
+// new, so this needs glibc (Linux). For comparison the line "replaced path"
+// prints what the old String + DynamicJsonDocument(4096) handler allocated
+// for the same corpus: one frame-sized String and the 4 KB document pool per
+// message, before any ArduinoJson slack.
+#include "signalk_delta_parser.h"
+#include "signalk_record_format.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+// Allocation accounting, active only around the measured loop
+extern "C" void *__libc_malloc(size_t);
+extern "C" void *__libc_calloc(size_t, size_t);
+extern "C" void *__libc_realloc(void *, size_t);
+extern "C" void __libc_free(void *);
+
+static bool counting = false;
+static uint64_t alloc_calls = 0;
+static uint64_t alloc_bytes = 0;
+
+static inline void note_alloc(size_t n) {
+    if (!counting) return;
+    alloc_calls++;
+    alloc_bytes += n;
+}
+
+extern "C" void *malloc(size_t n) { note_alloc(n); return __libc_malloc(n); }
+extern "C" void *calloc(size_t n, size_t m) { note_alloc(n * m); return __libc_calloc(n, m); }
+extern "C" void *realloc(void *p, size_t n) { note_alloc(n); return __libc_realloc(p, n); }
+extern "C" void free(void *p) { __libc_free(p); }
+
+void *operator new(size_t n) {
+    void *p = malloc(n);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+struct Sink {
+    uint64_t values;
+    float last;
+};
+
+static void on_value(const char *path, size_t path_len, float value, const SkDeltaMeta *meta, void *ctx) {
+    (void)path; (void)path_len; (void)meta;
+    Sink *s = (Sink *)ctx;
+    s->values++;
+    s->last = value;
+}
+
+static void add_delta(std::vector<std::string> &out, const char *source, const char *values) {
+    char frame[1024];
+    snprintf(frame, sizeof(frame),
+             "{\"context\":\"vessels.urn:mrn:imo:mmsi:235000000\",\"updates\":[{\"source\":{\"label\":\"%s\","
+             "\"type\":\"NMEA2000\",\"pgn\":127488,\"src\":\"0\"},\"$source\":\"%s.0\","
+             "\"timestamp\":\"2026-05-01T12:34:56.789Z\",\"values\":[%s]}]}",
+             source, source, values);
+    out.push_back(frame);
+}
+
+static void builtin_corpus(std::vector<std::string> &out) {
+    add_delta(out, "can0", "{\"path\":\"propulsion.port.revolutions\",\"value\":30.85}");
+    add_delta(out, "can0", "{\"path\":\"propulsion.port.revolutions\",\"value\":30.85},"
+                           "{\"path\":\"propulsion.starboard.revolutions\",\"value\":29.83}");
+    add_delta(out, "can0", "{\"path\":\"propulsion.port.temperature\",\"value\":355.65},"
+                           "{\"path\":\"propulsion.port.oilPressure\",\"value\":340000},"
+                           "{\"path\":\"propulsion.port.exhaustTemperature\",\"value\":685.15},"
+                           "{\"path\":\"propulsion.port.coolantTemperature\",\"value\":355.65}");
+    add_delta(out, "can0", "{\"path\":\"tanks.fuel.0.currentLevel\",\"value\":0.63},"
+                           "{\"path\":\"tanks.fuel.1.currentLevel\",\"value\":0.585}");
+    add_delta(out, "gps", "{\"path\":\"navigation.position\",\"value\":{\"longitude\":11.516667,"
+                          "\"latitude\":48.1173}},{\"path\":\"navigation.speedOverGround\",\"value\":3.12}");
+    add_delta(out, "ais", "{\"path\":\"\",\"value\":{\"name\":\"Esperance \\\"II\\\"\"}},"
+                          "{\"path\":\"design.length\",\"value\":{\"overall\":11.9}}");
+    add_delta(out, "can0", "{\"path\":\"environment.water.temperature\",\"value\":291.55},"
+                           "{\"path\":\"electrical.batteries.house.voltage\",\"value\":12.86},"
+                           "{\"path\":\"electrical.batteries.house.current\",\"value\":-4.2e0},"
+                           "{\"path\":\"notifications.propulsion.port.temperature\",\"value\":null}");
+    out.push_back("{\"context\":\"vessels.self\",\"updates\":[{\"meta\":[{\"path\":\"propulsion.port.temperature\","
+                  "\"value\":{\"units\":\"K\",\"zones\":[{\"upper\":368.15,\"state\":\"alarm\"}]}}]}]}");
+    out.push_back("{\"name\":\"signalk-server\",\"version\":\"2.8.0\",\"self\":\"vessels.self\","
+                  "\"roles\":[\"master\",\"main\"],\"timestamp\":\"2026-05-01T12:34:56.000Z\"}");
+    std::string truncated = out[2];
+    truncated.resize(truncated.size() / 2);
+    out.push_back(truncated);
+}
+
+static bool load_recording(const char *file, std::vector<std::string> &out) {
+    FILE *f = fopen(file, "rb");
+    if (!f) { perror(file); return false; }
+    std::vector<uint8_t> buf;
+    uint8_t tmp[65536];
+    size_t got;
+    while ((got = fread(tmp, 1, sizeof(tmp), f)) > 0) buf.insert(buf.end(), tmp, tmp + got);
+    fclose(f);
+    SkrHeader hdr;
+    if (buf.size() < SKR_HEADER_SIZE || !skr_decode_header(buf.data(), &hdr)) {
+        fprintf(stderr, "%s: not a Signal K recording\n", file);
+        return false;
+    }
+    size_t pos = SKR_HEADER_SIZE;
+    while (pos < buf.size()) {
+        uint32_t dt, len;
+        size_t n = skr_get_varint(&buf[pos], buf.size() - pos, &dt);
+        if (n == 0) break;
+        size_t m = skr_get_varint(&buf[pos + n], buf.size() - pos - n, &len);
+        if (m == 0) break;
+        pos += n + m;
+        if (len == 0) {
+            uint32_t lost;
+            size_t k = skr_get_varint(&buf[pos], buf.size() - pos, &lost);
+            if (k == 0) break;
+            pos += k;
+            continue;
+        }
+        if (pos + len > buf.size()) break;
+        out.emplace_back((const char *)&buf[pos], len);
+        pos += len;
+    }
+    if (out.empty()) {
+        fprintf(stderr, "%s: no frames\n", file);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *file = NULL;
+    double seconds = 2.0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            file = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [file.skr] [--seconds 2]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<std::string> corpus;
+    if (file) {
+        if (!load_recording(file, corpus)) return 1;
+    } else {
+        builtin_corpus(corpus);
+    }
+    uint64_t corpus_bytes = 0;
+    for (const std::string &f : corpus) corpus_bytes += f.size();
+
+    Sink sink = {};
+    SkDeltaParseStats stats = {};
+    std::vector<double> lat_ns;
+    lat_ns.reserve(1 << 20);
+    uint64_t messages = 0, bytes = 0;
+
+    auto start = bench_clock::now();
+    auto deadline = start + std::chrono::duration<double>(seconds);
+    while (bench_clock::now() < deadline) {
+        counting = true;
+        for (const std::string &frame : corpus) {
+            auto t0 = bench_clock::now();
+            sk_parse_delta(frame.data(), frame.size(), on_value, &sink, &stats);
+            auto t1 = bench_clock::now();
+            if (lat_ns.size() < lat_ns.capacity())
+                lat_ns.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count());
+        }
+        counting = false;
+        messages += corpus.size();
+        bytes += corpus_bytes;
+    }
+    double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    std::sort(lat_ns.begin(), lat_ns.end());
+    auto pct = [&](double p) { return lat_ns.empty() ? 0.0 : lat_ns[(size_t)(p * (lat_ns.size() - 1))]; };
+    printf("corpus:          %zu frames, %llu bytes (%s)\n", corpus.size(), (unsigned long long)corpus_bytes,
+           file ? file : "built-in");
+    printf("messages parsed: %llu in %.2f s\n", (unsigned long long)messages, elapsed);
+    printf("throughput:      %.0f messages/s, %.1f MB/s\n", messages / elapsed, bytes / elapsed / 1e6);
+    printf("latency (ns):    p50 %.0f  p99 %.0f  max %.0f\n", pct(0.50), pct(0.99), pct(1.0));
+    printf("values %lu, errors %lu, last %.3f\n", (unsigned long)stats.values, (unsigned long)stats.errors,
+           sink.last);
+    printf("allocated:       %llu bytes in %llu calls while parsing\n", (unsigned long long)alloc_bytes,
+           (unsigned long long)alloc_calls);
+    printf("replaced path:   >= %llu bytes in %llu calls (String copy + 4 KB JsonDocument per message)\n",
+           (unsigned long long)(bytes + messages * (1 + 4096)), (unsigned long long)(messages * 2));
+    return alloc_bytes == 0 ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+// Host check for the derived-signal expression compiler (src/derived_expr.h).
+//
+//   g++ -O2 -std=c++17 -Isrc scripts/derived_expr_check.cpp src/derived_expr.cpp
+//       -o derived_expr_check && ./derived_expr_check
+//
+// Compiles a few ordinary expressions and checks their values, then feeds
+// the compiler the worst inputs a saved definition can hold: DERIVED_EXPR_MAX
+// - 1 characters of nested parentheses, unary minus and function calls. Each
+// must be rejected with "expression nested too deeply" instead of recursing
+// once per character, since derived_init() compiles the saved definitions
+// on the loop task at every boot. Exits 1 on any failure.
+#include "derived_expr.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#define DERIVED_EXPR_MAX 96   // src/derived_signals.h
+
+// s0..s9 are variables 0..9
+static int resolve(const char *name, size_t len, void *) {
+    if (len == 2 && name[0] == 's' && name[1] >= '0' && name[1] <= '9') return name[1] - '0';
+    return -1;
+}
+
+static int failures = 0;
+
+static void expect_value(const char *src, float want) {
+    DexprProgram prog;
+    DexprRate rates[DEXPR_MAX_RATES] = {};
+    char err[48];
+    float vars[DEXPR_MAX_VARS] = {};
+    for (int i = 0; i < 10; i++) vars[i] = (float)(i + 1);
+    if (!dexpr_compile(src, &prog, resolve, NULL, err, sizeof(err))) {
+        printf("FAIL  %s: %s\n", src, err);
+        failures++;
+        return;
+    }
+    float got = dexpr_eval(&prog, vars, rates, 0);
+    bool ok = fabsf(got - want) <= 1e-5f * fmaxf(1.0f, fabsf(want));
+    printf("%s  %s = %g\n", ok ? "ok  " : "FAIL", src, got);
+    if (!ok) failures++;
+}
+
+static void expect_error(const char *label, const std::string &src, const char *want) {
+    DexprProgram prog;
+    char err[48];
+    bool compiled = dexpr_compile(src.c_str(), &prog, resolve, NULL, err, sizeof(err));
+    bool ok = !compiled && strcmp(err, want) == 0;
+    printf("%s  %s (%zu chars): %s\n", ok ? "ok  " : "FAIL", label, src.size(), compiled ? "compiled" : err);
+    if (!ok) failures++;
+}
+
+// `open` repeated around s0, closed by `close`, filling the definition
+static std::string nested(const char *open, const char *close) {
+    size_t max = DERIVED_EXPR_MAX - 1, per = strlen(open) + strlen(close);
+    size_t n = (max - 2) / per;
+    std::string s;
+    for (size_t i = 0; i < n; i++) s += open;
+    s += "s0";
+    for (size_t i = 0; i < n && close[0]; i++) s += close;
+    return s;
+}
+
+int main() {
+    expect_value("s1 * 60 / 6", 20.0f);
+    expect_value("s1 - 273.15", 2.0f - 273.15f);
+    expect_value("-(s2 - s5) * 2", 6.0f);
+    expect_value("max(s0, min(s3, abs(-s9)))", 4.0f);
+    expect_value("((((((((s0))))))))", 1.0f);
+    expect_value("- - - -s4", 5.0f);
+
+    expect_error("parentheses", nested("(", ")"), "expression nested too deeply");
+    expect_error("unary minus", nested("-", ""), "expression nested too deeply");
+    expect_error("abs() calls", nested("abs(", ")"), "expression nested too deeply");
+    expect_error("mixed", nested("-(", ")"), "expression nested too deeply");
+
+    // Just inside the limit: each level of parentheses costs one
+    std::string ok_src;
+    for (int i = 0; i < DEXPR_MAX_NESTING - 1; i++) ok_src += "(";
+    ok_src += "s0";
+    for (int i = 0; i < DEXPR_MAX_NESTING - 1; i++) ok_src += ")";
+    expect_value(ok_src.c_str(), 1.0f);
+
+    printf("%s: %d failures\n", failures ? "FAIL" : "OK", failures);
+    return failures ? 1 : 0;
+}
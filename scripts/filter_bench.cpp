@@ -0,0 +1,161 @@
+// Host benchmark for the sensor filter chain (src/signal_filter.h).
+//
+//   g++ -O2 -std=c++17 -Isrc scripts/filter_bench.cpp src/signal_filter.cpp
+//       -o filter_bench && ./filter_bench [minutes]
+//
+// Synthesises three noisy senders (a sloshing tank level, RPM from an
+// alternator W-terminal with occasional glitches, a jittery coolant sensor)
+// and runs each through a set of filter configurations. For every run it
+// reports the filter cost per sample, the needle animations the UI would
+// start (a new animation whenever the integer needle angle differs at a
+// 100 ms UI tick, as update_needles_for_screen() does) and the mean
+// tracking error against the noise-free signal.
+#include "signal_filter.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+struct Sample {
+    uint32_t t_ms;
+    float truth;
+    float measured;
+};
+
+struct Signal {
+    const char *name;
+    float lo, hi;            // gauge calibration range, mapped to 0..270 degrees
+    uint32_t period_ms;      // sender update interval
+    std::vector<Sample> samples;
+};
+
+static Signal make_tank(double minutes, std::mt19937 &rng) {
+    Signal s = { "tank level (ratio, 10 Hz)", 0.0f, 1.0f, 100, {} };
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    for (uint32_t t = 0; t < minutes * 60000; t += s.period_ms) {
+        float sec = t / 1000.0f;
+        float truth = 0.6f - 0.0005f * sec / 60.0f;                 // slow burn
+        float slosh = 0.04f * sinf(2 * (float)M_PI * 0.8f * sec) + 0.015f * sinf(2 * (float)M_PI * 2.3f * sec);
+        s.samples.push_back({ t, truth, truth + slosh + noise(rng) });
+    }
+    return s;
+}
+
+static Signal make_rpm(double minutes, std::mt19937 &rng) {
+    Signal s = { "RPM (Hz, 20 Hz, W-terminal)", 0.0f, 60.0f, 50, {} };
+    std::normal_distribution<float> noise(0.0f, 0.3f);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    for (uint32_t t = 0; t < minutes * 60000; t += s.period_ms) {
+        float sec = t / 1000.0f;
+        // Cruise with a throttle change every 40 s
+        float truth = ((int)(sec / 40) % 2) ? 35.0f : 28.0f;
+        float m = truth + noise(rng);
+        float r = u(rng);
+        if (r < 0.01f) m = 0.0f;                 // dropped pulse train
+        else if (r < 0.02f) m = truth * 2.0f;    // double-counted edges
+        s.samples.push_back({ t, truth, m });
+    }
+    return s;
+}
+
+static Signal make_coolant(double minutes, std::mt19937 &rng) {
+    Signal s = { "coolant (K, 2 Hz)", 313.15f, 393.15f, 500, {} };
+    std::normal_distribution<float> noise(0.0f, 0.25f);
+    for (uint32_t t = 0; t < minutes * 60000; t += s.period_ms) {
+        float truth = 355.15f + 0.5f * sinf(t / 60000.0f);
+        s.samples.push_back({ t, truth, truth + noise(rng) });
+    }
+    return s;
+}
+
+static int angle_for(const Signal &s, float v) {
+    float a = (v - s.lo) / (s.hi - s.lo) * 270.0f;
+    if (a < 0) a = 0;
+    if (a > 270) a = 270;
+    return (int)lrintf(a);
+}
+
+struct Result {
+    double ns_per_sample;
+    uint32_t animations;
+    double mean_err;
+    uint32_t held, slewed;
+};
+
+static Result run(const Signal &s, const SignalFilterConfig &cfg) {
+    Result r = {};
+    uint8_t frac = signal_filter_frac_bits(fabsf(s.hi) > fabsf(s.lo) ? fabsf(s.hi) : fabsf(s.lo));
+    SignalFilterChain f;
+
+    // Cost: the whole signal back to back, repeated to get a stable time
+    const int reps = 20;
+    volatile float sink = 0;
+    auto t0 = bench_clock::now();
+    for (int k = 0; k < reps; k++) {
+        signal_filter_reset(&f, &cfg, frac);
+        for (const Sample &x : s.samples) sink = sink + signal_filter_step(&f, x.measured, x.t_ms);
+    }
+    double ns = std::chrono::duration<double, std::nano>(bench_clock::now() - t0).count();
+    r.ns_per_sample = ns / ((double)reps * s.samples.size());
+
+    // Redraws: latest filtered value sampled on the 100 ms UI tick
+    signal_filter_reset(&f, &cfg, frac);
+    int last_angle = -1;
+    float current = NAN;
+    size_t i = 0;
+    double err = 0;
+    for (uint32_t tick = 0; i < s.samples.size(); tick += 100) {
+        while (i < s.samples.size() && s.samples[i].t_ms <= tick) {
+            current = signal_filter_step(&f, s.samples[i].measured, s.samples[i].t_ms);
+            err += fabs(current - s.samples[i].truth);
+            i++;
+        }
+        if (std::isnan(current)) continue;
+        int a = angle_for(s, current);
+        if (a != last_angle) {
+            if (last_angle >= 0) r.animations++;
+            last_angle = a;
+        }
+    }
+    r.mean_err = err / s.samples.size();
+    r.held = f.stats.deadband_held;
+    r.slewed = f.stats.slew_limited;
+    return r;
+}
+
+int main(int argc, char **argv) {
+    double minutes = argc > 1 ? atof(argv[1]) : 10.0;
+    std::mt19937 rng(1234);
+    std::vector<Signal> signals = { make_tank(minutes, rng), make_rpm(minutes, rng), make_coolant(minutes, rng) };
+
+    struct Named { const char *name; SignalFilterConfig cfg; };
+    // Deadband and slew are per signal, as a fraction of the gauge range
+    for (const Signal &s : signals) {
+        float range = s.hi - s.lo;
+        Named configs[] = {
+            { "raw",                      { 0, 100, 0, 0 } },
+            { "median5",                  { 5, 100, 0, 0 } },
+            { "ema20",                    { 0, 20, 0, 0 } },
+            { "median5+ema20",            { 5, 20, 0, 0 } },
+            { "median5+ema20+db",         { 5, 20, range * 0.006f, 0 } },
+            { "median5+ema20+slew+db",    { 5, 20, range * 0.006f, range * 0.25f } },
+        };
+        printf("%s, %.0f min, %zu samples\n", s.name, minutes, s.samples.size());
+        printf("  %-24s %10s %12s %10s %10s %8s\n", "config", "ns/sample", "anims/min", "mean err", "held", "slewed");
+        double raw_anims = 0;
+        for (const Named &c : configs) {
+            Result r = run(s, c.cfg);
+            double per_min = r.animations / minutes;
+            if (raw_anims == 0) raw_anims = per_min;
+            printf("  %-24s %10.1f %12.1f %10.4f %10u %8u", c.name, r.ns_per_sample, per_min, r.mean_err, r.held, r.slewed);
+            if (raw_anims > 0 && &c != &configs[0]) printf("  (%.0f%% of raw)", 100.0 * per_min / raw_anims);
+            printf("\n");
+        }
+        printf("\n");
+    }
+    return 0;
+}
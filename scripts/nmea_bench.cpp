@@ -0,0 +1,106 @@
+// Host benchmark for the NMEA 0183 parser and slot routing.
+//
+//   g++ -O2 -std=c++17 -Isrc scripts/nmea_bench.cpp src/nmea0183_parser.cpp
+//       src/signalk_path_index.cpp -o nmea_bench && ./nmea_bench [seconds]
+//
+// Feeds a synthetic engine-room mix (XDR, RPM, MTW, plus unmapped, truncated and
+// corrupted sentences) through the same reader/index path the device uses
+// and reports sentences/sec and the per-datagram parse latency.
+#include "nmea0183_parser.h"
+#include "signalk_path_index.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+static void add_sentence(std::vector<std::string> &out, const char *body, bool corrupt = false) {
+    unsigned sum = 0;
+    for (const char *c = body; *c; c++) sum ^= (unsigned char)*c;
+    if (corrupt) sum ^= 0x01;
+    char line[128];
+    snprintf(line, sizeof(line), "$%s*%02X\r\n", body, sum);
+    out.push_back(line);
+}
+
+struct Sink {
+    const SkPathIndex *index;
+    float slots[SK_PATH_INDEX_MAX_SLOTS];
+    uint32_t routed;
+};
+
+static void on_value(const char *key, size_t key_len, float value, const char *talker, void *ctx) {
+    (void)talker;
+    Sink *s = (Sink *)ctx;
+    const SkPathEntry *e = sk_path_index_find(s->index, key, key_len);
+    if (e == NULL) return;
+    uint32_t m = e->slot_mask;
+    while (m) {
+        int i = __builtin_ctz(m);
+        m &= m - 1;
+        s->slots[i] = value;
+        s->routed++;
+    }
+}
+
+int main(int argc, char **argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+
+    SkPathIndex index;
+    sk_path_index_clear(&index);
+    const char *map[] = { "RPM/E1", "XDR/ENGT#1", "RPM/E2", "XDR/FUEL", "XDR/ENGT#2",
+                          "XDR/EXHT#1", "XDR/FUEL#2", "XDR/ENGT#3", "XDR/OILP#1", "MTW" };
+    for (int i = 0; i < 10; i++) sk_path_index_add(&index, map[i], strlen(map[i]), i);
+
+    // One "datagram" per sentence, as most multiplexers send them
+    std::vector<std::string> corpus;
+    add_sentence(corpus, "ERRPM,E,1,1850.5,,A");
+    add_sentence(corpus, "ERRPM,E,2,1790.0,,A");
+    add_sentence(corpus, "IIXDR,C,82.5,C,ENGT#1,C,81.0,C,ENGT#2,C,80.2,C,ENGT#3");
+    add_sentence(corpus, "IIXDR,C,412.0,C,EXHT#1,P,3.4,B,OILP#1");
+    add_sentence(corpus, "IIXDR,V,63.0,P,FUEL,V,58.5,P,FUEL#2");
+    add_sentence(corpus, "IIMTW,18.4,C");
+    add_sentence(corpus, "GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+    add_sentence(corpus, "IIXDR,C,82.5,C,ENGT#1", true);
+    corpus.push_back("$IIXDR,C,82.5,C,EN");   // datagram cut short: no checksum, rejected
+
+    NmeaReader reader;
+    nmea_reader_init(&reader);
+    NmeaParseStats stats = {};
+    Sink sink = { &index, {}, 0 };
+
+    std::vector<double> lat_ns;
+    lat_ns.reserve(1 << 20);
+    uint64_t fed = 0;
+    auto start = bench_clock::now();
+    auto deadline = start + std::chrono::duration<double>(seconds);
+    while (bench_clock::now() < deadline) {
+        for (const std::string &dgram : corpus) {
+            auto t0 = bench_clock::now();
+            nmea_feed(&reader, dgram.data(), dgram.size(), on_value, &sink, &stats);
+            nmea_feed(&reader, "\n", 1, on_value, &sink, &stats);   // end of datagram, as nmea_ingest does
+            auto t1 = bench_clock::now();
+            if (lat_ns.size() < lat_ns.capacity())
+                lat_ns.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count());
+        }
+        fed += corpus.size();
+    }
+    double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    std::sort(lat_ns.begin(), lat_ns.end());
+    auto pct = [&](double p) { return lat_ns.empty() ? 0.0 : lat_ns[(size_t)(p * (lat_ns.size() - 1))]; };
+    printf("sentences fed:   %llu in %.2f s\n", (unsigned long long)fed, elapsed);
+    printf("throughput:      %.0f sentences/s\n", fed / elapsed);
+    printf("latency (ns):    p50 %.0f  p99 %.0f  max %.0f\n", pct(0.50), pct(0.99), pct(1.0));
+    printf("parsed %lu, values %lu, routed %lu, checksum errors %lu, missing %lu, unsupported %lu, malformed %lu\n",
+           (unsigned long)stats.sentences, (unsigned long)stats.values, (unsigned long)sink.routed,
+           (unsigned long)stats.checksum_errors, (unsigned long)stats.missing_checksum, (unsigned long)stats.unsupported,
+           (unsigned long)stats.malformed);
+    printf("last values:     rpm1 %.2f Hz  coolant1 %.2f K  oil %.0f Pa  fuel %.1f %%  water %.2f K\n",
+           sink.slots[0], sink.slots[1], sink.slots[8], sink.slots[3], sink.slots[9]);
+    return 0;
+}
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""Stand-in for an NMEA 0183 WiFi multiplexer.
+
+Sends sentences to the display over UDP (unicast or broadcast) or serves them
+to it over TCP, either from a capture file (one sentence per line, checksums
+are recomputed) or from a built-in engine profile with slowly moving values.
+
+  # broadcast the synthetic profile at 50 sentences/s for 60 s
+  python3 scripts/nmea_udp_replay.py --rate 50 --duration 60
+  # replay a capture to one display, then print its ingest counters
+  python3 scripts/nmea_udp_replay.py --file run.nmea --to 192.168.1.50 --metrics
+  # act as a TCP multiplexer (set the display to TCP client mode)
+  python3 scripts/nmea_udp_replay.py --tcp --port 10110
+
+Matching slot keys for the built-in profile: RPM/E1, RPM/E2, XDR/ENGT#1,
+XDR/ENGT#2, XDR/EXHT#1, XDR/OILP#1, XDR/FUEL, MTW.
+"""
+import argparse
+import json
+import math
+import socket
+import time
+import urllib.request
+
+
+def with_checksum(body):
+    body = body.strip().lstrip('$!')
+    if '*' in body:
+        body = body.split('*', 1)[0]
+    cs = 0
+    for ch in body.encode('ascii', 'replace'):
+        cs ^= ch
+    return '$%s*%02X\r\n' % (body, cs)
+
+
+def synthetic(t):
+    rpm1 = 1800 + 600 * math.sin(t / 20.0)
+    rpm2 = 1750 + 600 * math.sin(t / 21.0)
+    coolant = 82 + 4 * math.sin(t / 45.0)
+    exhaust = 400 + 60 * math.sin(t / 30.0)
+    oil = 3.5 + 0.5 * math.sin(t / 15.0)
+    fuel = max(0.0, 80 - t / 60.0)
+    return [
+        'ERRPM,E,1,%.1f,,A' % rpm1,
+        'ERRPM,E,2,%.1f,,A' % rpm2,
+        'IIXDR,C,%.1f,C,ENGT#1,C,%.1f,C,ENGT#2' % (coolant, coolant - 1.5),
+        'IIXDR,C,%.1f,C,EXHT#1,P,%.2f,B,OILP#1' % (exhaust, oil),
+        'IIXDR,V,%.1f,P,FUEL' % fuel,
+        'IIMTW,%.1f,C' % (17.5 + math.sin(t / 120.0)),
+    ]
+
+
+def sentence_source(args):
+    if args.file:
+        with open(args.file) as f:
+            lines = [l for l in (x.strip() for x in f) if l.startswith(('$', '!'))]
+        if not lines:
+            raise SystemExit('no sentences in %s' % args.file)
+        while True:
+            for line in lines:
+                yield with_checksum(line)
+            if not args.loop:
+                return
+    start = time.time()
+    while True:
+        for body in synthetic(time.time() - start):
+            yield with_checksum(body)
+
+
+def print_metrics(host):
+    try:
+        with urllib.request.urlopen('http://%s/metrics' % host, timeout=3) as r:
+            nmea = json.load(r).get('nmea', {})
+    except Exception as e:
+        print('metrics unavailable: %s' % e)
+        return
+    print('display: %s sentences, %s stored, %s unmapped, %s checksum errors, '
+          'receive->store avg %s us, max %s us' % (
+              nmea.get('sentences'), nmea.get('stored'), nmea.get('unmapped'),
+              nmea.get('checksum_errors'), nmea.get('latency_avg_us'), nmea.get('latency_max_us')))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--to', default='255.255.255.255', help='UDP destination (default: broadcast)')
+    ap.add_argument('--port', type=int, default=10110)
+    ap.add_argument('--tcp', action='store_true', help='serve on TCP instead of sending UDP')
+    ap.add_argument('--file', help='capture to replay (default: synthetic engine profile)')
+    ap.add_argument('--loop', action='store_true', help='repeat the capture')
+    ap.add_argument('--rate', type=float, default=20.0, help='sentences per second')
+    ap.add_argument('--batch', type=int, default=1, help='sentences per datagram')
+    ap.add_argument('--duration', type=float, default=0, help='seconds to run (0 = until done / Ctrl-C)')
+    ap.add_argument('--metrics', action='store_true', help='print the display ingest counters at the end (needs --to)')
+    args = ap.parse_args()
+
+    if args.tcp:
+        srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        srv.bind(('', args.port))
+        srv.listen(1)
+        print('waiting for the display on TCP port %d...' % args.port)
+        conn, peer = srv.accept()
+        print('connected: %s:%d' % peer)
+        send = conn.sendall
+    else:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+        send = lambda data: sock.sendto(data, (args.to, args.port))
+
+    interval = args.batch / args.rate if args.rate > 0 else 0
+    src = sentence_source(args)
+    sent = 0
+    start = next_at = time.time()
+    try:
+        done = False
+        while not done:
+            chunk = []
+            for _ in range(args.batch):
+                try:
+                    chunk.append(next(src))
+                except StopIteration:
+                    done = True
+                    break
+            if chunk:
+                send(''.join(chunk).encode('ascii'))
+                sent += len(chunk)
+            if args.duration and time.time() - start >= args.duration:
+                break
+            next_at += interval
+            delay = next_at - time.time()
+            if delay > 0:
+                time.sleep(delay)
+    except KeyboardInterrupt:
+        pass
+    except (BrokenPipeError, ConnectionResetError):
+        print('display disconnected')
+    elapsed = max(time.time() - start, 1e-6)
+    print('sent %d sentences in %.1f s (%.1f/s)' % (sent, elapsed, sent / elapsed))
+    if args.metrics and not args.tcp and args.to != '255.255.255.255':
+        time.sleep(0.5)
+        print_metrics(args.to)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,198 @@
+// Host stress benchmark for the seqlock sensor store (src/sensor_store.cpp)
+// against the single sensor_mutex it replaced.
+//
+//   g++ -O2 -std=c++17 -pthread scripts/sensor_store_bench.cpp -o sensor_store_bench
+//   ./sensor_store_bench [seconds] [writers] [readers] [write period us]
+//
+// Writer threads stand in for the ingest tasks (Signal K, NMEA 0183, derived
+// signals), two of them writing into the same slots. Each writes a burst
+// over its slots every period (default 100 us, up to 50 k values/s per
+// writer, far above any real bus; 0 = flat out). Reader
+// threads stand in for loop()'s zone and buzzer scans and read all slots
+// back to back. Each read is timed; reported are reads/sec, the latency
+// percentiles and worst case, reads that came back torn (value and receive
+// stamp from different writes) and, for the mutex, reads that hit the 50 ms
+// timeout and returned 0 the way the old get_sensor_value() did.
+//
+// The seqlock here mirrors sensor_store.cpp: a CAS-claimed sequence per slot
+// and a per-slot spinlock around the write standing in for portMUX. A host
+// cannot mask interrupts, so a writer preempted mid-write can make readers
+// spin for a time slice; on the device that window is closed. Flat-out
+// writers on a host with few cores hit it often, so the seqlock worst case
+// at period 0 is an artefact of the host, not of the store.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+#define SLOTS 10
+
+struct Sample {
+    float value;
+    uint32_t rx_ms;
+};
+
+// sensor_store.cpp
+struct SeqSlot {
+    uint32_t seq;
+    volatile float value;
+    uint32_t rx_ms;
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;
+};
+
+static SeqSlot seq_slots[SLOTS];
+
+static void seq_write(int i, float value, uint32_t rx_ms) {
+    SeqSlot &slot = seq_slots[i];
+    while (slot.lock.test_and_set(std::memory_order_acquire)) {}
+    uint32_t s = __atomic_load_n(&slot.seq, __ATOMIC_RELAXED);
+    for (;;) {
+        if ((s & 1) == 0 &&
+            __atomic_compare_exchange_n(&slot.seq, &s, s + 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) break;
+        s = __atomic_load_n(&slot.seq, __ATOMIC_RELAXED);
+    }
+    slot.value = value;
+    __atomic_store_n(&slot.rx_ms, rx_ms, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot.seq, s + 2, __ATOMIC_RELEASE);
+    slot.lock.clear(std::memory_order_release);
+}
+
+static Sample seq_read(int i) {
+    SeqSlot &slot = seq_slots[i];
+    for (;;) {
+        uint32_t s1 = __atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1) continue;
+        Sample out = { slot.value, __atomic_load_n(&slot.rx_ms, __ATOMIC_RELAXED) };
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot.seq, __ATOMIC_RELAXED) == s1) return out;
+    }
+}
+
+// The old store: one mutex for all slots, 50 ms take timeout, 0 on failure
+static std::timed_mutex sensor_mutex;
+static Sample mutex_values[SLOTS];
+static std::atomic<uint64_t> mutex_timeouts{0};
+
+static void mutex_write(int i, float value, uint32_t rx_ms) {
+    if (!sensor_mutex.try_lock_for(std::chrono::milliseconds(50))) return;
+    mutex_values[i] = { value, rx_ms };
+    sensor_mutex.unlock();
+}
+
+static Sample mutex_read(int i) {
+    Sample out = { 0, 0 };
+    if (!sensor_mutex.try_lock_for(std::chrono::milliseconds(50))) {
+        mutex_timeouts++;
+        return out;
+    }
+    out = mutex_values[i];
+    sensor_mutex.unlock();
+    return out;
+}
+
+struct ReaderResult {
+    uint64_t reads = 0;
+    uint64_t torn = 0;
+    std::vector<float> lat_ns;
+};
+
+struct Result {
+    double seconds;
+    uint64_t reads, writes, torn;
+    std::vector<float> lat_ns;
+};
+
+template <typename W, typename R>
+static Result run(W write, R read, double seconds, int writers, int readers, int period_us) {
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> writes{0};
+    std::vector<std::thread> threads;
+    std::vector<ReaderResult> rr(readers);
+
+    for (int w = 0; w < writers; w++) {
+        threads.emplace_back([&, w] {
+            // Writers 0 and 1 share slots 0..4, the rest take 5..9
+            int first = w < 2 ? 0 : 5, count = 5;
+            uint32_t k = 1 + w;
+            uint64_t n = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = first; i < first + count; i++) {
+                    // Exact in a float, so a reader can match value to stamp
+                    k = (k + writers) & 0xFFFFFF;
+                    write(i, (float)k, k);
+                    n++;
+                }
+                if (period_us > 0) std::this_thread::sleep_for(std::chrono::microseconds(period_us));
+            }
+            writes += n;
+        });
+    }
+    for (int r = 0; r < readers; r++) {
+        threads.emplace_back([&, r] {
+            ReaderResult &res = rr[r];
+            res.lat_ns.reserve(1 << 22);
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < SLOTS; i++) {
+                    auto t0 = bench_clock::now();
+                    Sample s = read(i);
+                    auto t1 = bench_clock::now();
+                    if (s.rx_ms != 0 && (uint32_t)s.value != s.rx_ms) res.torn++;
+                    res.reads++;
+                    if (res.lat_ns.size() < res.lat_ns.capacity())
+                        res.lat_ns.push_back(std::chrono::duration<float, std::nano>(t1 - t0).count());
+                }
+            }
+        });
+    }
+
+    auto start = bench_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (std::thread &t : threads) t.join();
+    Result out = { std::chrono::duration<double>(bench_clock::now() - start).count(), 0, writes.load(), 0, {} };
+    for (ReaderResult &res : rr) {
+        out.reads += res.reads;
+        out.torn += res.torn;
+        out.lat_ns.insert(out.lat_ns.end(), res.lat_ns.begin(), res.lat_ns.end());
+    }
+    std::sort(out.lat_ns.begin(), out.lat_ns.end());
+    return out;
+}
+
+static void report(const char *name, const Result &r) {
+    auto pct = [&](double p) { return r.lat_ns.empty() ? 0.0 : r.lat_ns[(size_t)(p * (r.lat_ns.size() - 1))]; };
+    printf("%-8s reads %10.0f/s  writes %10.0f/s  latency ns p50 %6.0f  p99.9 %8.0f  max %10.0f  torn %llu\n",
+           name, r.reads / r.seconds, r.writes / r.seconds, pct(0.5), pct(0.999), pct(1.0),
+           (unsigned long long)r.torn);
+}
+
+int main(int argc, char **argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+    int writers = argc > 2 ? atoi(argv[2]) : 3;
+    int readers = argc > 3 ? atoi(argv[3]) : 2;
+    int period_us = argc > 4 ? atoi(argv[4]) : 100;
+    if (writers < 1 || readers < 1 || period_us < 0) {
+        fprintf(stderr, "usage: %s [seconds] [writers >= 1] [readers >= 1] [write period us]\n", argv[0]);
+        return 2;
+    }
+    printf("%d writers every %d us, %d readers, %u hardware threads, %.1f s per store\n", writers, period_us,
+           readers, std::thread::hardware_concurrency(), seconds);
+
+    Result seq = run(seq_write, seq_read, seconds, writers, readers, period_us);
+    report("seqlock", seq);
+    Result mtx = run(mutex_write, mutex_read, seconds, writers, readers, period_us);
+    report("mutex", mtx);
+    printf("mutex reads that timed out and returned 0: %llu\n", (unsigned long long)mutex_timeouts.load());
+    if (mtx.reads && seq.reads)
+        printf("seqlock/mutex: %.1fx reads/s, %.1fx lower worst case\n",
+               (seq.reads / seq.seconds) / (mtx.reads / mtx.seconds),
+               mtx.lat_ns.back() / std::max(seq.lat_ns.back(), 1.0f));
+    return seq.torn == 0 ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+// Host model of the Signal K WebSocket pump, run against the stand-in
+// server (scripts/sk_standin_server.py) to compare the two loops of
+// signalk_task: the old ws_client.loop() + vTaskDelay(10) poll and the
+// select() wait on the socket with a deadline (src/signalk_config.cpp).
+//
+//   g++ -O2 -std=c++17 scripts/sk_pump_bench.cpp -o sk_pump_bench
+//   python3 scripts/sk_standin_server.py --rate 20 --duration 30 &
+//   ./sk_pump_bench poll   [host] [port] [seconds]
+//   ./sk_pump_bench select [host] [port] [seconds]
+//
+// The client does what the task does with each frame: reads it, answers
+// pings with a pong (the stand-in times that round trip) and takes the
+// delta's timestamp for a receive latency. It reports wakeups/s, the share
+// of wall time the thread was on the CPU and the latency percentiles; the
+// stand-in prints the pong round trips. Only the waiting strategy is
+// modelled: per-frame work on the device (parsing, the store) costs the
+// same in both loops and is not included.
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+static const int POLL_MS = 10;          // vTaskDelay(10)
+static const int DEADLINE_MS = 1000;    // select() cap in signalk_task
+
+static double wall_s() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double cpu_s() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int connect_ws(const char *host, const char *port) {
+    addrinfo hints = {}, *res;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &res) != 0) return -1;
+    int fd = socket(res->ai_family, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
+        freeaddrinfo(res);
+        return -1;
+    }
+    freeaddrinfo(res);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    char req[256];
+    int n = snprintf(req, sizeof(req),
+                     "GET /signalk/v1/stream HTTP/1.1\r\nHost: %s:%s\r\nUpgrade: websocket\r\n"
+                     "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                     "Sec-WebSocket-Version: 13\r\n\r\n", host, port);
+    if (send(fd, req, n, 0) != n) return -1;
+    // Read the 101 response byte by byte so no frame bytes are swallowed
+    std::string head;
+    char c;
+    while (head.find("\r\n\r\n") == std::string::npos && recv(fd, &c, 1, 0) == 1) head += c;
+    if (head.compare(0, 12, "HTTP/1.1 101") != 0) return -1;
+    return fd;
+}
+
+// Masked client frame (RFC 6455 requires clients to mask)
+static void send_frame(int fd, uint8_t opcode, const uint8_t *payload, size_t n) {
+    uint8_t buf[2 + 4 + 125];
+    if (n > 125) return;
+    buf[0] = 0x80 | opcode;
+    buf[1] = 0x80 | (uint8_t)n;
+    uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+    memcpy(buf + 2, mask, 4);
+    for (size_t i = 0; i < n; i++) buf[6 + i] = payload[i] ^ mask[i & 3];
+    send(fd, buf, 6 + n, 0);
+}
+
+// "timestamp":"2026-05-01T12:34:56.789Z" -> epoch seconds, or 0
+static double delta_time(const std::string &text) {
+    size_t p = text.find("\"timestamp\":");
+    if (p == std::string::npos) return 0;
+    p = text.find('"', p + 12);
+    if (p == std::string::npos) return 0;
+    tm t = {};
+    int ms = 0;
+    if (sscanf(text.c_str() + p + 1, "%4d-%2d-%2dT%2d:%2d:%2d.%3dZ", &t.tm_year, &t.tm_mon, &t.tm_mday,
+               &t.tm_hour, &t.tm_min, &t.tm_sec, &ms) != 7) return 0;
+    t.tm_year -= 1900;
+    t.tm_mon -= 1;
+    return (double)timegm(&t) + ms / 1000.0;
+}
+
+struct Pump {
+    int fd;
+    std::vector<uint8_t> in;
+    std::vector<double> lat_ms;
+    uint64_t frames = 0, pings = 0;
+    bool closed = false;
+
+    // Read what is there without blocking and handle whole frames
+    void drain() {
+        uint8_t buf[4096];
+        for (;;) {
+            ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n == 0) { closed = true; break; }
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) closed = true;
+                break;
+            }
+            in.insert(in.end(), buf, buf + n);
+        }
+        double now = wall_s();
+        size_t pos = 0;
+        while (in.size() - pos >= 2) {
+            uint8_t op = in[pos] & 0x0F;
+            uint64_t len = in[pos + 1] & 0x7F;
+            size_t hdr = 2;
+            if (len == 126) {
+                if (in.size() - pos < 4) break;
+                len = (in[pos + 2] << 8) | in[pos + 3];
+                hdr = 4;
+            } else if (len == 127) {
+                if (in.size() - pos < 10) break;
+                len = 0;
+                for (int i = 0; i < 8; i++) len = (len << 8) | in[pos + 2 + i];
+                hdr = 10;
+            }
+            if (in.size() - pos < hdr + len) break;
+            const uint8_t *payload = &in[pos + hdr];
+            if (op == 0x9) {
+                send_frame(fd, 0xA, payload, len);
+                pings++;
+            } else if (op == 0x1) {
+                frames++;
+                double t = delta_time(std::string((const char *)payload, len));
+                if (t > 0) lat_ms.push_back((now - t) * 1000.0);
+            } else if (op == 0x8) {
+                closed = true;
+            }
+            pos += hdr + len;
+        }
+        in.erase(in.begin(), in.begin() + pos);
+    }
+};
+
+int main(int argc, char **argv) {
+    if (argc < 2 || (strcmp(argv[1], "poll") != 0 && strcmp(argv[1], "select") != 0)) {
+        fprintf(stderr, "usage: %s poll|select [host] [port] [seconds]\n", argv[0]);
+        return 2;
+    }
+    bool poll = strcmp(argv[1], "poll") == 0;
+    const char *host = argc > 2 ? argv[2] : "127.0.0.1";
+    const char *port = argc > 3 ? argv[3] : "3000";
+    double seconds = argc > 4 ? atof(argv[4]) : 30.0;
+
+    Pump pump;
+    pump.fd = connect_ws(host, port);
+    if (pump.fd < 0) {
+        fprintf(stderr, "cannot open ws://%s:%s/signalk/v1/stream\n", host, port);
+        return 1;
+    }
+
+    uint64_t wakeups = 0;
+    double start = wall_s(), cpu0 = cpu_s();
+    while (!pump.closed && wall_s() - start < seconds) {
+        if (poll) {
+            pump.drain();
+            usleep(POLL_MS * 1000);
+        } else {
+            fd_set rd;
+            FD_ZERO(&rd);
+            FD_SET(pump.fd, &rd);
+            timeval tv = {DEADLINE_MS / 1000, (DEADLINE_MS % 1000) * 1000};
+            if (select(pump.fd + 1, &rd, NULL, NULL, &tv) > 0) pump.drain();
+        }
+        wakeups++;
+    }
+    double elapsed = wall_s() - start, cpu = cpu_s() - cpu0;
+    close(pump.fd);
+
+    std::vector<double> &l = pump.lat_ms;
+    std::sort(l.begin(), l.end());
+    auto pct = [&](double p) { return l.empty() ? 0.0 : l[(size_t)(p * (l.size() - 1))]; };
+    printf("%s: %.1f s, %llu deltas, %llu pings answered\n", argv[1], elapsed,
+           (unsigned long long)pump.frames, (unsigned long long)pump.pings);
+    printf("wakeups %.1f/s, on CPU %.3f%% of wall time\n", wakeups / elapsed, 100.0 * cpu / elapsed);
+    printf("delta receive latency (ms, 1 ms timestamps): p50 %.1f  p99 %.1f  max %.1f\n", pct(0.5), pct(0.99),
+           pct(1.0));
+    return 0;
+}
@@ -0,0 +1,219 @@
+// Host replayer for Signal K stream recordings (.skr, see
+// src/signalk_record_format.h) made with the display's /record page.
+//
+//   g++ -O2 -std=c++17 -Isrc scripts/sk_replay.cpp src/signalk_ingest.cpp
+//       src/signalk_delta_parser.cpp src/signalk_path_index.cpp -o sk_replay
+//   ./sk_replay sk_0001.skr [--speed 1|10|max] [--paths signalk_paths.txt] [--ui-ms 100]
+//
+// Every frame goes through sk_ingest_frame(), the code the firmware's
+// WebSocket handler runs, at the recorded pace (1x), ten times faster (10x)
+// or back to back (max). --paths takes the display's
+// /config/signalk_paths.txt (one path per line, line = slot); without it
+// every numeric path in the recording gets a slot of its own (up to 32).
+//
+// Reported: throughput, per-frame parse time, end-to-end slot update latency
+// (scheduled frame arrival -> slot written), updates the UI never saw
+// (overwritten before its next --ui-ms tick, on the recording's timeline)
+// and frames the recorder itself dropped.
+#include "signalk_ingest.h"
+#include "signalk_record_format.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using replay_clock = std::chrono::steady_clock;
+
+struct Frame {
+    uint32_t rx_ms;          // on the recording's millis() timeline
+    size_t offset, len;      // into the file buffer
+};
+
+struct SlotState {
+    uint32_t writes_since_tick;
+    uint64_t writes;
+};
+
+struct Sink {
+    SlotState slots[SK_PATH_INDEX_MAX_SLOTS];
+    replay_clock::time_point frame_due;   // scheduled arrival of the current frame
+    std::vector<double> e2e_us;
+    uint64_t updates;
+};
+
+static void on_slot(int slot, float value, int64_t sk_time_ms, const char *source, size_t source_len, void *ctx) {
+    (void)value; (void)sk_time_ms; (void)source; (void)source_len;
+    Sink *s = (Sink *)ctx;
+    s->slots[slot].writes_since_tick++;
+    s->slots[slot].writes++;
+    s->updates++;
+    if (s->e2e_us.size() < s->e2e_us.capacity())
+        s->e2e_us.push_back(std::chrono::duration<double, std::micro>(replay_clock::now() - s->frame_due).count());
+}
+
+// Auto-mapping: every numeric path seen gets the next free slot
+static void collect_path(const char *path, size_t len, float value, const SkDeltaMeta *meta, void *ctx) {
+    (void)value; (void)meta;
+    SkPathIndex *idx = (SkPathIndex *)ctx;
+    if (sk_path_index_find(idx, path, len) != NULL || idx->count >= SK_PATH_INDEX_MAX_SLOTS) return;
+    sk_path_index_add(idx, path, len, idx->count);
+}
+
+static double pct(std::vector<double> &v, double p) {
+    if (v.empty()) return 0;
+    return v[(size_t)(p * (v.size() - 1))];
+}
+
+int main(int argc, char **argv) {
+    const char *file = NULL;
+    const char *paths_file = NULL;
+    double speed = 1.0;   // 0 = max
+    uint32_t ui_ms = 100;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--speed") && i + 1 < argc) {
+            const char *v = argv[++i];
+            speed = !strcmp(v, "max") ? 0.0 : atof(v);
+        } else if (!strcmp(argv[i], "--paths") && i + 1 < argc) {
+            paths_file = argv[++i];
+        } else if (!strcmp(argv[i], "--ui-ms") && i + 1 < argc) {
+            ui_ms = (uint32_t)atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            file = argv[i];
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (file == NULL || ui_ms == 0) {
+        fprintf(stderr, "usage: %s file.skr [--speed 1|10|max] [--paths signalk_paths.txt] [--ui-ms 100]\n", argv[0]);
+        return 2;
+    }
+
+    // Load the recording
+    FILE *f = fopen(file, "rb");
+    if (!f) { perror(file); return 1; }
+    std::vector<uint8_t> buf;
+    uint8_t tmp[65536];
+    size_t got;
+    while ((got = fread(tmp, 1, sizeof(tmp), f)) > 0) buf.insert(buf.end(), tmp, tmp + got);
+    fclose(f);
+    SkrHeader hdr;
+    if (buf.size() < SKR_HEADER_SIZE || !skr_decode_header(buf.data(), &hdr)) {
+        fprintf(stderr, "%s: not a Signal K recording\n", file);
+        return 1;
+    }
+
+    std::vector<Frame> frames;
+    uint64_t recorder_dropped = 0;
+    uint32_t t = hdr.start_ms;
+    size_t pos = SKR_HEADER_SIZE;
+    while (pos < buf.size()) {
+        uint32_t dt, len;
+        size_t n = skr_get_varint(&buf[pos], buf.size() - pos, &dt);
+        if (n == 0) break;
+        size_t m = skr_get_varint(&buf[pos + n], buf.size() - pos - n, &len);
+        if (m == 0) break;
+        pos += n + m;
+        t += dt;
+        if (len == 0) {
+            uint32_t lost;
+            size_t k = skr_get_varint(&buf[pos], buf.size() - pos, &lost);
+            if (k == 0) break;
+            pos += k;
+            recorder_dropped += lost;
+            continue;
+        }
+        if (pos + len > buf.size()) break;   // truncated tail (recording still running)
+        frames.push_back({ t, pos, len });
+        pos += len;
+    }
+    if (frames.empty()) {
+        fprintf(stderr, "%s: no frames\n", file);
+        return 1;
+    }
+
+    // Slot mapping
+    SkPathIndex index;
+    sk_path_index_clear(&index);
+    if (paths_file) {
+        FILE *pf = fopen(paths_file, "r");
+        if (!pf) { perror(paths_file); return 1; }
+        char line[256];
+        int slot = 0;
+        while (fgets(line, sizeof(line), pf) && slot < SK_PATH_INDEX_MAX_SLOTS) {
+            size_t len = strcspn(line, "\r\n");
+            while (len > 0 && line[len - 1] == ' ') len--;
+            if (len > 0) sk_path_index_add(&index, line, len, slot);
+            slot++;
+        }
+        fclose(pf);
+    } else {
+        for (const Frame &fr : frames) sk_parse_delta((const char *)&buf[fr.offset], fr.len, collect_path, &index);
+    }
+
+    Sink sink = {};
+    sink.e2e_us.reserve(1 << 21);
+    SkIngest ingest = { &index, on_slot, &sink, 0 };
+    SkDeltaParseStats pstats = {};
+    std::vector<double> parse_us;
+    parse_us.reserve(frames.size());
+
+    // UI consumer, simulated on the recording's timeline so the result does
+    // not depend on the replay speed
+    uint32_t next_tick = frames[0].rx_ms + ui_ms;
+    uint64_t unseen = 0;
+    auto ui_tick = [&]() {
+        for (int i = 0; i < SK_PATH_INDEX_MAX_SLOTS; i++) {
+            if (sink.slots[i].writes_since_tick > 1) unseen += sink.slots[i].writes_since_tick - 1;
+            sink.slots[i].writes_since_tick = 0;
+        }
+    };
+
+    uint64_t bytes = 0;
+    auto start = replay_clock::now();
+    for (const Frame &fr : frames) {
+        while ((int32_t)(fr.rx_ms - next_tick) >= 0) {
+            ui_tick();
+            next_tick += ui_ms;
+        }
+        if (speed > 0) {
+            double offset_ms = (fr.rx_ms - frames[0].rx_ms) / speed;
+            sink.frame_due = start + std::chrono::microseconds((int64_t)(offset_ms * 1000.0));
+            std::this_thread::sleep_until(sink.frame_due);
+        } else {
+            sink.frame_due = replay_clock::now();
+        }
+        auto t0 = replay_clock::now();
+        sk_ingest_frame(&ingest, (const char *)&buf[fr.offset], fr.len, &pstats);
+        parse_us.push_back(std::chrono::duration<double, std::micro>(replay_clock::now() - t0).count());
+        bytes += fr.len;
+    }
+    ui_tick();
+    double wall = std::chrono::duration<double>(replay_clock::now() - start).count();
+    double recorded = (frames.back().rx_ms - frames.front().rx_ms) / 1000.0;
+
+    std::sort(parse_us.begin(), parse_us.end());
+    std::sort(sink.e2e_us.begin(), sink.e2e_us.end());
+    printf("recording:   %zu frames over %.1f s, %u paths mapped, %llu frames dropped by the recorder\n",
+           frames.size(), recorded, (unsigned)index.count, (unsigned long long)recorder_dropped);
+    char mode[16];
+    if (speed > 0) snprintf(mode, sizeof(mode), "%gx", speed);
+    else snprintf(mode, sizeof(mode), "max");
+    printf("replay:      %s in %.2f s: %.0f frames/s, %.0f values/s, %.2f MB/s\n",
+           mode, wall,
+           frames.size() / wall, pstats.values / wall, bytes / wall / 1e6);
+    printf("parse (us):  p50 %.1f  p99 %.1f  max %.1f per frame\n",
+           pct(parse_us, 0.5), pct(parse_us, 0.99), pct(parse_us, 1.0));
+    printf("e2e (us):    p50 %.1f  p99 %.1f  max %.1f frame arrival -> slot written\n",
+           pct(sink.e2e_us, 0.5), pct(sink.e2e_us, 0.99), pct(sink.e2e_us, 1.0));
+    printf("values:      %lu parsed, %llu slot updates, %lu unmatched, %lu parse errors\n",
+           (unsigned long)pstats.values, (unsigned long long)sink.updates,
+           (unsigned long)ingest.unmatched, (unsigned long)pstats.errors);
+    printf("dropped:     %llu updates overwritten before a %u ms UI tick (%.1f%%)\n",
+           (unsigned long long)unseen, (unsigned)ui_ms, sink.updates ? 100.0 * unseen / sink.updates : 0.0);
+    return 0;
+}
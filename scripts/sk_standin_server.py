@@ -0,0 +1,268 @@
+#!/usr/bin/env python3
+"""Stand-in Signal K server for measuring the display's WebSocket pump.
+
+Answers the discovery request (GET /signalk) and serves a delta stream on
+/signalk/v1/stream with slowly moving values. Every --ping-every seconds it
+sends a WebSocket ping; the display answers from its WS task, so the pong
+round trip includes the time that task takes to notice a readable socket
+(up to 10 ms with a polling loop, about one network round trip when it
+blocks on the socket).
+
+  # point the display's Signal K server at this machine, port 3000
+  python3 scripts/sk_standin_server.py --rate 20 --duration 120 --display 192.168.1.50
+
+At the end it prints the pong round trip percentiles and, with --display,
+the WS task wakeup/awake counters from /metrics and the ingest-to-photon
+p50/p99 from /latency. Run the same command against two firmware builds to
+compare them; --rate 0 sends no deltas (idle CPU and wakeups only).
+Without a display, scripts/sk_pump_bench.cpp connects as a host model of
+the task's old and new loops.
+"""
+import argparse
+import base64
+import hashlib
+import json
+import math
+import os
+import socket
+import struct
+import threading
+import time
+import urllib.request
+
+WS_GUID = '258EAFA5-E914-47DA-95CA-C5AB0DC85B11'
+DEFAULT_PATHS = [
+    'propulsion.port.revolutions',
+    'propulsion.port.temperature',
+    'propulsion.starboard.revolutions',
+    'tanks.fuel.0.currentLevel',
+    'propulsion.port.exhaustTemperature',
+    'propulsion.port.oilPressure',
+]
+
+
+def value_for(path, t):
+    if path.endswith('revolutions'):
+        return 30 + 10 * math.sin(t / 5.0)              # Hz
+    if path.endswith('exhaustTemperature'):
+        return 673.15 + 60 * math.sin(t / 7.0)          # K
+    if 'emperature' in path:
+        return 355.15 + 4 * math.sin(t / 9.0)           # K
+    if path.endswith('Pressure'):
+        return 350000 + 50000 * math.sin(t / 6.0)       # Pa
+    if path.endswith('currentLevel'):
+        return 0.6 + 0.2 * math.sin(t / 11.0)
+    return math.sin(t)
+
+
+def ws_frame(opcode, payload):
+    n = len(payload)
+    if n < 126:
+        hdr = struct.pack('!BB', 0x80 | opcode, n)
+    elif n < 65536:
+        hdr = struct.pack('!BBH', 0x80 | opcode, 126, n)
+    else:
+        hdr = struct.pack('!BBQ', 0x80 | opcode, 127, n)
+    return hdr + payload
+
+
+def recv_exact(conn, n):
+    buf = b''
+    while len(buf) < n:
+        chunk = conn.recv(n - len(buf))
+        if not chunk:
+            raise ConnectionError('closed')
+        buf += chunk
+    return buf
+
+
+def read_frame(conn):
+    b1, b2 = recv_exact(conn, 2)
+    opcode = b1 & 0x0F
+    n = b2 & 0x7F
+    if n == 126:
+        n = struct.unpack('!H', recv_exact(conn, 2))[0]
+    elif n == 127:
+        n = struct.unpack('!Q', recv_exact(conn, 8))[0]
+    mask = recv_exact(conn, 4) if b2 & 0x80 else None
+    payload = bytearray(recv_exact(conn, n))
+    if mask:
+        for i in range(n):
+            payload[i] ^= mask[i & 3]
+    return opcode, bytes(payload)
+
+
+class Session:
+    def __init__(self, conn):
+        self.conn = conn
+        self.lock = threading.Lock()
+        self.pings = {}
+        self.rtt_ms = []
+        self.subscriptions = 0
+        self.closed = False
+
+    def send(self, opcode, payload):
+        with self.lock:
+            self.conn.sendall(ws_frame(opcode, payload))
+
+    def reader(self):
+        try:
+            while True:
+                opcode, payload = read_frame(self.conn)
+                if opcode == 0xA:      # pong
+                    sent = self.pings.pop(payload, None)
+                    if sent is not None:
+                        self.rtt_ms.append((time.perf_counter() - sent) * 1000.0)
+                elif opcode == 0x9:    # ping from the display
+                    self.send(0xA, payload)
+                elif opcode == 0x1:
+                    if b'subscribe' in payload:
+                        self.subscriptions += 1
+                elif opcode == 0x8:
+                    break
+        except (ConnectionError, OSError):
+            pass
+        self.closed = True
+
+
+def handle_http(conn, args, host_ip):
+    req = b''
+    while b'\r\n\r\n' not in req:
+        chunk = conn.recv(4096)
+        if not chunk:
+            return None
+        req += chunk
+    head = req.split(b'\r\n\r\n', 1)[0].decode('latin-1')
+    lines = head.split('\r\n')
+    path = lines[0].split(' ')[1] if len(lines[0].split(' ')) > 1 else '/'
+    headers = {}
+    for line in lines[1:]:
+        if ':' in line:
+            k, v = line.split(':', 1)
+            headers[k.strip().lower()] = v.strip()
+
+    if headers.get('upgrade', '').lower() == 'websocket' and path.startswith('/signalk/v1/stream'):
+        accept = base64.b64encode(hashlib.sha1((headers['sec-websocket-key'] + WS_GUID).encode()).digest())
+        conn.sendall(b'HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+                     b'Sec-WebSocket-Accept: ' + accept + b'\r\n\r\n')
+        return Session(conn)
+
+    if path.rstrip('/') == '/signalk':
+        body = json.dumps({'endpoints': {'v1': {
+            'version': '1.7.0',
+            'signalk-http': 'http://%s:%d/signalk/v1/api/' % (host_ip, args.port),
+            'signalk-ws': 'ws://%s:%d/signalk/v1/stream' % (host_ip, args.port),
+        }}, 'server': {'id': 'sk-standin', 'version': '0'}}).encode()
+        conn.sendall(b'HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %d\r\n'
+                     b'Connection: close\r\n\r\n' % len(body) + body)
+    else:
+        conn.sendall(b'HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n')
+    conn.close()
+    return None
+
+
+def pct(values, p):
+    if not values:
+        return 0.0
+    s = sorted(values)
+    return s[int(p * (len(s) - 1))]
+
+
+def fetch_json(host, path):
+    try:
+        with urllib.request.urlopen('http://%s%s' % (host, path), timeout=3) as r:
+            return json.load(r)
+    except Exception as e:
+        print('%s unavailable: %s' % (path, e))
+        return None
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--port', type=int, default=3000)
+    ap.add_argument('--rate', type=float, default=20.0, help='deltas per second (0 = none)')
+    ap.add_argument('--paths', help='signalk_paths.txt from the display (default: a small engine set)')
+    ap.add_argument('--ping-every', type=float, default=0.5, help='seconds between WebSocket pings')
+    ap.add_argument('--duration', type=float, default=60, help='seconds to stream per connection')
+    ap.add_argument('--display', help='display IP, to read /metrics and /latency at the end')
+    args = ap.parse_args()
+
+    paths = DEFAULT_PATHS
+    if args.paths:
+        with open(args.paths) as f:
+            paths = [l.strip() for l in f if l.strip()]
+
+    srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    srv.bind(('', args.port))
+    srv.listen(4)
+    print('stand-in Signal K server on port %d, %d paths, %.1f deltas/s' % (args.port, len(paths), args.rate))
+
+    if args.display:
+        fetch_json(args.display, '/latency?reset=1')
+    before = fetch_json(args.display, '/metrics') if args.display else None
+
+    session = None
+    while session is None:
+        conn, peer = srv.accept()
+        conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        session = handle_http(conn, args, conn.getsockname()[0])
+    print('display connected from %s:%d' % peer)
+    threading.Thread(target=session.reader, daemon=True).start()
+
+    start = time.time()
+    next_delta = next_ping = start
+    deltas = 0
+    try:
+        while not session.closed and time.time() - start < args.duration:
+            now = time.time()
+            if args.rate > 0 and now >= next_delta:
+                t = now - start
+                msg = {'context': 'vessels.self', 'updates': [{
+                    'source': {'label': 'sk-standin'},
+                    'timestamp': time.strftime('%Y-%m-%dT%H:%M:%S', time.gmtime(now)) + '.%03dZ' % int(now * 1000 % 1000),
+                    'values': [{'path': p, 'value': round(value_for(p, t), 3)} for p in paths],
+                }]}
+                session.send(0x1, json.dumps(msg).encode())
+                deltas += 1
+                next_delta += 1.0 / args.rate
+            if now >= next_ping:
+                token = os.urandom(8)
+                session.pings[token] = time.perf_counter()
+                session.send(0x9, token)
+                next_ping += args.ping_every
+            wake = min(next_ping, next_delta if args.rate > 0 else next_ping)
+            time.sleep(max(0.0, min(wake - time.time(), 0.05)))
+    except KeyboardInterrupt:
+        pass
+    except (BrokenPipeError, ConnectionResetError):
+        print('display disconnected')
+    elapsed = max(time.time() - start, 1e-6)
+
+    rtt = session.rtt_ms
+    print('streamed %d deltas in %.1f s, %d subscription messages received' % (deltas, elapsed, session.subscriptions))
+    print('pong rtt (ms): n %d  p50 %.2f  p99 %.2f  max %.2f' % (len(rtt), pct(rtt, 0.5), pct(rtt, 0.99), pct(rtt, 1.0)))
+
+    if args.display:
+        after = fetch_json(args.display, '/metrics')
+        if before and after:
+            p0 = before.get('signalk', {}).get('pump', {})
+            p1 = after.get('signalk', {}).get('pump', {})
+            wakeups = p1.get('wakeups', 0) - p0.get('wakeups', 0)
+            print('ws task: %.1f wakeups/s (socket %d, notify %d, timer %d), awake %.1f%% since boot' % (
+                wakeups / elapsed,
+                p1.get('socket', 0) - p0.get('socket', 0),
+                p1.get('notify', 0) - p0.get('notify', 0),
+                p1.get('timer', 0) - p0.get('timer', 0),
+                p1.get('awake_permille', 0) / 10.0))
+        lat = fetch_json(args.display, '/latency')
+        if lat:
+            for s in lat.get('slots', []):
+                if s.get('samples'):
+                    print('slot %d: %d samples, ingest->photon p50 <= %d ms, p99 <= %d ms, max %.1f ms' % (
+                        s['slot'], s['samples'], s['p50_ms'], s['p99_ms'], s['max_us'] / 1000.0))
+    session.conn.close()
+
+
+if __name__ == '__main__':
+    main()
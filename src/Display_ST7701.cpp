@@ -1,5 +1,6 @@
 #include "Display_ST7701.h"  
 #include "esp_timer.h"
+#include "latency_probe.h"
 #include <WiFiClientSecure.h>
       
 spi_device_handle_t SPI_handle = NULL;     
@@ -400,6 +401,7 @@ bool example_on_vsync_event(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_pane
   }
   g_vsync_prev_us = now;
   g_vsync_count++;
+  latency_on_vsync(now);
   return false;
 }
 
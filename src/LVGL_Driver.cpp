@@ -9,6 +9,7 @@
 #include "SD_Card.h"
 #include <SD_MMC.h>
 #include "esp_log.h"
+#include "latency_probe.h"
 
 static const char *TAG_LVGL = "LVGL";
 
@@ -110,6 +111,7 @@ void Lvgl_Display_LCD( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_
   uint32_t dur = (uint32_t)esp_timer_get_time() - t0;
   if (dur > g_flush_max_us) g_flush_max_us = dur;
   g_flush_count++;
+  latency_note_flush(lv_disp_flush_is_last(disp_drv));
   lv_disp_flush_ready( disp_drv );
 }
 /*Read the touchpad*/
@@ -0,0 +1,233 @@
+#include "calibration_lut.h"
+#include <cmath>
+#include <cstdlib>
+
+int16_t cal_ref_segments(float value, const void *curve) {
+    const CalCurve *c = (const CalCurve *)curve;
+    for (int i = 0; i < c->n - 1; i++) {
+        float val1 = c->values[i];
+        float val2 = c->values[i + 1];
+        int16_t angle1 = c->angles[i];
+        int16_t angle2 = c->angles[i + 1];
+        if ((val1 <= val2 && value >= val1 && value <= val2) ||
+            (val1 > val2 && value >= val2 && value <= val1)) {
+            float value_range = val2 - val1;
+            if (fabs(value_range) < 0.001) return angle1;
+            float normalized = (value - val1) / value_range;
+            int16_t result;
+            if (angle2 < angle1) {
+                result = angle1 - (int16_t)(normalized * abs(angle2 - angle1));
+            } else {
+                result = angle1 + (int16_t)(normalized * abs(angle2 - angle1));
+            }
+            return result;
+        }
+    }
+    if (value < c->values[0]) return c->angles[0];
+    return c->angles[c->n - 1];
+}
+
+int16_t cal_ref_clamped(float value, const void *curve) {
+    const CalCurve *c = (const CalCurve *)curve;
+    int last = c->n - 1;
+    if (value <= c->values[0]) return c->angles[0];
+    if (value >= c->values[last]) return c->angles[last];
+    for (int i = 0; i < last; i++) {
+        if (value >= c->values[i] && value <= c->values[i + 1]) {
+            float value_range = c->values[i + 1] - c->values[i];
+            if (value_range <= 0) return c->angles[i];
+            float normalized = (value - c->values[i]) / value_range;
+            int16_t angle_range = c->angles[i + 1] - c->angles[i];
+            return c->angles[i] + (int16_t)(normalized * angle_range);
+        }
+    }
+    return c->angles[0];
+}
+
+const char *cal_curve_prepare(CalCurve *c) {
+    if (c->n < 1 || c->n > CAL_LUT_MAX_KNOTS) return "bad point count";
+    if (c->mode >= CAL_MODE_COUNT) return "bad mode";
+    for (int i = 0; i < c->n; i++) c->tangents[i] = 0;
+    if (c->mode == CAL_LINEAR) return NULL;
+    for (int i = 0; i < c->n; i++) {
+        if (!std::isfinite(c->values[i])) return "bad value";
+    }
+    if (c->n < 2) return "needs two points";
+    for (int i = 0; i + 1 < c->n; i++) {
+        if (!(c->values[i + 1] > c->values[i])) return "values must increase";
+    }
+    if (c->mode == CAL_LOG) return c->values[0] > 0 ? NULL : "values must be above 0";
+
+    // Fritsch-Carlson: secant slopes, averaged where they agree in sign,
+    // then scaled back so no segment overshoots
+    float d[CAL_LUT_MAX_KNOTS];
+    int last = c->n - 1;
+    for (int i = 0; i < last; i++) {
+        d[i] = (c->angles[i + 1] - c->angles[i]) / (c->values[i + 1] - c->values[i]);
+    }
+    c->tangents[0] = d[0];
+    c->tangents[last] = d[last - 1];
+    for (int i = 1; i < last; i++) {
+        c->tangents[i] = (d[i - 1] * d[i] <= 0) ? 0 : (d[i - 1] + d[i]) / 2;
+    }
+    for (int i = 0; i < last; i++) {
+        if (d[i] == 0) {
+            c->tangents[i] = 0;
+            c->tangents[i + 1] = 0;
+            continue;
+        }
+        float a = c->tangents[i] / d[i];
+        float b = c->tangents[i + 1] / d[i];
+        float r = a * a + b * b;
+        if (r > 9) {
+            float tau = 3 / sqrtf(r);
+            c->tangents[i] = tau * a * d[i];
+            c->tangents[i + 1] = tau * b * d[i];
+        }
+    }
+    return NULL;
+}
+
+// Segment of an increasing curve holding value, or -1 / n - 1 outside it
+static int find_segment(const CalCurve *c, float value) {
+    if (value <= c->values[0]) return -1;
+    if (!(value < c->values[c->n - 1])) return c->n - 1;   // and NaN
+    int i = 0;
+    while (value > c->values[i + 1]) i++;
+    return i;
+}
+
+int16_t cal_ref_cubic(float value, const void *curve) {
+    const CalCurve *c = (const CalCurve *)curve;
+    int i = find_segment(c, value);
+    if (i < 0) return c->angles[0];
+    if (i == c->n - 1) return c->angles[i];
+    float h = c->values[i + 1] - c->values[i];
+    float t = (value - c->values[i]) / h;
+    float y0 = c->angles[i], y1 = c->angles[i + 1];
+    float m0 = c->tangents[i] * h, m1 = c->tangents[i + 1] * h;
+    float c2 = 3 * (y1 - y0) - 2 * m0 - m1;
+    float c3 = 2 * (y0 - y1) + m0 + m1;
+    return (int16_t)lroundf(y0 + t * (m0 + t * (c2 + t * c3)));
+}
+
+int16_t cal_ref_log(float value, const void *curve) {
+    const CalCurve *c = (const CalCurve *)curve;
+    int i = find_segment(c, value);
+    if (i < 0) return c->angles[0];
+    if (i == c->n - 1) return c->angles[i];
+    float l0 = logf(c->values[i]);
+    float t = (logf(value) - l0) / (logf(c->values[i + 1]) - l0);
+    return (int16_t)lroundf(c->angles[i] + t * (c->angles[i + 1] - c->angles[i]));
+}
+
+CalRefFn cal_ref_for_mode(uint8_t mode) {
+    if (mode == CAL_CUBIC) return cal_ref_cubic;
+    if (mode == CAL_LOG) return cal_ref_log;
+    return cal_ref_segments;
+}
+
+static float key_to_float(uint32_t key) {
+    uint32_t u = (key & 0x80000000u) ? (key & 0x7FFFFFFFu) : ~key;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+struct Builder {
+    CalRefFn ref;
+    const void *ctx;
+    uint32_t *keys;
+    int16_t *angles;
+    uint32_t count;
+};
+
+static int16_t eval_key(Builder &b, uint32_t key) {
+    return b.ref(key_to_float(key), b.ctx);
+}
+
+static bool emit(Builder &b, uint32_t key, int16_t angle) {
+    if (b.count > 0 && b.angles[b.count - 1] == angle) return true;
+    if (b.count >= CAL_LUT_MAX_ENTRIES) return false;
+    b.keys[b.count] = key;
+    b.angles[b.count] = angle;
+    b.count++;
+    return true;
+}
+
+// The reference is monotone between knots, so equal ends mean no step inside
+static bool bisect(Builder &b, uint32_t lo, uint32_t hi, int16_t f_lo, int16_t f_hi) {
+    if (f_lo == f_hi) return true;
+    if (hi - lo == 1) return emit(b, hi, f_hi);
+    uint32_t mid = lo + (hi - lo) / 2;
+    int16_t f_mid = eval_key(b, mid);
+    return bisect(b, lo, mid, f_lo, f_mid) && bisect(b, mid, hi, f_mid, f_hi);
+}
+
+static int cmp_key(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+bool cal_lut_build(CalLut *lut, CalRefFn ref, const CalCurve *curve) {
+    cal_lut_free(lut);
+    const uint32_t key_ninf = cal_lut_key(-INFINITY);
+    const uint32_t key_pinf = cal_lut_key(INFINITY);
+
+    // Segment membership changes at a point (x >= v) and just past it (x <= v)
+    uint32_t cuts[2 * CAL_LUT_MAX_KNOTS + 1];
+    int ncuts = 0;
+    cuts[ncuts++] = key_ninf;
+    for (int i = 0; i < curve->n && i < CAL_LUT_MAX_KNOTS; i++) {
+        if (std::isnan(curve->values[i])) continue;
+        uint32_t k = cal_lut_key(curve->values[i]);
+        if (k > key_ninf) cuts[ncuts++] = k;
+        if (k < key_pinf) cuts[ncuts++] = k + 1;
+    }
+    qsort(cuts, ncuts, sizeof(cuts[0]), cmp_key);
+
+    Builder b = { ref, curve, NULL, NULL, 0 };
+    b.keys = (uint32_t *)malloc(CAL_LUT_MAX_ENTRIES * sizeof(uint32_t));
+    b.angles = (int16_t *)malloc(CAL_LUT_MAX_ENTRIES * sizeof(int16_t));
+    bool ok = b.keys != NULL && b.angles != NULL;
+
+    // NaN sorts below -inf (negative) and above +inf (positive)
+    int16_t nan_angle = ref(NAN, curve);
+    ok = ok && emit(b, 0, nan_angle);
+    for (int c = 0; ok && c < ncuts; c++) {
+        if (c > 0 && cuts[c] == cuts[c - 1]) continue;
+        uint32_t lo = cuts[c];
+        uint32_t hi = key_pinf;
+        for (int d = c + 1; d < ncuts; d++) {
+            if (cuts[d] != lo) {
+                hi = cuts[d] - 1;
+                break;
+            }
+        }
+        int16_t f_lo = eval_key(b, lo);
+        int16_t f_hi = eval_key(b, hi);
+        ok = emit(b, lo, f_lo) && bisect(b, lo, hi, f_lo, f_hi);
+    }
+    ok = ok && emit(b, key_pinf + 1, nan_angle);
+
+    if (!ok) {
+        free(b.keys);
+        free(b.angles);
+        return false;
+    }
+    // Keep only what was used
+    uint32_t *keys = (uint32_t *)realloc(b.keys, b.count * sizeof(uint32_t));
+    int16_t *angles = (int16_t *)realloc(b.angles, b.count * sizeof(int16_t));
+    lut->keys = keys ? keys : b.keys;
+    lut->angles = angles ? angles : b.angles;
+    lut->count = (uint16_t)b.count;
+    return true;
+}
+
+void cal_lut_free(CalLut *lut) {
+    free(lut->keys);
+    free(lut->angles);
+    lut->keys = NULL;
+    lut->angles = NULL;
+    lut->count = 0;
+}
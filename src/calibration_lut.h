@@ -0,0 +1,96 @@
+#ifndef CALIBRATION_LUT_H
+#define CALIBRATION_LUT_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Calibration curves compiled into step tables.
+//
+// A value-to-angle curve returns whole degrees, so over the float line it is
+// a step function. cal_lut_build() finds every step of a reference mapping
+// (one of the interpolations below) by bisection on the float's bit pattern
+// and stores them as (key, angle) pairs, where the key orders floats like
+// unsigned integers (-inf < ... < -0 = +0 < ... < +inf, NaN at both ends).
+// A lookup is then a fixed-length, branch-free binary search over integers:
+// no float compares or divides, and bit-for-bit the reference result for
+// every input, by construction. scripts/calibration_bench.cpp checks that
+// over all 2^32 inputs.
+//
+// Plain C++ with no Arduino dependencies so it can also be built on a host.
+
+#define CAL_LUT_MAX_ENTRIES 1024
+#define CAL_LUT_MAX_KNOTS 32
+
+enum CalMode : uint8_t {
+    CAL_LINEAR = 0,      // straight segments, truncated (the original mapping)
+    CAL_CUBIC,           // monotone cubic (Fritsch-Carlson), rounded
+    CAL_LOG,             // straight in log(value), rounded; values > 0
+    CAL_MODE_COUNT
+};
+
+struct CalLut {
+    uint32_t *keys;        // ascending, keys[0] == 0
+    int16_t *angles;       // angle from keys[i] up to keys[i + 1] - 1
+    uint16_t count;        // 0 = not built
+};
+
+// Reference mappings; `ctx` is what was passed to cal_lut_build().
+typedef int16_t (*CalRefFn)(float value, const void *ctx);
+
+// A curve of n points as the reference functions see it
+struct CalCurve {
+    float values[CAL_LUT_MAX_KNOTS];
+    int16_t angles[CAL_LUT_MAX_KNOTS];
+    float tangents[CAL_LUT_MAX_KNOTS];   // degrees per unit, CAL_CUBIC only
+    uint8_t n;
+    uint8_t mode;                        // CalMode
+};
+
+// Check a curve for its mode and compute the cubic tangents. Returns NULL
+// or a short message. CAL_CUBIC and CAL_LOG need at least two points with
+// strictly increasing values (CAL_LOG: all above 0); CAL_LINEAR takes any.
+const char *cal_curve_prepare(CalCurve *curve);
+
+// First segment containing the value (either direction), interpolated and
+// truncated; nearest end outside. gauge_value_to_angle_screen()'s mapping.
+int16_t cal_ref_segments(float value, const void *curve);
+
+// Clamped to the first/last point, then the first ascending segment.
+// gauge_top_value_to_angle()'s mapping.
+int16_t cal_ref_clamped(float value, const void *curve);
+
+// Prepared CAL_CUBIC / CAL_LOG curves, evaluated in double and rounded to
+// the nearest degree; clamped to the end points, NaN gives the last point.
+int16_t cal_ref_cubic(float value, const void *curve);
+int16_t cal_ref_log(float value, const void *curve);
+
+// Reference for a curve's mode (cal_ref_segments for CAL_LINEAR)
+CalRefFn cal_ref_for_mode(uint8_t mode);
+
+// Order-preserving integer key of a float (both zeros give the same key)
+static inline uint32_t cal_lut_key(float value) {
+    value += 0.0f;   // -0 -> +0
+    uint32_t u;
+    memcpy(&u, &value, sizeof(u));
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+// Build `lut` from `ref`. The curve's point values tell the builder where the
+// segment a value falls into can change. Returns false (and leaves `lut`
+// empty) if the table would exceed CAL_LUT_MAX_ENTRIES or memory runs out.
+bool cal_lut_build(CalLut *lut, CalRefFn ref, const CalCurve *curve);
+void cal_lut_free(CalLut *lut);
+
+static inline int16_t cal_lut_lookup(const CalLut *lut, float value) {
+    uint32_t k = cal_lut_key(value);
+    const uint32_t *base = lut->keys;
+    uint32_t n = lut->count;
+    while (n > 1) {
+        uint32_t half = n >> 1;
+        base = (base[half] <= k) ? base + half : base;
+        n -= half;
+    }
+    return lut->angles[base - lut->keys];
+}
+
+#endif // CALIBRATION_LUT_H
@@ -0,0 +1,192 @@
+#include "calibration_store.h"
+#include "gauge_curves.h"
+#include "network_setup.h"   // gauge_cal
+#include <Preferences.h>
+#include <esp_rom_crc.h>
+
+#define CAL_STORE_MAGIC 0x424C4143u   // "CALB"
+
+struct CalStoreBlob {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;                                     // sizeof(CalStoreBlob)
+    GaugeCalibrationPoint points[NUM_SCREENS][2][5];   // gauge_cal
+    uint16_t custom_mask;                              // slots using curves[]
+    uint16_t reserved;
+    GaugeCurve curves[TOTAL_PARAMS];
+    ParamCalibration params[PARAM_TYPE_COUNT][2];      // GaugeConfig::calibrations
+    ParamCalibration legacy_top;                       // GaugeConfig::top_values/top_angles
+    ParamCalibration legacy_bottom;
+    uint32_t crc;                                      // over everything before it
+};
+
+static CalStoreBlob blob;          // what NVS holds, or will once written
+static CalStoreBlob next;          // cal_store_save() scratch, too big for the stack
+static bool loaded = false;        // the boot read has been made
+static bool params_ready = false;  // blob.params are valid
+static bool stored = false;        // blob matches NVS
+static CalStoreStats stats = {};
+
+static uint32_t blob_crc(const CalStoreBlob &b) {
+    return esp_rom_crc32_le(0, (const uint8_t *)&b, offsetof(CalStoreBlob, crc));
+}
+
+static bool write_blob() {
+    blob.magic = CAL_STORE_MAGIC;
+    blob.version = CAL_STORE_VERSION;
+    blob.size = sizeof(blob);
+    blob.reserved = 0;
+    blob.crc = blob_crc(blob);
+    uint32_t t0 = micros();
+    Preferences prefs;
+    size_t written = 0;
+    if (prefs.begin("calib", false)) {
+        written = prefs.putBytes("blob", &blob, sizeof(blob));
+        prefs.end();
+    }
+    stats.save_us = micros() - t0;
+    stored = written == sizeof(blob);
+    if (!stored) {
+        stats.save_errors++;
+        return false;
+    }
+    stats.saves++;
+    return true;
+}
+
+// gauge_cal already holds the screen configs' points; custom curves were
+// one key per slot
+static void migrate_screens() {
+    memcpy(blob.points, gauge_cal, sizeof(blob.points));
+    Preferences prefs;
+    if (!prefs.begin("curves", true)) return;
+    for (int slot = 0; slot < TOTAL_PARAMS; slot++) {
+        char key[8];
+        snprintf(key, sizeof(key), "c%d", slot);
+        stats.legacy_reads++;
+        if (prefs.getBytesLength(key) != sizeof(GaugeCurve)) continue;
+        GaugeCurve c;
+        prefs.getBytes(key, &c, sizeof(c));
+        CalCurve cal;
+        if (gauge_curve_to_cal(&c, &cal) != NULL) continue;
+        blob.curves[slot] = c;
+        blob.custom_mask |= 1u << slot;
+    }
+    prefs.end();
+}
+
+static void migrate_params(GaugeConfig &cfg) {
+    Preferences prefs;
+    if (!prefs.begin("settings", true)) {
+        Serial.println("[cal_store] Preferences not available; using defaults.");
+        return;
+    }
+    const char* param_names[] = {"rpm", "coolant", "fuel", "exhaust", "oil"};
+    const char* pos_names[] = {"top", "bot"};
+    for (int p = 0; p < PARAM_TYPE_COUNT; p++) {
+        for (int pos = 0; pos < 2; pos++) {
+            for (int i = 0; i < CALIBRATION_POINTS; i++) {
+                char key[32];
+                snprintf(key, sizeof(key), "%s_%s_val_%d", param_names[p], pos_names[pos], i);
+                cfg.calibrations[p][pos].values[i] = prefs.getFloat(key, cfg.calibrations[p][pos].values[i]);
+                snprintf(key, sizeof(key), "%s_%s_ang_%d", param_names[p], pos_names[pos], i);
+                cfg.calibrations[p][pos].angles[i] = prefs.getShort(key, cfg.calibrations[p][pos].angles[i]);
+                stats.legacy_reads += 2;
+            }
+        }
+    }
+    for (int i = 0; i < CALIBRATION_POINTS; i++) {
+        char key[16];
+        snprintf(key, sizeof(key), "top_val_%d", i);
+        cfg.top_values[i] = prefs.getFloat(key, cfg.top_values[i]);
+        snprintf(key, sizeof(key), "top_ang_%d", i);
+        cfg.top_angles[i] = prefs.getShort(key, cfg.top_angles[i]);
+        snprintf(key, sizeof(key), "bot_val_%d", i);
+        cfg.bottom_values[i] = prefs.getFloat(key, cfg.bottom_values[i]);
+        snprintf(key, sizeof(key), "bot_ang_%d", i);
+        cfg.bottom_angles[i] = prefs.getShort(key, cfg.bottom_angles[i]);
+        stats.legacy_reads += 4;
+    }
+    prefs.end();
+}
+
+static void copy_params(CalStoreBlob &b, const GaugeConfig &cfg) {
+    memcpy(b.params, cfg.calibrations, sizeof(b.params));
+    memcpy(b.legacy_top.values, cfg.top_values, sizeof(cfg.top_values));
+    memcpy(b.legacy_top.angles, cfg.top_angles, sizeof(cfg.top_angles));
+    memcpy(b.legacy_bottom.values, cfg.bottom_values, sizeof(cfg.bottom_values));
+    memcpy(b.legacy_bottom.angles, cfg.bottom_angles, sizeof(cfg.bottom_angles));
+}
+
+static void ensure_loaded() {
+    if (loaded) return;
+    loaded = true;
+    uint32_t t0 = micros();
+    Preferences prefs;
+    size_t got = 0;
+    if (prefs.begin("calib", true)) {
+        got = prefs.getBytes("blob", &blob, sizeof(blob));
+        prefs.end();
+    }
+    bool ok = got == sizeof(blob) && blob.magic == CAL_STORE_MAGIC && blob.version == CAL_STORE_VERSION &&
+              blob.size == sizeof(blob) && blob.crc == blob_crc(blob);
+    stats.load_us = micros() - t0;
+    stats.bytes = sizeof(blob);
+    if (ok) {
+        stats.source = CAL_SOURCE_BLOB;
+        params_ready = true;
+        stored = true;
+        return;
+    }
+    stats.rejected = got != 0;
+    stats.source = CAL_SOURCE_LEGACY;
+    memset(&blob, 0, sizeof(blob));
+    uint32_t t1 = micros();
+    migrate_screens();
+    stats.migrate_us = micros() - t1;
+}
+
+void cal_store_load_screens() {
+    ensure_loaded();
+    memcpy(gauge_cal, blob.points, sizeof(blob.points));
+    gauge_curves_import(blob.curves, blob.custom_mask);
+}
+
+void cal_store_load_params(GaugeConfig &cfg) {
+    ensure_loaded();
+    if (params_ready) {
+        memcpy(cfg.calibrations, blob.params, sizeof(blob.params));
+        memcpy(cfg.top_values, blob.legacy_top.values, sizeof(cfg.top_values));
+        memcpy(cfg.top_angles, blob.legacy_top.angles, sizeof(cfg.top_angles));
+        memcpy(cfg.bottom_values, blob.legacy_bottom.values, sizeof(cfg.bottom_values));
+        memcpy(cfg.bottom_angles, blob.legacy_bottom.angles, sizeof(cfg.bottom_angles));
+        Serial.printf("[cal_store] Calibration blob (%u bytes) loaded in %lu us\n", (unsigned)stats.bytes,
+                      (unsigned long)stats.load_us);
+        return;
+    }
+    uint32_t t0 = micros();
+    migrate_params(cfg);
+    stats.migrate_us += micros() - t0;
+    copy_params(blob, cfg);
+    params_ready = true;
+    bool ok = write_blob();
+    Serial.printf("[cal_store] %sMigrated calibration: %u legacy reads in %lu us, blob %s\n",
+                  stats.rejected ? "Blob rejected. " : "", (unsigned)stats.legacy_reads,
+                  (unsigned long)(stats.load_us + stats.migrate_us), ok ? "written" : "write failed");
+}
+
+bool cal_store_save() {
+    ensure_loaded();
+    next = blob;
+    memcpy(next.points, gauge_cal, sizeof(next.points));
+    gauge_curves_export(next.curves, &next.custom_mask);
+    copy_params(next, current_config);
+    if (stored && params_ready && memcmp(&next, &blob, offsetof(CalStoreBlob, crc)) == 0) return true;
+    blob = next;
+    params_ready = true;
+    return write_blob();
+}
+
+void cal_store_get_stats(CalStoreStats *out) {
+    *out = stats;
+}
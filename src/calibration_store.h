@@ -0,0 +1,55 @@
+#ifndef CALIBRATION_STORE_H
+#define CALIBRATION_STORE_H
+
+#include <Arduino.h>
+#include "gauge_config.h"
+
+// Every calibration in one versioned, CRC-checked NVS blob (namespace
+// "calib", key "blob"): the Gauges page points (gauge_cal), the custom
+// curves (gauge_curves.h) and GaugeConfig's per-parameter and legacy
+// top/bottom curves. Boot reads it with a single lookup.
+//
+// Without a valid blob (first boot on this firmware, or a rejected one)
+// the calibration is migrated from the older storage and written back as a
+// blob: gauge_cal from the per-screen ScreenConfig blobs load_preferences()
+// reads, custom curves from namespace "curves", and GaugeConfig from the
+// per-point "settings" keys (%s_%s_val_%d / _ang_%d, top_val_%d, bot_val_%d).
+// Those keys are left in place for older firmware.
+
+#define CAL_STORE_VERSION 1
+
+enum CalStoreSource : uint8_t {
+    CAL_SOURCE_NONE = 0,
+    CAL_SOURCE_BLOB,       // read the blob
+    CAL_SOURCE_LEGACY,     // migrated this boot
+};
+
+struct CalStoreStats {
+    uint8_t source;        // CalStoreSource
+    bool rejected;         // a blob was found but failed its checks
+    uint16_t bytes;        // blob size
+    uint16_t legacy_reads; // NVS lookups made by the migration
+    uint32_t load_us;      // blob read and check at boot
+    uint32_t migrate_us;   // legacy reads, 0 unless migrating
+    uint32_t saves;
+    uint32_t save_errors;
+    uint32_t save_us;      // last write
+};
+
+// Set gauge_cal and the custom curves from the blob (read on the first
+// call, migrated if needed). Called by load_preferences() after it has
+// filled gauge_cal from the screen configs.
+void cal_store_load_screens();
+
+// Set cfg's curves from the blob, or migrate them from the "settings" keys
+// over the defaults already in cfg and write the blob. Called once by
+// gauge_config_init().
+void cal_store_load_params(GaugeConfig &cfg);
+
+// Write the current gauge_cal, custom curves and current_config. Skips the
+// write when nothing changed. Returns false if NVS refused it.
+bool cal_store_save();
+
+void cal_store_get_stats(CalStoreStats *out);
+
+#endif // CALIBRATION_STORE_H
@@ -0,0 +1,213 @@
+#include "derived_expr.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct Compiler {
+    const char *p;
+    DexprProgram *out;
+    DexprResolve resolve;
+    void *ctx;
+    char *err;
+    size_t err_len;
+    int depth;
+    int nesting;       // parser recursion depth
+    bool failed;
+};
+
+static bool fail(Compiler &c, const char *msg) {
+    if (!c.failed) {
+        c.failed = true;
+        if (c.err_len) snprintf(c.err, c.err_len, "%s", msg);
+    }
+    return false;
+}
+
+static void skip_space(Compiler &c) {
+    while (*c.p == ' ' || *c.p == '\t') c.p++;
+}
+
+static bool emit(Compiler &c, uint8_t op, int push) {
+    if (c.out->len >= DEXPR_MAX_CODE) return fail(c, "expression too long");
+    c.out->code[c.out->len++] = op;
+    c.depth += push;
+    if (c.depth > DEXPR_MAX_STACK) return fail(c, "expression nested too deeply");
+    return true;
+}
+
+static bool emit_arg(Compiler &c, uint8_t op, uint8_t arg, int push) {
+    if (!emit(c, op, push)) return false;
+    if (c.out->len >= DEXPR_MAX_CODE) return fail(c, "expression too long");
+    c.out->code[c.out->len++] = arg;
+    return true;
+}
+
+static bool parse_expr(Compiler &c);
+
+// Arguments of a function call, the name and '(' already consumed
+static bool parse_args(Compiler &c, int count) {
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            skip_space(c);
+            if (*c.p != ',') return fail(c, "expected ','");
+            c.p++;
+        }
+        if (!parse_expr(c)) return false;
+    }
+    skip_space(c);
+    if (*c.p != ')') return fail(c, "expected ')'");
+    c.p++;
+    return true;
+}
+
+static bool parse_primary(Compiler &c) {
+    skip_space(c);
+    char ch = *c.p;
+    if (ch == '(') {
+        c.p++;
+        if (!parse_expr(c)) return false;
+        skip_space(c);
+        if (*c.p != ')') return fail(c, "expected ')'");
+        c.p++;
+        return true;
+    }
+    if (isdigit((unsigned char)ch) || ch == '.') {
+        char *end;
+        float v = strtof(c.p, &end);
+        if (end == c.p) return fail(c, "bad number");
+        c.p = end;
+        int k = 0;
+        while (k < c.out->nconsts && memcmp(&c.out->consts[k], &v, sizeof(v)) != 0) k++;
+        if (k == c.out->nconsts) {
+            if (k >= DEXPR_MAX_CONSTS) return fail(c, "too many constants");
+            c.out->consts[c.out->nconsts++] = v;
+        }
+        return emit_arg(c, DEXPR_CONST, (uint8_t)k, 1);
+    }
+    if (isalpha((unsigned char)ch) || ch == '_') {
+        const char *name = c.p;
+        while (isalnum((unsigned char)*c.p) || *c.p == '_' || *c.p == '.') c.p++;
+        size_t len = (size_t)(c.p - name);
+        const char *after = c.p;
+        skip_space(c);
+        if (*c.p == '(') {
+            c.p++;
+            if (len == 3 && memcmp(name, "min", 3) == 0) return parse_args(c, 2) && emit(c, DEXPR_MIN, -1);
+            if (len == 3 && memcmp(name, "max", 3) == 0) return parse_args(c, 2) && emit(c, DEXPR_MAX, -1);
+            if (len == 3 && memcmp(name, "abs", 3) == 0) return parse_args(c, 1) && emit(c, DEXPR_ABS, 0);
+            if (len == 4 && memcmp(name, "rate", 4) == 0) {
+                if (c.out->nrates >= DEXPR_MAX_RATES) return fail(c, "too many rate()");
+                uint8_t r = c.out->nrates++;
+                return parse_args(c, 1) && emit_arg(c, DEXPR_RATE, r, 0);
+            }
+            return fail(c, "unknown function");
+        }
+        c.p = after;
+        int v = c.resolve(name, len, c.ctx);
+        if (v < 0 || v >= DEXPR_MAX_VARS) {
+            if (c.err_len) snprintf(c.err, c.err_len, "unknown name '%.*s'", (int)(len > 24 ? 24 : len), name);
+            c.failed = true;
+            return false;
+        }
+        c.out->deps |= 1u << v;
+        return emit_arg(c, DEXPR_VAR, (uint8_t)v, 1);
+    }
+    return fail(c, ch ? "unexpected character" : "unexpected end");
+}
+
+// Every descent (parentheses, call arguments, unary minus) comes through
+// here, so this bounds the parser's recursion. Nesting emits no code, so the
+// evaluation stack limit in emit() does not catch it, and expressions are
+// compiled on the loop task with a small stack.
+static bool parse_unary(Compiler &c) {
+    if (c.nesting >= DEXPR_MAX_NESTING) return fail(c, "expression nested too deeply");
+    c.nesting++;
+    skip_space(c);
+    bool ok;
+    if (*c.p == '-') {
+        c.p++;
+        ok = parse_unary(c) && emit(c, DEXPR_NEG, 0);
+    } else {
+        ok = parse_primary(c);
+    }
+    c.nesting--;
+    return ok;
+}
+
+static bool parse_term(Compiler &c) {
+    if (!parse_unary(c)) return false;
+    for (;;) {
+        skip_space(c);
+        char op = *c.p;
+        if (op != '*' && op != '/') return true;
+        c.p++;
+        if (!parse_unary(c)) return false;
+        if (!emit(c, op == '*' ? DEXPR_MUL : DEXPR_DIV, -1)) return false;
+    }
+}
+
+static bool parse_expr(Compiler &c) {
+    if (!parse_term(c)) return false;
+    for (;;) {
+        skip_space(c);
+        char op = *c.p;
+        if (op != '+' && op != '-') return true;
+        c.p++;
+        if (!parse_term(c)) return false;
+        if (!emit(c, op == '+' ? DEXPR_ADD : DEXPR_SUB, -1)) return false;
+    }
+}
+
+bool dexpr_compile(const char *src, DexprProgram *out, DexprResolve resolve, void *ctx,
+                   char *err, size_t err_len) {
+    memset(out, 0, sizeof(*out));
+    if (err_len) err[0] = '\0';
+    Compiler c = { src, out, resolve, ctx, err, err_len, 0, 0, false };
+    if (!parse_expr(c)) return false;
+    skip_space(c);
+    if (*c.p != '\0') return fail(c, "unexpected character");
+    return true;
+}
+
+float dexpr_eval(const DexprProgram *p, const float *vars, DexprRate *rates, uint32_t now_ms) {
+    float st[DEXPR_MAX_STACK];
+    int sp = 0;
+    for (uint8_t pc = 0; pc < p->len;) {
+        switch (p->code[pc++]) {
+        case DEXPR_CONST: st[sp++] = p->consts[p->code[pc++]]; break;
+        case DEXPR_VAR:   st[sp++] = vars[p->code[pc++]]; break;
+        case DEXPR_ADD:   sp--; st[sp - 1] += st[sp]; break;
+        case DEXPR_SUB:   sp--; st[sp - 1] -= st[sp]; break;
+        case DEXPR_MUL:   sp--; st[sp - 1] *= st[sp]; break;
+        case DEXPR_DIV:   sp--; st[sp - 1] /= st[sp]; break;
+        case DEXPR_NEG:   st[sp - 1] = -st[sp - 1]; break;
+        case DEXPR_MIN:   sp--; st[sp - 1] = fminf(st[sp - 1], st[sp]); break;
+        case DEXPR_MAX:   sp--; st[sp - 1] = fmaxf(st[sp - 1], st[sp]); break;
+        case DEXPR_ABS:   st[sp - 1] = fabsf(st[sp - 1]); break;
+        case DEXPR_RATE: {
+            DexprRate &r = rates[p->code[pc++]];
+            float x = st[sp - 1];
+            if (!isnan(x)) {
+                if (!r.primed) {
+                    r.last_x = x;
+                    r.last_ms = now_ms;
+                    r.rate = 0;
+                    r.primed = true;
+                } else if (now_ms - r.last_ms >= DEXPR_RATE_MIN_MS) {
+                    float inst = (x - r.last_x) * 1000.0f / (float)(now_ms - r.last_ms);
+                    r.rate += (inst - r.rate) * 0.25f;
+                    r.last_x = x;
+                    r.last_ms = now_ms;
+                }
+            }
+            st[sp - 1] = r.rate;
+            break;
+        }
+        default:
+            return NAN;
+        }
+    }
+    return sp == 1 ? st[0] : NAN;
+}
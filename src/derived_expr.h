@@ -0,0 +1,72 @@
+#ifndef DERIVED_EXPR_H
+#define DERIVED_EXPR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Small arithmetic expressions over numbered variables, compiled once into
+// stack bytecode and evaluated without allocation.
+//
+//   expr    := term (('+' | '-') term)*
+//   term    := unary (('*' | '/') unary)*
+//   unary   := '-' unary | primary
+//   primary := number | name | func '(' expr [',' expr] ')' | '(' expr ')'
+//   func    := min | max | abs | rate
+//
+// Names ([A-Za-z_][A-Za-z0-9_.]*, so Signal K paths are names too) are
+// turned into variable ids by the caller's resolver. rate(x) is the change
+// of x per second, measured over at least DEXPR_RATE_MIN_MS between updates
+// and smoothed; it only advances when the program is evaluated.
+//
+// Plain C++ with no Arduino dependencies so it can also be built on a host.
+
+#define DEXPR_MAX_CODE 64      // bytes of bytecode
+#define DEXPR_MAX_CONSTS 16
+#define DEXPR_MAX_STACK 8
+#define DEXPR_MAX_RATES 2
+#define DEXPR_MAX_NESTING 16   // parentheses, calls and unary minus, counted together
+#define DEXPR_MAX_VARS 32      // variable ids 0..31, one bit each in `deps`
+#define DEXPR_RATE_MIN_MS 1000
+
+enum DexprOp : uint8_t {
+    DEXPR_CONST = 0,   // + const index
+    DEXPR_VAR,         // + variable id
+    DEXPR_ADD,
+    DEXPR_SUB,
+    DEXPR_MUL,
+    DEXPR_DIV,
+    DEXPR_NEG,
+    DEXPR_MIN,
+    DEXPR_MAX,
+    DEXPR_ABS,
+    DEXPR_RATE,        // + rate state index
+};
+
+struct DexprProgram {
+    uint8_t code[DEXPR_MAX_CODE];
+    uint8_t len;
+    uint8_t nconsts;
+    uint8_t nrates;
+    float consts[DEXPR_MAX_CONSTS];
+    uint32_t deps;     // bit v set => reads variable v
+};
+
+struct DexprRate {
+    float last_x;
+    float rate;
+    uint32_t last_ms;
+    bool primed;
+};
+
+// Map a name to a variable id (0..DEXPR_MAX_VARS-1), or -1 if unknown.
+typedef int (*DexprResolve)(const char *name, size_t len, void *ctx);
+
+// Compile `src`. On failure returns false with a short message in `err`.
+bool dexpr_compile(const char *src, DexprProgram *out, DexprResolve resolve, void *ctx,
+                   char *err, size_t err_len);
+
+// Evaluate with the current variable values. `rates` holds the program's
+// rate() state (nrates entries, zeroed before the first call).
+float dexpr_eval(const DexprProgram *p, const float *vars, DexprRate *rates, uint32_t now_ms);
+
+#endif // DERIVED_EXPR_H
@@ -0,0 +1,308 @@
+#include "derived_signals.h"
+#include "derived_expr.h"
+#include "sensor_store.h"
+#include "network_setup.h"
+#include "signalk_path_index.h"   // SK_PATH_MAX_LEN
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <ctype.h>
+#include <math.h>
+
+// Variable ids shared by expressions and dependency masks
+#define VAR_SLOT(i) (i)
+#define VAR_INPUT(k) (TOTAL_PARAMS + (k))
+#define VAR_NODE(n) (TOTAL_PARAMS + DERIVED_MAX_INPUTS + (n))
+#define SLOT_AND_INPUT_VARS ((1u << VAR_NODE(0)) - 1)
+
+struct DerivedNode {
+    DexprProgram prog;
+    DexprRate rates[DEXPR_MAX_RATES];
+    uint32_t out_slots;       // gauge slots showing this node
+    uint32_t feeds;           // slot/input variables it depends on, transitively
+};
+
+struct DerivedGraph {
+    DerivedNode nodes[DERIVED_MAX];
+    uint8_t order[DERIVED_MAX];   // topological, compiled nodes only
+    uint8_t count;
+    uint32_t triggers;            // slot/input variables some node reads
+    uint32_t outputs;             // union of out_slots
+};
+
+static DerivedDef defs[DERIVED_MAX];
+static DerivedStatus status[DERIVED_MAX];       // error text and out_slots; value/evals live below
+static char input_paths[DERIVED_MAX_INPUTS][SK_PATH_MAX_LEN];
+static int input_count = 0;
+
+// Live state, guarded by `lock`
+static DerivedGraph graph;
+static float vars[DEXPR_MAX_VARS];
+static uint32_t node_evals[DERIVED_MAX];
+static DerivedStats stats = {};
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t trigger_mask = 0;              // copy of graph.triggers for the lock-free check
+
+static DerivedGraph staging;                   // built by derived_init() (loop task)
+
+struct ResolveCtx {
+    const int8_t *slot_node;                   // slot -> node showing it, -1 = none
+};
+
+static int find_def(const char *name, size_t len) {
+    for (int n = 0; n < DERIVED_MAX; n++) {
+        if (defs[n].name[0] && strlen(defs[n].name) == len && memcmp(defs[n].name, name, len) == 0) return n;
+    }
+    return -1;
+}
+
+// "s<digits>" naming a gauge slot
+static int slot_name(const char *name, size_t len) {
+    if (len < 2 || len > 3 || name[0] != 's') return -1;
+    int v = 0;
+    for (size_t i = 1; i < len; i++) {
+        if (!isdigit((unsigned char)name[i])) return -1;
+        v = v * 10 + (name[i] - '0');
+    }
+    return v < TOTAL_PARAMS ? v : -1;
+}
+
+static int resolve_name(const char *name, size_t len, void *ctx) {
+    const ResolveCtx *rc = (const ResolveCtx *)ctx;
+    int s = slot_name(name, len);
+    if (s >= 0) return rc->slot_node[s] >= 0 ? VAR_NODE(rc->slot_node[s]) : VAR_SLOT(s);
+    int n = find_def(name, len);
+    if (n >= 0) return VAR_NODE(n);
+    if (memchr(name, '.', len) == NULL || len >= SK_PATH_MAX_LEN) return -1;
+    for (int k = 0; k < input_count; k++) {
+        if (strlen(input_paths[k]) == len && memcmp(input_paths[k], name, len) == 0) return VAR_INPUT(k);
+    }
+    if (input_count >= DERIVED_MAX_INPUTS) return -1;
+    memcpy(input_paths[input_count], name, len);
+    input_paths[input_count][len] = '\0';
+    return VAR_INPUT(input_count++);
+}
+
+static bool valid_name(const char *name) {
+    if (!isalpha((unsigned char)name[0]) && name[0] != '_') return false;
+    for (const char *p = name; *p; p++) {
+        if (!isalnum((unsigned char)*p) && *p != '_') return false;
+    }
+    if (slot_name(name, strlen(name)) >= 0) return false;
+    return strcmp(name, "min") && strcmp(name, "max") && strcmp(name, "abs") && strcmp(name, "rate");
+}
+
+static void set_error(int n, const char *msg) {
+    status[n].ok = false;
+    snprintf(status[n].error, sizeof(status[n].error), "%s", msg);
+}
+
+// Compile every definition into `staging` and sort it
+static void build_graph() {
+    memset(&staging, 0, sizeof(staging));
+    input_count = 0;
+    memset(input_paths, 0, sizeof(input_paths));
+
+    // Gauge slots that show a derived signal
+    int8_t slot_node[TOTAL_PARAMS];
+    const size_t prefix_len = strlen(DERIVED_SLOT_PREFIX);
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        slot_node[i] = -1;
+        String path = get_signalk_path_by_index(i);
+        if (!path.startsWith(DERIVED_SLOT_PREFIX)) continue;
+        String name = path.substring(prefix_len);
+        int n = find_def(name.c_str(), name.length());
+        if (n < 0) {
+            Serial.printf("[derived] slot %d shows unknown signal '%s'\n", i, name.c_str());
+            continue;
+        }
+        slot_node[i] = (int8_t)n;
+        staging.nodes[n].out_slots |= 1u << i;
+    }
+
+    uint32_t compiled = 0;
+    ResolveCtx rc = { slot_node };
+    for (int n = 0; n < DERIVED_MAX; n++) {
+        memset(&status[n], 0, sizeof(status[n]));
+        status[n].out_slots = staging.nodes[n].out_slots;
+        if (defs[n].name[0] == '\0') continue;
+        if (!valid_name(defs[n].name)) {
+            set_error(n, "bad name");
+        } else if (find_def(defs[n].name, strlen(defs[n].name)) != n) {
+            set_error(n, "duplicate name");
+        } else if (dexpr_compile(defs[n].expr, &staging.nodes[n].prog, resolve_name, &rc,
+                                 status[n].error, sizeof(status[n].error))) {
+            compiled |= 1u << n;
+        }
+    }
+
+    // Kahn's order over node -> node dependencies
+    uint32_t placed = 0;
+    for (bool progress = true; progress;) {
+        progress = false;
+        for (int n = 0; n < DERIVED_MAX; n++) {
+            uint32_t bit = 1u << n;
+            if (!(compiled & bit) || (placed & bit)) continue;
+            DerivedNode &node = staging.nodes[n];
+            uint32_t needs = node.prog.deps >> VAR_NODE(0);
+            if ((needs & ~placed) != 0) continue;
+            node.feeds = node.prog.deps & SLOT_AND_INPUT_VARS;
+            for (uint32_t m = needs; m; m &= m - 1) node.feeds |= staging.nodes[__builtin_ctz(m)].feeds;
+            staging.order[staging.count++] = (uint8_t)n;
+            staging.triggers |= node.prog.deps & SLOT_AND_INPUT_VARS;
+            staging.outputs |= node.out_slots;
+            status[n].ok = true;
+            placed |= bit;
+            progress = true;
+        }
+    }
+    for (int n = 0; n < DERIVED_MAX; n++) {
+        uint32_t bit = 1u << n;
+        if (!(compiled & bit) || (placed & bit)) continue;
+        uint32_t needs = staging.nodes[n].prog.deps >> VAR_NODE(0);
+        set_error(n, (needs & ~compiled) ? "uses a signal with an error" : "circular reference");
+    }
+}
+
+// Evaluate the nodes reading `updated` (and the nodes reading them in turn),
+// then store the results in the gauge slots that show them. A result is
+// stored even when it did not change: the store counts it as unchanged and
+// skips the redraw, but the slot's receive time moves on, so a derived gauge
+// stays live exactly as long as its inputs keep arriving.
+static void run_pass(uint32_t updated, uint32_t now_ms, int64_t sk_time_ms) {
+    struct Result { uint32_t slots; float value; };
+    Result out[DERIVED_MAX];
+    int nout = 0;
+    uint32_t t0 = micros();
+    portENTER_CRITICAL(&lock);
+    stats.triggers++;
+    for (uint8_t i = 0; i < graph.count; i++) {
+        uint8_t n = graph.order[i];
+        DerivedNode &node = graph.nodes[n];
+        if (!(node.prog.deps & updated)) continue;
+        float v = dexpr_eval(&node.prog, vars, node.rates, now_ms);
+        node_evals[n]++;
+        stats.evals++;
+        vars[VAR_NODE(n)] = v;
+        updated |= 1u << VAR_NODE(n);
+        if (node.out_slots && isfinite(v)) out[nout++] = { node.out_slots, v };
+    }
+    stats.publishes += nout;
+    portEXIT_CRITICAL(&lock);
+
+    for (int r = 0; r < nout; r++) {
+        for (uint32_t m = out[r].slots; m; m &= m - 1) {
+            set_sensor_sample(__builtin_ctz(m), out[r].value, sk_time_ms, "derived", 7, 0);
+        }
+    }
+    uint32_t us = micros() - t0;
+    if (us > stats.pass_max_us) stats.pass_max_us = us;
+}
+
+static void install_graph() {
+    float seed[TOTAL_PARAMS];
+    for (int i = 0; i < TOTAL_PARAMS; i++) seed[i] = get_sensor_value(i);
+    portENTER_CRITICAL(&lock);
+    graph = staging;
+    for (int v = 0; v < DEXPR_MAX_VARS; v++) vars[v] = v < TOTAL_PARAMS ? seed[v] : NAN;
+    memset(node_evals, 0, sizeof(node_evals));
+    __atomic_store_n(&trigger_mask, graph.triggers, __ATOMIC_RELEASE);
+    portEXIT_CRITICAL(&lock);
+    // Show what can be computed from the current slot values right away
+    run_pass(~0u, millis(), 0);
+}
+
+void derived_init() {
+    Preferences prefs;
+    bool open = prefs.begin("derived", true);
+    for (int n = 0; n < DERIVED_MAX; n++) {
+        memset(&defs[n], 0, sizeof(defs[n]));
+        if (!open) continue;
+        char key[8];
+        snprintf(key, sizeof(key), "d%d", n);
+        if (prefs.getBytesLength(key) == sizeof(DerivedDef)) prefs.getBytes(key, &defs[n], sizeof(DerivedDef));
+        defs[n].name[DERIVED_NAME_MAX - 1] = '\0';
+        defs[n].expr[DERIVED_EXPR_MAX - 1] = '\0';
+    }
+    if (open) prefs.end();
+    build_graph();
+    install_graph();
+    Serial.printf("[derived] %u signals, %d inputs, output slots 0x%03lx\n", (unsigned)graph.count, input_count,
+                  (unsigned long)graph.outputs);
+}
+
+void derived_set_defs(const DerivedDef *in) {
+    Preferences prefs;
+    bool open = prefs.begin("derived", false);
+    for (int n = 0; n < DERIVED_MAX; n++) {
+        char key[8];
+        snprintf(key, sizeof(key), "d%d", n);
+        if (open) {
+            if (in[n].name[0]) prefs.putBytes(key, &in[n], sizeof(DerivedDef));
+            else prefs.remove(key);
+        }
+    }
+    if (open) prefs.end();
+    derived_init();
+}
+
+void derived_get_def(int n, DerivedDef *out) {
+    if (n < 0 || n >= DERIVED_MAX) return;
+    *out = defs[n];
+}
+
+void derived_get_status(int n, DerivedStatus *out) {
+    if (n < 0 || n >= DERIVED_MAX) return;
+    *out = status[n];
+    portENTER_CRITICAL(&lock);
+    out->value = vars[VAR_NODE(n)];
+    out->evals = node_evals[n];
+    portEXIT_CRITICAL(&lock);
+}
+
+void derived_get_stats(DerivedStats *out) {
+    portENTER_CRITICAL(&lock);
+    *out = stats;
+    portEXIT_CRITICAL(&lock);
+}
+
+int derived_input_count() {
+    return input_count;
+}
+
+const char *derived_input_path(int k) {
+    return (k >= 0 && k < input_count) ? input_paths[k] : "";
+}
+
+uint32_t derived_output_slots() {
+    return graph.outputs;
+}
+
+uint32_t derived_demand_mask(uint32_t slot_mask) {
+    uint32_t mask = 0;
+    portENTER_CRITICAL(&lock);
+    for (uint8_t i = 0; i < graph.count; i++) {
+        const DerivedNode &node = graph.nodes[graph.order[i]];
+        if (node.out_slots & slot_mask) mask |= node.feeds;
+    }
+    portEXIT_CRITICAL(&lock);
+    return mask;
+}
+
+static void note_var(int var, float value, uint32_t now_ms, int64_t sk_time_ms) {
+    uint32_t bit = 1u << var;
+    if (!(__atomic_load_n(&trigger_mask, __ATOMIC_ACQUIRE) & bit)) return;
+    portENTER_CRITICAL(&lock);
+    vars[var] = value;
+    portEXIT_CRITICAL(&lock);
+    run_pass(bit, now_ms, sk_time_ms);
+}
+
+void derived_note_slot(int slot, float value, uint32_t now_ms) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) return;
+    note_var(VAR_SLOT(slot), value, now_ms, 0);
+}
+
+void derived_note_input(int k, float value, int64_t sk_time_ms, uint32_t now_ms) {
+    if (k < 0 || k >= DERIVED_MAX_INPUTS) return;
+    note_var(VAR_INPUT(k), value, now_ms, sk_time_ms);
+}
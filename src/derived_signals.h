@@ -0,0 +1,82 @@
+#ifndef DERIVED_SIGNALS_H
+#define DERIVED_SIGNALS_H
+
+#include <Arduino.h>
+#include "signalk_config.h"   // TOTAL_PARAMS
+
+// User-defined signals computed from other values, e.g.
+//
+//   rpm       propulsion.main.revolutions * 60 / 6
+//   coolant_c s1 - 273.15
+//   burn      -rate(s3) * 3600
+//   delta_t   s5 - s4
+//
+// Names in an expression are gauge slots (s0..s9), other derived signals by
+// name, or Signal K paths, which are subscribed as extra inputs. A gauge
+// shows a derived signal by using "derived:<name>" as its Signal K path.
+//
+// Expressions are compiled to bytecode (derived_expr.h) when loaded and
+// sorted so each signal comes after the ones it reads. A slot or input
+// update evaluates only the signals that depend on it, in that order, and
+// stores the results in the gauge slots that show them. Unchanged inputs
+// count as updates too, so rate() decays and derived gauges do not go stale
+// while their inputs are steady.
+
+#define DERIVED_MAX 8
+#define DERIVED_MAX_INPUTS 8          // distinct Signal K paths read by expressions
+#define DERIVED_NAME_MAX 16
+#define DERIVED_EXPR_MAX 96
+#define DERIVED_SLOT_PREFIX "derived:"
+
+static_assert(TOTAL_PARAMS + DERIVED_MAX_INPUTS + DERIVED_MAX <= 32, "variables and inputs share 32-bit masks");
+
+struct DerivedDef {
+    char name[DERIVED_NAME_MAX];
+    char expr[DERIVED_EXPR_MAX];
+};
+
+struct DerivedStatus {
+    bool ok;                  // compiled and part of the graph
+    char error[48];
+    float value;
+    uint32_t evals;
+    uint32_t out_slots;       // gauge slots showing it
+};
+
+struct DerivedStats {
+    uint32_t triggers;        // slot/input updates that reached the graph
+    uint32_t evals;           // expression evaluations
+    uint32_t publishes;       // results stored in gauge slots
+    uint32_t pass_max_us;     // slowest update pass
+};
+
+// Load the definitions from NVS and (re)build the graph against the current
+// gauge paths. Call again after gauge paths change; then rebuild the Signal K
+// path index so new inputs are subscribed.
+void derived_init();
+
+// Replace all definitions (DERIVED_MAX entries, empty name = unused), save
+// them and rebuild the graph.
+void derived_set_defs(const DerivedDef *defs);
+
+void derived_get_def(int n, DerivedDef *out);
+void derived_get_status(int n, DerivedStatus *out);
+void derived_get_stats(DerivedStats *out);
+
+// Signal K paths the expressions read; input k arrives as path index slot
+// TOTAL_PARAMS + k.
+int derived_input_count();
+const char *derived_input_path(int k);
+
+// Gauge slots whose value comes from a derived signal
+uint32_t derived_output_slots();
+
+// Slots and inputs (bit TOTAL_PARAMS + k) that feed the derived signals
+// shown in `slot_mask`, so their subscriptions can follow the gauges' demand.
+uint32_t derived_demand_mask(uint32_t slot_mask);
+
+// Writer side: a gauge slot was written / an input arrived.
+void derived_note_slot(int slot, float value, uint32_t now_ms);
+void derived_note_input(int k, float value, int64_t sk_time_ms, uint32_t now_ms);
+
+#endif // DERIVED_SIGNALS_H
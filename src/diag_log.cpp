@@ -0,0 +1,151 @@
+#include "diag_log.h"
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdarg.h>
+
+static_assert((DIAG_RING_RECORDS & (DIAG_RING_RECORDS - 1)) == 0,
+              "DIAG_RING_RECORDS must be a power of two");
+
+struct DiagRecord {
+    volatile uint32_t seq;   // sequence + 1 once committed, 0 while being written
+    uint32_t ms;
+    uint8_t level;
+    char tag[11];
+    char msg[DIAG_MSG_MAX];
+};
+
+static DiagRecord *ring = NULL;
+static volatile uint32_t ring_head = 0;     // next sequence to hand out
+static uint32_t drain_tail = 0;             // next sequence the drain task prints
+static volatile uint32_t stat_written = 0;
+static volatile uint32_t stat_suppressed = 0;
+static volatile uint32_t stat_overwritten = 0;
+static TaskHandle_t drain_task_handle = NULL;
+
+static const char LEVEL_CHARS[] = "-EWID";
+
+// Copy record `seq` out of the ring. Returns 1 on success, 0 if it is still
+// being written, -1 if it has already been overwritten.
+static int read_record(uint32_t seq, DiagRecord *out) {
+    const DiagRecord &r = ring[seq & (DIAG_RING_RECORDS - 1)];
+    uint32_t s1 = __atomic_load_n(&r.seq, __ATOMIC_ACQUIRE);
+    if (s1 == 0) return 0;
+    if (s1 != seq + 1) return -1;
+    out->ms = r.ms;
+    out->level = r.level;
+    memcpy(out->tag, r.tag, sizeof(out->tag));
+    memcpy(out->msg, r.msg, sizeof(out->msg));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&r.seq, __ATOMIC_RELAXED) != s1) return -1;
+    out->tag[sizeof(out->tag) - 1] = '\0';
+    out->msg[sizeof(out->msg) - 1] = '\0';
+    return 1;
+}
+
+static int format_record(const DiagRecord &r, char *buf, size_t cap) {
+    char lvl = r.level < sizeof(LEVEL_CHARS) - 1 ? LEVEL_CHARS[r.level] : '?';
+    int n = snprintf(buf, cap, "[%lu] %c/%s: %s\n", (unsigned long)r.ms, lvl, r.tag, r.msg);
+    return n < (int)cap ? n : (int)cap - 1;
+}
+
+static void diag_drain_task(void *parameter) {
+    (void)parameter;
+    char line[DIAG_MSG_MAX + 40];
+    for (;;) {
+        uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+        while (drain_tail != head) {
+            if (head - drain_tail > DIAG_RING_RECORDS) {
+                __atomic_fetch_add(&stat_overwritten, head - drain_tail - DIAG_RING_RECORDS, __ATOMIC_RELAXED);
+                drain_tail = head - DIAG_RING_RECORDS;
+            }
+            DiagRecord r;
+            int rc = read_record(drain_tail, &r);
+            if (rc == 0) break;  // writer still filling it in; retry next pass
+            if (rc > 0) {
+                int n = format_record(r, line, sizeof(line));
+                Serial.write((const uint8_t *)line, n);
+            } else {
+                __atomic_fetch_add(&stat_overwritten, 1, __ATOMIC_RELAXED);
+            }
+            drain_tail++;
+        }
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+}
+
+extern "C" void diag_log_init(void) {
+    if (ring != NULL) return;
+    ring = (DiagRecord *)heap_caps_calloc(DIAG_RING_RECORDS, sizeof(DiagRecord), MALLOC_CAP_SPIRAM);
+    if (ring == NULL) {
+        Serial.println("[diag] PSRAM log ring allocation failed, logging direct to Serial");
+        return;
+    }
+    xTaskCreatePinnedToCore(diag_drain_task, "diag_log", 3072, NULL, 1, &drain_task_handle, 0);
+}
+
+extern "C" void diag_log_write(int level, const char *tag, diag_ratelimit_t *rl, const char *fmt, ...) {
+    uint32_t now = millis();
+    uint32_t repeats = 0;
+    if (rl) {
+        if (rl->last_ms != 0 && now - rl->last_ms < DIAG_RATE_LIMIT_MS) {
+            rl->suppressed++;
+            __atomic_fetch_add(&stat_suppressed, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        rl->last_ms = now ? now : 1;
+        repeats = rl->suppressed;
+        rl->suppressed = 0;
+    }
+
+    char msg[DIAG_MSG_MAX];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if (n >= (int)sizeof(msg)) n = sizeof(msg) - 1;
+    if (repeats) snprintf(msg + n, sizeof(msg) - n, " (+%lu suppressed)", (unsigned long)repeats);
+
+    if (ring == NULL) {
+        Serial.printf("[%lu] %c/%s: %s\n", (unsigned long)now,
+                      level >= 0 && level < (int)sizeof(LEVEL_CHARS) - 1 ? LEVEL_CHARS[level] : '?', tag, msg);
+        return;
+    }
+
+    uint32_t seq = __atomic_fetch_add(&ring_head, 1, __ATOMIC_RELAXED);
+    DiagRecord &r = ring[seq & (DIAG_RING_RECORDS - 1)];
+    __atomic_store_n(&r.seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    r.ms = now;
+    r.level = (uint8_t)level;
+    strncpy(r.tag, tag, sizeof(r.tag) - 1);
+    r.tag[sizeof(r.tag) - 1] = '\0';
+    memcpy(r.msg, msg, sizeof(r.msg));
+    __atomic_store_n(&r.seq, seq + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&stat_written, 1, __ATOMIC_RELAXED);
+}
+
+extern "C" void diag_log_get_stats(diag_log_stats_t *out) {
+    out->written = stat_written;
+    out->suppressed = stat_suppressed;
+    out->overwritten = stat_overwritten;
+    out->head = ring_head;
+}
+
+extern "C" uint32_t diag_log_read(uint32_t since, uint32_t until, diag_log_emit_fn emit, void *ctx) {
+    uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+    if ((int32_t)(until - head) < 0) head = until;
+    if (ring == NULL) return head;
+    uint32_t seq = since;
+    if (head - seq > DIAG_RING_RECORDS) seq = head - DIAG_RING_RECORDS;
+    char line[DIAG_MSG_MAX + 40];
+    for (; seq != head; seq++) {
+        DiagRecord r;
+        if (read_record(seq, &r) <= 0) continue;
+        int n = format_record(r, line, sizeof(line));
+        emit(line, (size_t)n, ctx);
+    }
+    return head;
+}
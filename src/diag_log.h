@@ -0,0 +1,116 @@
+#ifndef DIAG_LOG_H
+#define DIAG_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Diagnostics logging for hot paths.
+//
+// DIAG_E/W/I/D format into a fixed-record ring buffer in PSRAM instead of
+// writing to Serial; a low-priority task drains the ring to Serial and the
+// web UI reads recent records at /log. Producers never block: each record
+// is claimed with one atomic increment, and a slow drain just loses the
+// oldest records (counted in `overwritten`).
+//
+// Levels are checked at compile time. A file selects its module by defining
+// DIAG_TAG and DIAG_MODULE_LEVEL before including this header, e.g.
+//
+//     #define DIAG_TAG "SignalK"
+//     #define DIAG_MODULE_LEVEL DIAG_LEVEL_SIGNALK
+//     #include "diag_log.h"
+//
+// Calls above the module level, or above the build-wide DIAG_LOG_LEVEL, are
+// removed by the compiler (arguments are not evaluated). Each call site is
+// rate limited to one record per DIAG_RATE_LIMIT_MS; the number of
+// suppressed repeats is appended to the next record that gets through.
+//
+// Callable from C and C++. Safe from any task; not from ISRs.
+
+#define DIAG_LEVEL_NONE  0
+#define DIAG_LEVEL_ERROR 1
+#define DIAG_LEVEL_WARN  2
+#define DIAG_LEVEL_INFO  3
+#define DIAG_LEVEL_DEBUG 4
+
+// Build-wide cap. Release builds set -D DIAG_LOG_LEVEL=2 (warnings/errors).
+#ifndef DIAG_LOG_LEVEL
+#define DIAG_LOG_LEVEL DIAG_LEVEL_INFO
+#endif
+
+// Per-module levels (override with -D DIAG_LEVEL_<MODULE>=n)
+#ifndef DIAG_LEVEL_SIGNALK
+#define DIAG_LEVEL_SIGNALK DIAG_LOG_LEVEL
+#endif
+#ifndef DIAG_LEVEL_UI
+#define DIAG_LEVEL_UI DIAG_LEVEL_WARN
+#endif
+#ifndef DIAG_LEVEL_MAIN
+#define DIAG_LEVEL_MAIN DIAG_LOG_LEVEL
+#endif
+
+#ifndef DIAG_TAG
+#define DIAG_TAG "main"
+#endif
+#ifndef DIAG_MODULE_LEVEL
+#define DIAG_MODULE_LEVEL DIAG_LOG_LEVEL
+#endif
+
+#ifndef DIAG_RATE_LIMIT_MS
+#define DIAG_RATE_LIMIT_MS 1000
+#endif
+#ifndef DIAG_RING_RECORDS
+#define DIAG_RING_RECORDS 256       // power of two
+#endif
+#define DIAG_MSG_MAX 112
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per call site rate-limit state (one static instance per DIAG_x use)
+typedef struct {
+    uint32_t last_ms;
+    uint32_t suppressed;
+} diag_ratelimit_t;
+
+typedef struct {
+    uint32_t written;       // records committed to the ring
+    uint32_t suppressed;    // calls dropped by the per-site rate limit
+    uint32_t overwritten;   // records lost before the drain task reached them
+    uint32_t head;          // sequence number of the next record
+} diag_log_stats_t;
+
+// Allocate the ring (PSRAM when available) and start the drain task.
+// Records logged before this go straight to Serial.
+void diag_log_init(void);
+
+void diag_log_write(int level, const char *tag, diag_ratelimit_t *rl, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+void diag_log_get_stats(diag_log_stats_t *out);
+
+// Format committed records with since <= sequence < until as text lines,
+// oldest first (`until` is capped at the current head, so pass the head
+// from diag_log_get_stats() to cover exactly what was committed then).
+// `emit` is called once per line. Returns the sequence number to pass as
+// `since` next time.
+typedef void (*diag_log_emit_fn)(const char *line, size_t len, void *ctx);
+uint32_t diag_log_read(uint32_t since, uint32_t until, diag_log_emit_fn emit, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define DIAG_LOG_AT(lvl, fmt, ...) do { \
+    if ((lvl) <= DIAG_MODULE_LEVEL && (lvl) <= DIAG_LOG_LEVEL) { \
+        static diag_ratelimit_t _diag_rl = {0, 0}; \
+        diag_log_write((lvl), DIAG_TAG, &_diag_rl, fmt, ##__VA_ARGS__); \
+    } \
+} while (0)
+
+#define DIAG_E(fmt, ...) DIAG_LOG_AT(DIAG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define DIAG_W(fmt, ...) DIAG_LOG_AT(DIAG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define DIAG_I(fmt, ...) DIAG_LOG_AT(DIAG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define DIAG_D(fmt, ...) DIAG_LOG_AT(DIAG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+
+#endif // DIAG_LOG_H
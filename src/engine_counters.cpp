@@ -0,0 +1,174 @@
+#include "engine_counters.h"
+#include "sensor_store.h"
+#include "sensor_staleness.h"
+#include "signalk_config.h"   // TOTAL_PARAMS
+#include <Preferences.h>
+#include <esp_rom_crc.h>
+
+#define JOURNAL_MAGIC 0x43544E43u   // "CNTC"
+#define TICK_MS 1000
+#define MAX_TICK_GAP_MS 10000       // longer loop stalls count as this
+
+struct JournalRecord {
+    uint32_t magic;
+    uint32_t seq;
+    double totals[COUNTER_MAX];     // seconds (hours counters) or units
+    uint32_t reserved;
+    uint32_t crc;                   // over everything before it
+};
+
+static CounterConfig configs[COUNTER_MAX];
+static double totals[COUNTER_MAX];
+static bool accumulating[COUNTER_MAX];
+static double checkpointed[COUNTER_MAX];   // totals at the last checkpoint
+static uint8_t next_key = 0;
+static uint32_t last_tick_ms = 0;
+static bool checkpoint_requested = false;  // a counter stopped or was set
+static CounterStats stats = {};
+
+static uint32_t record_crc(const JournalRecord &r) {
+    return esp_rom_crc32_le(0, (const uint8_t *)&r, offsetof(JournalRecord, crc));
+}
+
+static void journal_key(int k, char *key, size_t len) {
+    snprintf(key, len, "j%d", k);
+}
+
+static void restore_journal(Preferences &prefs) {
+    int best = -1;
+    JournalRecord rec, newest = {};
+    for (int k = 0; k < COUNTER_JOURNAL_KEYS; k++) {
+        char key[8];
+        journal_key(k, key, sizeof(key));
+        if (prefs.getBytesLength(key) != sizeof(rec)) continue;
+        prefs.getBytes(key, &rec, sizeof(rec));
+        if (rec.magic != JOURNAL_MAGIC || rec.crc != record_crc(rec)) continue;
+        if (best < 0 || (int32_t)(rec.seq - newest.seq) > 0) {
+            best = k;
+            newest = rec;
+        }
+    }
+    if (best < 0) return;
+    for (int n = 0; n < COUNTER_MAX; n++) totals[n] = newest.totals[n];
+    next_key = (uint8_t)((best + 1) % COUNTER_JOURNAL_KEYS);
+    stats.seq = newest.seq;
+    stats.restored = true;
+}
+
+void counters_init() {
+    Preferences prefs;
+    bool open = prefs.begin("counters", true);
+    memset(configs, 0, sizeof(configs));
+    memset(totals, 0, sizeof(totals));
+    if (open) {
+        if (prefs.getBytesLength("cfg") == sizeof(configs)) prefs.getBytes("cfg", configs, sizeof(configs));
+        restore_journal(prefs);
+        prefs.end();
+    }
+    for (int n = 0; n < COUNTER_MAX; n++) {
+        configs[n].name[COUNTER_NAME_MAX - 1] = '\0';
+        checkpointed[n] = totals[n];
+        accumulating[n] = false;
+    }
+    last_tick_ms = millis();
+    Serial.printf("[counters] %s checkpoint %lu\n", stats.restored ? "restored" : "no",
+                  (unsigned long)stats.seq);
+}
+
+static void write_checkpoint(uint32_t now_ms) {
+    JournalRecord rec = {};
+    rec.magic = JOURNAL_MAGIC;
+    rec.seq = stats.seq + 1;
+    for (int n = 0; n < COUNTER_MAX; n++) rec.totals[n] = totals[n];
+    rec.crc = record_crc(rec);
+
+    uint32_t t0 = millis();
+    Preferences prefs;
+    size_t written = 0;
+    if (prefs.begin("counters", false)) {
+        char key[8];
+        journal_key(next_key, key, sizeof(key));
+        written = prefs.putBytes(key, &rec, sizeof(rec));
+        prefs.end();
+    }
+    uint32_t took = millis() - t0;
+    if (took > stats.write_max_ms) stats.write_max_ms = took;
+    stats.last_write_ms = now_ms;
+    if (written != sizeof(rec)) {
+        // Retried after the minimum spacing
+        stats.write_errors++;
+        return;
+    }
+    stats.seq = rec.seq;
+    stats.checkpoints++;
+    next_key = (uint8_t)((next_key + 1) % COUNTER_JOURNAL_KEYS);
+    for (int n = 0; n < COUNTER_MAX; n++) checkpointed[n] = totals[n];
+    checkpoint_requested = false;
+}
+
+void counters_service(uint32_t now_ms) {
+    uint32_t dt_ms = now_ms - last_tick_ms;
+    if (dt_ms < TICK_MS) return;
+    last_tick_ms = now_ms;
+    if (dt_ms > MAX_TICK_GAP_MS) dt_ms = MAX_TICK_GAP_MS;
+    double dt_s = dt_ms / 1000.0;
+
+    bool dirty = false;
+    for (int n = 0; n < COUNTER_MAX; n++) {
+        const CounterConfig &c = configs[n];
+        bool on = false;
+        if (c.kind != COUNTER_OFF && c.slot >= 0 && c.slot < TOTAL_PARAMS &&
+            get_sensor_rx_ms(c.slot) != 0 && !sensor_is_stale(c.slot)) {
+            float v = get_sensor_value(c.slot);
+            if (!isnan(v)) {
+                if (c.kind == COUNTER_HOURS) {
+                    on = v > c.threshold;
+                    if (on) totals[n] += dt_s;
+                } else {
+                    on = v != 0;
+                    totals[n] += (double)v * c.scale * dt_s;
+                }
+            }
+        }
+        // Engine stopped (or data lost): save what this run added
+        if (accumulating[n] && !on) checkpoint_requested = true;
+        accumulating[n] = on;
+        if (totals[n] != checkpointed[n]) dirty = true;
+    }
+    if (!dirty && !checkpoint_requested) return;
+
+    uint32_t since = now_ms - stats.last_write_ms;
+    bool due = stats.last_write_ms == 0 || since >= COUNTER_CHECKPOINT_MS;
+    if (checkpoint_requested && since >= COUNTER_MIN_SPACING_MS) due = true;
+    if (due) write_checkpoint(now_ms);
+}
+
+void counters_get_config(int n, CounterConfig *out) {
+    if (n < 0 || n >= COUNTER_MAX) return;
+    *out = configs[n];
+}
+
+void counters_set_config(const CounterConfig *cfg) {
+    memcpy(configs, cfg, sizeof(configs));
+    for (int n = 0; n < COUNTER_MAX; n++) configs[n].name[COUNTER_NAME_MAX - 1] = '\0';
+    Preferences prefs;
+    if (prefs.begin("counters", false)) {
+        prefs.putBytes("cfg", configs, sizeof(configs));
+        prefs.end();
+    }
+}
+
+double counters_get_value(int n) {
+    if (n < 0 || n >= COUNTER_MAX) return 0;
+    return configs[n].kind == COUNTER_HOURS ? totals[n] / 3600.0 : totals[n];
+}
+
+void counters_set_value(int n, double value) {
+    if (n < 0 || n >= COUNTER_MAX) return;
+    totals[n] = configs[n].kind == COUNTER_HOURS ? value * 3600.0 : value;
+    write_checkpoint(millis());
+}
+
+void counters_get_stats(CounterStats *out) {
+    *out = stats;
+}
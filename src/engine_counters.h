@@ -0,0 +1,67 @@
+#ifndef ENGINE_COUNTERS_H
+#define ENGINE_COUNTERS_H
+
+#include <Arduino.h>
+
+// Persistent accumulators: engine hours (time a slot is above a threshold)
+// and totals (a slot integrated over time, e.g. fuel rate -> fuel used).
+//
+// Totals are integrated in RAM once a second from the live slot values;
+// stale or never-received slots do not count. They are checkpointed to NVS
+// through a journal of COUNTER_JOURNAL_KEYS rotating keys (namespace
+// "counters", j0..j7), each record carrying a sequence number and CRC. Boot
+// restores the newest valid record, so a torn write costs at most one
+// checkpoint interval.
+//
+// Write rate: every COUNTER_CHECKPOINT_MS while a total is changing, plus
+// when a counter stops accumulating (engine off), never more than once per
+// COUNTER_MIN_SPACING_MS, and nothing while idle. NVS spreads the records
+// over its pages, so each page is erased only about once per 60 h of engine
+// running.
+
+#define COUNTER_MAX 4
+#define COUNTER_NAME_MAX 16
+#define COUNTER_JOURNAL_KEYS 8
+#define COUNTER_CHECKPOINT_MS (5UL * 60 * 1000)
+#define COUNTER_MIN_SPACING_MS (60UL * 1000)
+
+enum CounterKind : uint8_t {
+    COUNTER_OFF = 0,
+    COUNTER_HOURS,       // seconds with value > threshold, shown in hours
+    COUNTER_TOTAL,       // integral of value * scale over seconds
+};
+
+struct CounterConfig {
+    char name[COUNTER_NAME_MAX];
+    uint8_t kind;
+    int8_t slot;
+    float threshold;     // COUNTER_HOURS
+    float scale;         // COUNTER_TOTAL, e.g. 1000 for m3/s -> litres
+};
+
+struct CounterStats {
+    uint32_t seq;              // sequence number of the last checkpoint
+    uint32_t checkpoints;      // written since boot
+    uint32_t write_errors;
+    uint32_t last_write_ms;    // millis() of the last checkpoint, 0 = none
+    uint32_t write_max_ms;
+    bool restored;             // a journal record was found at boot
+};
+
+// Load the configuration and restore the newest checkpoint.
+void counters_init();
+
+// Integrate and checkpoint when due. Call from the UI loop.
+void counters_service(uint32_t now_ms);
+
+void counters_get_config(int n, CounterConfig *out);
+void counters_set_config(const CounterConfig *cfg);   // COUNTER_MAX entries, persists
+
+// Current total: hours for COUNTER_HOURS, scaled units for COUNTER_TOTAL
+double counters_get_value(int n);
+// Set a total (e.g. to match the engine's own hour meter) and checkpoint now
+void counters_set_value(int n, double value);
+
+void counters_get_stats(CounterStats *out);
+
+#endif // ENGINE_COUNTERS_H
@@ -0,0 +1,280 @@
+#include "engine_log.h"
+#include "engine_log_format.h"
+#define DIAG_TAG "EngLog"
+#define DIAG_MODULE_LEVEL DIAG_LEVEL_MAIN
+#include "diag_log.h"
+#include <FS.h>
+#include <SD_MMC.h>
+#include <Preferences.h>
+#include <esp_heap_caps.h>
+#include <esp_random.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <time.h>
+
+static const uint32_t QUEUE_CELLS = 1024;                  // power of two
+static const uint32_t FLUSH_INTERVAL_MS = 30000;           // seal a partial block after this
+static const uint32_t POLL_MS = 100;
+static const uint32_t DAY_MS = 86400000UL;
+static const uint32_t DATED_KEY = 0x80000000u;             // day key counts calendar days
+static const char *LOG_DIR = "/logs";
+
+static_assert((QUEUE_CELLS & (QUEUE_CELLS - 1)) == 0, "QUEUE_CELLS must be a power of two");
+
+// Bounded multi-producer queue (Vyukov): a cell is free for position p when
+// its seq == p and holds a record for the reader when seq == p + 1.
+struct LogCell {
+    uint32_t seq;
+    uint32_t t_ms;
+    float value;
+    uint8_t slot;
+};
+
+static LogCell *cells = NULL;                 // PSRAM
+static uint32_t enqueue_pos = 0;              // producers, CAS
+static uint32_t dequeue_pos = 0;              // writer task only
+
+static volatile bool enabled = false;
+static int32_t epoch_offset_s = 0;
+static TaskHandle_t writer_task_handle = NULL;
+static uint32_t queued = 0, dropped = 0;      // producers, atomic
+
+// Writer task state
+static uint8_t *block = NULL;                 // PSRAM, ELOG_BLOCK_SIZE
+static uint16_t block_count = 0;
+static uint32_t block_base_ms = 0;
+static uint32_t block_opened_ms = 0;
+static uint32_t block_seq = 0;
+static uint32_t boot_id = 0;
+static File log_file;
+static uint32_t file_key = 0;
+static bool file_open = false;
+
+static EngineLogStats stats = {};
+
+static bool queue_push(int slot, float value, uint32_t t_ms) {
+    uint32_t pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+    LogCell *c;
+    for (;;) {
+        c = &cells[pos & (QUEUE_CELLS - 1)];
+        uint32_t seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&enqueue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (diff < 0) {
+            return false;   // full
+        } else {
+            pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    c->t_ms = t_ms;
+    c->value = value;
+    c->slot = (uint8_t)slot;
+    __atomic_store_n(&c->seq, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool queue_pop(LogCell *out) {
+    LogCell *c = &cells[dequeue_pos & (QUEUE_CELLS - 1)];
+    uint32_t seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+    if (seq != dequeue_pos + 1) return false;
+    *out = *c;
+    __atomic_store_n(&c->seq, dequeue_pos + QUEUE_CELLS, __ATOMIC_RELEASE);
+    dequeue_pos++;
+    return true;
+}
+
+void engine_log_note(int slot, float value, uint32_t now_ms, int64_t sk_time_ms) {
+    // Anything after 2001 is a real clock rather than a sender's uptime
+    if (sk_time_ms > 1000000000000LL) {
+        int32_t off = (int32_t)(sk_time_ms / 1000 - (int64_t)(now_ms / 1000));
+        __atomic_store_n(&epoch_offset_s, off, __ATOMIC_RELAXED);
+    }
+    if (!enabled || cells == NULL || slot < 0 || slot >= 32) return;
+    if (queue_push(slot, value, now_ms)) {
+        __atomic_fetch_add(&queued, 1, __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+int32_t engine_log_epoch_offset_s() {
+    return __atomic_load_n(&epoch_offset_s, __ATOMIC_RELAXED);
+}
+
+// Calendar day (with DATED_KEY set) once the clock is known, else uptime day
+static uint32_t day_key(uint32_t t_ms) {
+    int32_t off = engine_log_epoch_offset_s();
+    if (off == 0) return t_ms / DAY_MS;
+    return DATED_KEY | (uint32_t)(((int64_t)(t_ms / 1000) + off) / 86400);
+}
+
+static void close_file() {
+    if (!file_open) return;
+    log_file.close();
+    file_open = false;
+    stats.running = false;
+}
+
+static bool open_file(uint32_t key) {
+    close_file();
+    if (!SD_MMC.exists(LOG_DIR)) SD_MMC.mkdir(LOG_DIR);
+    char path[32];
+    if (key & DATED_KEY) {
+        time_t t = (time_t)(key & ~DATED_KEY) * 86400;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        snprintf(path, sizeof(path), "%s/%04d%02d%02d.edl", LOG_DIR, tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+        log_file = SD_MMC.open(path, FILE_APPEND);
+    } else {
+        int n = 1;
+        for (; n <= 9999; n++) {
+            snprintf(path, sizeof(path), "%s/up%04d.edl", LOG_DIR, n);
+            if (!SD_MMC.exists(path)) break;
+        }
+        if (n > 9999) {
+            DIAG_W("no free log file name");
+            return false;
+        }
+        log_file = SD_MMC.open(path, FILE_WRITE);
+    }
+    if (!log_file) {
+        DIAG_E("cannot open %s", path);
+        return false;
+    }
+    // A block torn by a power cut leaves the file off the 4 KB grid; pad it
+    // out so new blocks stay aligned (readers skip the zero block).
+    size_t tail = log_file.size() % ELOG_BLOCK_SIZE;
+    if (tail) {
+        static const uint8_t zeros[512] = {};
+        for (size_t left = ELOG_BLOCK_SIZE - tail; left > 0;) {
+            size_t n = left < sizeof(zeros) ? left : sizeof(zeros);
+            log_file.write(zeros, n);
+            left -= n;
+        }
+    }
+    file_open = true;
+    file_key = key;
+    strncpy(stats.file, path, sizeof(stats.file) - 1);
+    stats.running = true;
+    DIAG_I("logging engine data to %s", path);
+    return true;
+}
+
+static void write_block() {
+    if (block_count == 0) return;
+    ElogBlockHeader h = {};
+    h.count = block_count;
+    h.seq = block_seq++;
+    h.base_ms = block_base_ms;
+    h.epoch_offset_s = engine_log_epoch_offset_s();
+    h.boot_id = boot_id;
+    elog_seal_block(block, &h);
+
+    uint32_t t0 = millis();
+    size_t written = file_open ? log_file.write(block, ELOG_BLOCK_SIZE) : 0;
+    if (written == ELOG_BLOCK_SIZE) log_file.flush();
+    uint32_t took = millis() - t0;
+    if (took > stats.write_max_ms) stats.write_max_ms = took;
+    if (written == ELOG_BLOCK_SIZE) {
+        stats.blocks++;
+        stats.records += block_count;
+    } else {
+        // Reopened (and re-aligned) on the next record
+        stats.write_errors++;
+        DIAG_E("SD write failed, %u records lost", (unsigned)block_count);
+        close_file();
+    }
+    memset(block, 0, ELOG_BLOCK_SIZE);
+    block_count = 0;
+}
+
+static void add_record(const LogCell &c) {
+    uint32_t key = day_key(c.t_ms);
+    if (!file_open || key != file_key) {
+        write_block();
+        if (!open_file(key)) {
+            stats.write_errors++;
+            return;
+        }
+    }
+    int32_t dt = (int32_t)(c.t_ms - block_base_ms);
+    if (block_count > 0 && dt > (int32_t)ELOG_MAX_DT_MS) write_block();
+    if (block_count == 0) {
+        block_base_ms = c.t_ms;
+        block_opened_ms = millis();
+        dt = 0;
+    }
+    // Producers race for queue positions, so a record can be a little older
+    // than the block's first one
+    if (dt < 0) dt = 0;
+    elog_put_record(block, block_count++, c.slot, (uint32_t)dt, c.value);
+    if (block_count == ELOG_MAX_RECORDS) write_block();
+}
+
+static void writer_task(void *param) {
+    (void)param;
+    for (;;) {
+        uint32_t depth = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED) - dequeue_pos;
+        if (depth > stats.queue_peak && depth <= QUEUE_CELLS) stats.queue_peak = depth;
+        LogCell c;
+        while (queue_pop(&c)) {
+            if (enabled) add_record(c);
+        }
+        if (block_count > 0 && (!enabled || millis() - block_opened_ms >= FLUSH_INTERVAL_MS)) write_block();
+        if (!enabled) close_file();
+        vTaskDelay(pdMS_TO_TICKS(POLL_MS));
+    }
+}
+
+static bool load_enabled() {
+    Preferences prefs;
+    bool on = true;
+    if (prefs.begin("englog", true)) {
+        on = prefs.getBool("on", true);
+        prefs.end();
+    }
+    return on;
+}
+
+void engine_log_start() {
+    if (writer_task_handle != NULL) return;
+    bool on = load_enabled();
+    stats.enabled = on;
+    if (SD_MMC.cardType() == CARD_NONE) {
+        DIAG_W("no SD card, engine data logging off");
+        return;
+    }
+    cells = (LogCell *)heap_caps_calloc(QUEUE_CELLS, sizeof(LogCell), MALLOC_CAP_SPIRAM);
+    block = (uint8_t *)heap_caps_calloc(1, ELOG_BLOCK_SIZE, MALLOC_CAP_SPIRAM);
+    if (cells == NULL || block == NULL) {
+        DIAG_E("PSRAM allocation failed, engine data logging off");
+        free(cells);
+        free(block);
+        cells = NULL;
+        block = NULL;
+        return;
+    }
+    for (uint32_t i = 0; i < QUEUE_CELLS; i++) cells[i].seq = i;
+    boot_id = esp_random();
+    xTaskCreatePinnedToCore(writer_task, "eng_log", 4096, NULL, 1, &writer_task_handle, 0);
+    enabled = on;
+}
+
+void engine_log_set_enabled(bool on) {
+    Preferences prefs;
+    if (prefs.begin("englog", false)) {
+        prefs.putBool("on", on);
+        prefs.end();
+    }
+    stats.enabled = on;
+    // Without a writer (no card) only the setting changes
+    enabled = on && writer_task_handle != NULL;
+}
+
+void engine_log_get_stats(EngineLogStats *out) {
+    *out = stats;
+    out->clock_known = engine_log_epoch_offset_s() != 0;
+    out->queued = __atomic_load_n(&queued, __ATOMIC_RELAXED);
+    out->dropped = __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,51 @@
+#ifndef ENGINE_LOG_H
+#define ENGINE_LOG_H
+
+#include <Arduino.h>
+
+// Continuous engine data log on the SD card (/logs/*.edl, format in
+// engine_log_format.h).
+//
+// Every changed slot value goes into a bounded lock-free queue; producers
+// (the ingest tasks, via set_sensor_sample) never block and count a drop
+// when it is full. A low-priority task on core 0 drains the queue into a
+// 4 KB block in PSRAM and writes each sealed block at a 4 KB offset, so the
+// card sees whole-sector writes and the UI task never touches SD for it.
+//
+// Files rotate daily: /logs/YYYYMMDD.edl once the wall clock is known from
+// Signal K timestamps, /logs/upNNNN.edl (one per boot, then every 24 h of
+// uptime) before that.
+
+struct EngineLogStats {
+    bool enabled;
+    bool running;              // writer task active with an open file
+    bool clock_known;          // epoch offset learned from Signal K
+    uint32_t queued;           // records accepted by the queue
+    uint32_t dropped;          // records lost to a full queue
+    uint32_t queue_peak;       // highest queue depth seen by the writer
+    uint32_t records;          // records written to the card
+    uint32_t blocks;
+    uint32_t write_errors;
+    uint32_t write_max_ms;     // slowest block write
+    char file[32];
+};
+
+// Start the writer if logging is enabled in NVS (default on) and an SD card
+// is present. Call after SD_Init().
+void engine_log_start();
+
+// Turn logging on or off and remember the choice. Turning it off seals the
+// open block and closes the file.
+void engine_log_set_enabled(bool on);
+
+// Producer side, any task: queue `value` for `slot` received at `now_ms`.
+// sk_time_ms (0 = none) is the Signal K timestamp of the value and keeps the
+// wall clock offset current.
+void engine_log_note(int slot, float value, uint32_t now_ms, int64_t sk_time_ms);
+
+// Wall clock = millis() / 1000 + offset; 0 until a Signal K timestamp was seen
+int32_t engine_log_epoch_offset_s();
+
+void engine_log_get_stats(EngineLogStats *out);
+
+#endif // ENGINE_LOG_H
@@ -0,0 +1,128 @@
+#ifndef ENGINE_LOG_FORMAT_H
+#define ENGINE_LOG_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// On-disk format of the engine data log (/logs/*.edl).
+//
+// A file is a sequence of self-contained 4096-byte blocks, written at 4 KB
+// offsets so every block maps onto whole SD sectors. A block that fails its
+// CRC (e.g. torn by a power cut) is skipped; the rest of the file still
+// reads.
+//
+//   header  32 bytes, little endian
+//     u32 magic "EDL1", u16 version, u16 count (records in the block),
+//     u32 seq (block number since boot), u32 base_ms (millis() of the first
+//     record), i32 epoch_offset_s (wall clock = uptime + offset, 0 = not
+//     known), u32 boot_id, u32 reserved, u32 crc (CRC-32/IEEE of the whole
+//     block with this field zeroed)
+//   record  8 bytes: u32 (slot << 27 | ms since base_ms), f32 value
+//
+// The unused tail of a block is zero. Plain C++ with inline helpers only,
+// so host tools can read the files too.
+
+#define ELOG_MAGIC 0x314C4445u            // "EDL1"
+#define ELOG_VERSION 1
+#define ELOG_BLOCK_SIZE 4096
+#define ELOG_HEADER_SIZE 32
+#define ELOG_RECORD_SIZE 8
+#define ELOG_MAX_RECORDS ((ELOG_BLOCK_SIZE - ELOG_HEADER_SIZE) / ELOG_RECORD_SIZE)   // 508
+#define ELOG_MAX_DT_MS ((1u << 27) - 1)   // about 37 hours
+#define ELOG_CRC_OFFSET 28
+
+struct ElogBlockHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t seq;
+    uint32_t base_ms;
+    int32_t epoch_offset_s;
+    uint32_t boot_id;
+    uint32_t reserved;
+    uint32_t crc;
+};
+
+static inline void elog_put_u16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void elog_put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+static inline uint16_t elog_get_u16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t elog_get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// CRC-32/IEEE (as zlib's crc32), four bits at a time. Start with
+// crc = 0xFFFFFFFF and invert the final value.
+static inline uint32_t elog_crc32_update(uint32_t crc, const uint8_t *p, size_t n) {
+    static const uint32_t T[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    for (size_t i = 0; i < n; i++) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ T[crc & 15];
+        crc = (crc >> 4) ^ T[crc & 15];
+    }
+    return crc;
+}
+
+static inline uint32_t elog_crc32(const uint8_t *p, size_t n) {
+    return ~elog_crc32_update(0xFFFFFFFFu, p, n);
+}
+
+static inline void elog_put_record(uint8_t *block, uint16_t i, int slot, uint32_t dt_ms, float value) {
+    uint8_t *p = block + ELOG_HEADER_SIZE + (size_t)i * ELOG_RECORD_SIZE;
+    elog_put_u32(p, ((uint32_t)slot << 27) | (dt_ms & ELOG_MAX_DT_MS));
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    elog_put_u32(p + 4, bits);
+}
+
+static inline void elog_get_record(const uint8_t *block, uint16_t i, int *slot, uint32_t *dt_ms, float *value) {
+    const uint8_t *p = block + ELOG_HEADER_SIZE + (size_t)i * ELOG_RECORD_SIZE;
+    uint32_t tag = elog_get_u32(p);
+    *slot = (int)(tag >> 27);
+    *dt_ms = tag & ELOG_MAX_DT_MS;
+    uint32_t bits = elog_get_u32(p + 4);
+    memcpy(value, &bits, sizeof(bits));
+}
+
+// Fill in the header (records must already be in place) and seal the block.
+static inline void elog_seal_block(uint8_t *block, const ElogBlockHeader *h) {
+    elog_put_u32(block, ELOG_MAGIC);
+    elog_put_u16(block + 4, ELOG_VERSION);
+    elog_put_u16(block + 6, h->count);
+    elog_put_u32(block + 8, h->seq);
+    elog_put_u32(block + 12, h->base_ms);
+    elog_put_u32(block + 16, (uint32_t)h->epoch_offset_s);
+    elog_put_u32(block + 20, h->boot_id);
+    elog_put_u32(block + 24, 0);
+    elog_put_u32(block + ELOG_CRC_OFFSET, 0);
+    elog_put_u32(block + ELOG_CRC_OFFSET, elog_crc32(block, ELOG_BLOCK_SIZE));
+}
+
+// Decode and verify a block. Returns false for a bad magic, version, count
+// or CRC.
+static inline bool elog_open_block(const uint8_t *block, ElogBlockHeader *h) {
+    h->magic = elog_get_u32(block);
+    h->version = elog_get_u16(block + 4);
+    h->count = elog_get_u16(block + 6);
+    h->seq = elog_get_u32(block + 8);
+    h->base_ms = elog_get_u32(block + 12);
+    h->epoch_offset_s = (int32_t)elog_get_u32(block + 16);
+    h->boot_id = elog_get_u32(block + 20);
+    h->reserved = elog_get_u32(block + 24);
+    h->crc = elog_get_u32(block + ELOG_CRC_OFFSET);
+    if (h->magic != ELOG_MAGIC || h->version != ELOG_VERSION || h->count > ELOG_MAX_RECORDS) return false;
+    // CRC over the block with the crc field read as zero
+    uint8_t head[ELOG_HEADER_SIZE];
+    memcpy(head, block, ELOG_HEADER_SIZE);
+    memset(head + ELOG_CRC_OFFSET, 0, 4);
+    uint32_t c = elog_crc32_update(0xFFFFFFFFu, head, ELOG_HEADER_SIZE);
+    c = elog_crc32_update(c, block + ELOG_HEADER_SIZE, ELOG_BLOCK_SIZE - ELOG_HEADER_SIZE);
+    return ~c == h->crc;
+}
+
+#endif // ENGINE_LOG_FORMAT_H
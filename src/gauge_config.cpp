@@ -1,46 +1,64 @@
 #include <cstdint>
 #include "network_setup.h"
+#include "calibration_lut.h"
+#include "gauge_curves.h"
+#include "calibration_store.h"
 #include <cmath>
 #include <cstdlib>
 
-// Get angle for a value using per-screen, per-gauge calibration
-int16_t gauge_value_to_angle_screen(float value, int screen, int gauge) {
-    if (screen < 0 || screen >= NUM_SCREENS) return 0;
-    if (gauge < 0 || gauge > 1) return 0;
-    GaugeCalibrationPoint* cal = gauge_cal[screen][gauge];
-    // Find which segment the value falls into
-    for (int i = 0; i < 4; i++) {
-        float val1 = cal[i].value;
-        float val2 = cal[i + 1].value;
-        int16_t angle1 = cal[i].angle;
-        int16_t angle2 = cal[i + 1].angle;
-        if ((val1 <= val2 && value >= val1 && value <= val2) ||
-            (val1 > val2 && value >= val2 && value <= val1)) {
-            float value_range = val2 - val1;
-            if (fabs(value_range) < 0.001) return angle1;
-            float normalized = (value - val1) / value_range;
-            int16_t result;
-            if (angle2 < angle1) {
-                result = angle1 - (int16_t)(normalized * abs(angle2 - angle1));
+// Compiled per-screen, per-gauge curves; count 0 = use the float reference
+static CalLut screen_lut[NUM_SCREENS][2];
+
+static void screen_curve(CalCurve *c, int screen, int gauge) {
+    GaugeCurve gc;
+    gauge_curve_get(screen * 2 + gauge, &gc);
+    gauge_curve_to_cal(&gc, c);
+}
+
+void gauge_cal_compile() {
+    uint32_t t0 = micros();
+    int entries = 0, fallbacks = 0;
+    for (int s = 0; s < NUM_SCREENS; s++) {
+        for (int g = 0; g < 2; g++) {
+            CalCurve c;
+            screen_curve(&c, s, g);
+            if (cal_lut_build(&screen_lut[s][g], cal_ref_for_mode(c.mode), &c)) {
+                entries += screen_lut[s][g].count;
             } else {
-                result = angle1 + (int16_t)(normalized * abs(angle2 - angle1));
+                fallbacks++;
             }
-            return result;
         }
     }
-    if (value < cal[0].value) return cal[0].angle;
-    return cal[4].angle;
+    Serial.printf("[gauge_config] Compiled calibration: %d steps, %d curves on float fallback, %lu us\n",
+                  entries, fallbacks, (unsigned long)(micros() - t0));
 }
-// Use the Preferences object from network_setup.cpp for all calibration storage
+
+// Get angle for a value using per-screen, per-gauge calibration
+int16_t gauge_value_to_angle_screen(float value, int screen, int gauge) {
+    if (screen < 0 || screen >= NUM_SCREENS) return 0;
+    if (gauge < 0 || gauge > 1) return 0;
+    const CalLut *lut = &screen_lut[screen][gauge];
+    if (lut->count) return cal_lut_lookup(lut, value);
+    CalCurve c;
+    screen_curve(&c, screen, gauge);
+    return cal_ref_for_mode(c.mode)(value, &c);
+}
+
+// Calibration is persisted through calibration_store.h
 #include "gauge_config.h"
 #include <Arduino.h>
 #include "network_setup.h"
 #include "signalk_config.h"
-extern Preferences preferences;
+#include "sensor_store.h"
 GaugeConfig current_config;
 static bool setup_mode = false;
 static int16_t preview_top_angle = 0;
 static int16_t preview_bottom_angle = 0;
+// Legacy and per-parameter curves live in current_config; compiled on first
+// use after it changes
+static CalLut top_lut, bottom_lut;
+static CalLut param_lut[PARAM_TYPE_COUNT][2];
+static bool config_luts_built = false;
 
 void gauge_config_init() {
     static bool calibration_initialized = false;
@@ -155,41 +173,9 @@ void gauge_config_init() {
     current_config.bottom_angle_min = 0;
     current_config.bottom_angle_max = 360;
     
-    // Try to load from userdata partition (persists across firmware updates)
-    // Load persisted calibration from Preferences (safe open/close here)
-    Serial.println("[gauge_config] Loading gauge calibration from storage...");
-    if (preferences.begin("settings", true)) {
-        const char* param_names[] = {"rpm", "coolant", "fuel", "exhaust", "oil"};
-        const char* pos_names[] = {"top", "bot"};
-        for (int p = 0; p < PARAM_TYPE_COUNT; p++) {
-            for (int pos = 0; pos < 2; pos++) {
-                for (int i = 0; i < CALIBRATION_POINTS; i++) {
-                    char key[32];
-                    snprintf(key, sizeof(key), "%s_%s_val_%d", param_names[p], pos_names[pos], i);
-                    current_config.calibrations[p][pos].values[i] = preferences.getFloat(key, current_config.calibrations[p][pos].values[i]);
-                    snprintf(key, sizeof(key), "%s_%s_ang_%d", param_names[p], pos_names[pos], i);
-                    current_config.calibrations[p][pos].angles[i] = preferences.getShort(key, current_config.calibrations[p][pos].angles[i]);
-                }
-            }
-        }
-        preferences.end();
-    } else {
-        Serial.println("[gauge_config] Preferences not available; using defaults.");
-    }
-    for (int i = 0; i < CALIBRATION_POINTS; i++) {
-        char key[16];
-        snprintf(key, sizeof(key), "top_val_%d", i);
-        current_config.top_values[i] = preferences.getFloat(key, current_config.top_values[i]);
-        snprintf(key, sizeof(key), "top_ang_%d", i);
-        current_config.top_angles[i] = preferences.getShort(key, current_config.top_angles[i]);
-    }
-    for (int i = 0; i < CALIBRATION_POINTS; i++) {
-        char key[16];
-        snprintf(key, sizeof(key), "bot_val_%d", i);
-        current_config.bottom_values[i] = preferences.getFloat(key, current_config.bottom_values[i]);
-        snprintf(key, sizeof(key), "bot_ang_%d", i);
-        current_config.bottom_angles[i] = preferences.getShort(key, current_config.bottom_angles[i]);
-    }
+    // One blob read; migrates the per-point keys the first time
+    cal_store_load_params(current_config);
+    config_luts_built = false;
     Serial.println("[gauge_config] Gauge config loaded from flash (5-point calibration)");
 }
 
@@ -199,83 +185,60 @@ void gauge_config_load(GaugeConfig &config) {
 
 void gauge_config_save(const GaugeConfig &config) {
     current_config = config;
-    // Preferences must already be open! Only write if open.
+    config_luts_built = false;
     Serial.println("[gauge_config] Saving gauge calibration to NVS...");
-    const char* param_names[] = {"rpm", "coolant", "fuel", "exhaust", "oil"};
-    const char* pos_names[] = {"top", "bot"};
-    for (int p = 0; p < PARAM_TYPE_COUNT; p++) {
-        for (int pos = 0; pos < 2; pos++) {
-            for (int i = 0; i < CALIBRATION_POINTS; i++) {
-                char key[32];
-                snprintf(key, sizeof(key), "%s_%s_val_%d", param_names[p], pos_names[pos], i);
-                preferences.putFloat(key, config.calibrations[p][pos].values[i]);
-                snprintf(key, sizeof(key), "%s_%s_ang_%d", param_names[p], pos_names[pos], i);
-                preferences.putShort(key, config.calibrations[p][pos].angles[i]);
-            }
-        }
-    }
-    for (int i = 0; i < CALIBRATION_POINTS; i++) {
-        char key[16];
-        snprintf(key, sizeof(key), "top_val_%d", i);
-        preferences.putFloat(key, config.top_values[i]);
-        snprintf(key, sizeof(key), "top_ang_%d", i);
-        preferences.putShort(key, config.top_angles[i]);
-    }
-    for (int i = 0; i < CALIBRATION_POINTS; i++) {
-        char key[16];
-        snprintf(key, sizeof(key), "bot_val_%d", i);
-        preferences.putFloat(key, config.bottom_values[i]);
-        snprintf(key, sizeof(key), "bot_ang_%d", i);
-        preferences.putShort(key, config.bottom_angles[i]);
-    }
+    cal_store_save();
     Serial.println("[gauge_config] Gauge config saved to flash (5-point calibration)");
     // After saving calibration changes, refresh Signal K subscriptions so
     // any path changes or re-applies take effect immediately.
     refresh_signalk_subscriptions();
+    sensor_mark_dirty(~0u);
 }
 
-int16_t gauge_top_value_to_angle(float value) {
-    // Clamp to min/max calibration points
-    if (value <= current_config.top_values[0]) return current_config.top_angles[0];
-    if (value >= current_config.top_values[CALIBRATION_POINTS-1]) return current_config.top_angles[CALIBRATION_POINTS-1];
-    
-    // Find which segment the value falls into
-    for (int i = 0; i < CALIBRATION_POINTS - 1; i++) {
-        if (value >= current_config.top_values[i] && value <= current_config.top_values[i+1]) {
-            // Piecewise linear interpolation between points i and i+1
-            float value_range = current_config.top_values[i+1] - current_config.top_values[i];
-            if (value_range <= 0) return current_config.top_angles[i];
-            
-            float normalized = (value - current_config.top_values[i]) / value_range;
-            int16_t angle_range = current_config.top_angles[i+1] - current_config.top_angles[i];
-            
-            return current_config.top_angles[i] + (int16_t)(normalized * angle_range);
-        }
+static void make_curve(CalCurve *c, const float *values, const int16_t *angles) {
+    for (int i = 0; i < CALIBRATION_POINTS; i++) {
+        c->values[i] = values[i];
+        c->angles[i] = angles[i];
     }
-    
-    return current_config.top_angles[0];  // Fallback
+    c->n = CALIBRATION_POINTS;
+    c->mode = CAL_LINEAR;
 }
 
-int16_t gauge_bottom_value_to_angle(float value) {
-    // Clamp to min/max calibration points
-    if (value <= current_config.bottom_values[0]) return current_config.bottom_angles[0];
-    if (value >= current_config.bottom_values[CALIBRATION_POINTS-1]) return current_config.bottom_angles[CALIBRATION_POINTS-1];
-    
-    // Find which segment the value falls into
-    for (int i = 0; i < CALIBRATION_POINTS - 1; i++) {
-        if (value >= current_config.bottom_values[i] && value <= current_config.bottom_values[i+1]) {
-            // Piecewise linear interpolation between points i and i+1
-            float value_range = current_config.bottom_values[i+1] - current_config.bottom_values[i];
-            if (value_range <= 0) return current_config.bottom_angles[i];
-            
-            float normalized = (value - current_config.bottom_values[i]) / value_range;
-            int16_t angle_range = current_config.bottom_angles[i+1] - current_config.bottom_angles[i];
-            
-            return current_config.bottom_angles[i] + (int16_t)(normalized * angle_range);
+static void build_config_luts() {
+    if (config_luts_built) return;
+    config_luts_built = true;
+    CalCurve c;
+    make_curve(&c, current_config.top_values, current_config.top_angles);
+    cal_lut_build(&top_lut, cal_ref_clamped, &c);
+    make_curve(&c, current_config.bottom_values, current_config.bottom_angles);
+    cal_lut_build(&bottom_lut, cal_ref_clamped, &c);
+    for (int p = 0; p < PARAM_TYPE_COUNT; p++) {
+        for (int pos = 0; pos < 2; pos++) {
+            const ParamCalibration &pc = current_config.calibrations[p][pos];
+            make_curve(&c, pc.values, pc.angles);
+            cal_lut_build(&param_lut[p][pos], cal_ref_segments, &c);
         }
     }
-    
-    return current_config.bottom_angles[0];  // Fallback
+}
+
+static int16_t config_curve_angle(const CalLut *lut, CalRefFn ref, const float *values,
+                                  const int16_t *angles, float value) {
+    if (lut->count) return cal_lut_lookup(lut, value);
+    CalCurve c;
+    make_curve(&c, values, angles);
+    return ref(value, &c);
+}
+
+int16_t gauge_top_value_to_angle(float value) {
+    build_config_luts();
+    return config_curve_angle(&top_lut, cal_ref_clamped, current_config.top_values,
+                              current_config.top_angles, value);
+}
+
+int16_t gauge_bottom_value_to_angle(float value) {
+    build_config_luts();
+    return config_curve_angle(&bottom_lut, cal_ref_clamped, current_config.bottom_values,
+                              current_config.bottom_angles, value);
 }
 
 // Get angle for a value using parameter type and position
@@ -285,41 +248,10 @@ int16_t gauge_value_to_angle(float value, int param_type, int position) {
     // Bounds check
     if (param_type < 0 || param_type >= PARAM_TYPE_COUNT) return 0;
     if (position < 0 || position > 1) return 0;
-
-    ParamCalibration* cal = &current_config.calibrations[param_type][position];
-
-    // Find which segment the value falls into
-    for (int i = 0; i < CALIBRATION_POINTS - 1; i++) {
-        float val1 = cal->values[i];
-        float val2 = cal->values[i + 1];
-        int16_t angle1 = cal->angles[i];
-        int16_t angle2 = cal->angles[i + 1];
-
-        // Check if value is within this segment
-        if ((val1 <= val2 && value >= val1 && value <= val2) ||
-            (val1 > val2 && value >= val2 && value <= val1)) {
-            // Linear interpolation between the two points
-            float value_range = val2 - val1;
-            if (fabs(value_range) < 0.001) return angle1;  // Avoid division by zero
-
-            float normalized = (value - val1) / value_range;
-            int16_t result;
-            if (angle2 < angle1) {
-                // Counterclockwise gauge: angles decrease as value increases
-                result = angle1 - (int16_t)(normalized * abs(angle2 - angle1));
-            } else {
-                // Clockwise gauge: angles increase as value increases
-                result = angle1 + (int16_t)(normalized * abs(angle2 - angle1));
-            }
-            return result;
-        }
-    }
-
-    // If value is outside range, return nearest endpoint
-    if (value < cal->values[0]) {
-        return cal->angles[0];
-    }
-    return cal->angles[CALIBRATION_POINTS - 1];
+    build_config_luts();
+    const ParamCalibration &pc = current_config.calibrations[param_type][position];
+    return config_curve_angle(&param_lut[param_type][position], cal_ref_segments, pc.values,
+                              pc.angles, value);
 }
 
 bool gauge_is_setup_mode() {
@@ -78,3 +78,8 @@ int16_t gauge_get_preview_bottom_angle();
 
 // New function for per-screen, per-gauge calibration
 int16_t gauge_value_to_angle_screen(float value, int screen, int gauge);
+
+// Compile each gauge's curve (gauge_curves.h: its custom curve or its
+// gauge_cal points) into a lookup table (calibration_lut.h). Call after
+// either changes; until then lookups use the previous tables.
+void gauge_cal_compile();
@@ -0,0 +1,86 @@
+#include "gauge_curves.h"
+#include "network_setup.h"   // gauge_cal
+#include "calibration_store.h"
+
+static GaugeCurve custom[TOTAL_PARAMS];   // n == 0: none
+
+void gauge_curve_get(int slot, GaugeCurve *out) {
+    memset(out, 0, sizeof(*out));
+    if (slot < 0 || slot >= TOTAL_PARAMS) return;
+    if (custom[slot].n) {
+        *out = custom[slot];
+        return;
+    }
+    const GaugeCalibrationPoint *cal = gauge_cal[slot / 2][slot % 2];
+    out->mode = CAL_LINEAR;
+    out->n = 5;
+    for (int i = 0; i < 5; i++) {
+        out->values[i] = cal[i].value;
+        out->angles[i] = (int16_t)cal[i].angle;
+    }
+}
+
+bool gauge_curve_is_custom(int slot) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) return false;
+    return custom[slot].n != 0;
+}
+
+const char *gauge_curve_set(int slot, const GaugeCurve *curve) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) return "bad slot";
+    CalCurve cal;
+    const char *err = gauge_curve_to_cal(curve, &cal);
+    if (err) return err;
+    GaugeCurve previous = custom[slot];
+    custom[slot] = *curve;
+    memset(custom[slot].reserved, 0, sizeof(custom[slot].reserved));
+    if (!cal_store_save()) {
+        custom[slot] = previous;
+        return "storage write failed";
+    }
+    return NULL;
+}
+
+void gauge_curve_clear(int slot) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) return;
+    memset(&custom[slot], 0, sizeof(custom[slot]));
+    cal_store_save();
+}
+
+void gauge_curves_import(const GaugeCurve *curves, uint16_t mask) {
+    for (int slot = 0; slot < TOTAL_PARAMS; slot++) {
+        CalCurve cal;
+        if ((mask & (1u << slot)) && gauge_curve_to_cal(&curves[slot], &cal) == NULL) {
+            custom[slot] = curves[slot];
+        } else {
+            memset(&custom[slot], 0, sizeof(custom[slot]));
+        }
+    }
+}
+
+void gauge_curves_export(GaugeCurve *curves, uint16_t *mask) {
+    *mask = 0;
+    for (int slot = 0; slot < TOTAL_PARAMS; slot++) {
+        curves[slot] = custom[slot];
+        if (custom[slot].n) *mask |= 1u << slot;
+    }
+}
+
+const char *gauge_curve_to_cal(const GaugeCurve *curve, CalCurve *out) {
+    if (curve->n < 1 || curve->n > GAUGE_CURVE_MAX_POINTS) return "bad point count";
+    out->n = curve->n;
+    out->mode = curve->mode;
+    for (int i = 0; i < curve->n; i++) {
+        out->values[i] = curve->values[i];
+        out->angles[i] = curve->angles[i];
+    }
+    return cal_curve_prepare(out);
+}
+
+const char *gauge_curve_mode_name(uint8_t mode) {
+    switch (mode) {
+        case CAL_LINEAR: return "linear";
+        case CAL_CUBIC: return "cubic";
+        case CAL_LOG: return "log";
+        default: return "?";
+    }
+}
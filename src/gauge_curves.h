@@ -0,0 +1,46 @@
+#ifndef GAUGE_CURVES_H
+#define GAUGE_CURVES_H
+
+#include <Arduino.h>
+#include "calibration_lut.h"
+
+// Per-gauge calibration curves of up to GAUGE_CURVE_MAX_POINTS points with
+// linear, monotone-cubic or logarithmic interpolation (CalMode).
+//
+// A gauge without a curve of its own uses its five gauge_cal points from the
+// Gauges page as a linear curve, which maps exactly as before. A custom
+// curve (edited on /curves) takes over from those points and is persisted
+// in the calibration blob (calibration_store.h). gauge_cal_compile() turns
+// the effective curve into a lookup table.
+
+#define GAUGE_CURVE_MAX_POINTS CAL_LUT_MAX_KNOTS
+
+struct GaugeCurve {
+    uint8_t mode;        // CalMode
+    uint8_t n;           // points in use
+    uint8_t reserved[2];
+    float values[GAUGE_CURVE_MAX_POINTS];
+    int16_t angles[GAUGE_CURVE_MAX_POINTS];
+};
+
+// Effective curve of a slot (screen * 2 + gauge)
+void gauge_curve_get(int slot, GaugeCurve *out);
+bool gauge_curve_is_custom(int slot);
+
+// Store a custom curve. Returns NULL or why it was rejected. Callers
+// recompile with gauge_cal_compile().
+const char *gauge_curve_set(int slot, const GaugeCurve *curve);
+// Drop a custom curve and go back to the gauge_cal points
+void gauge_curve_clear(int slot);
+
+// All TOTAL_PARAMS custom curves, bit i of mask set where slot i has one;
+// for the calibration store
+void gauge_curves_import(const GaugeCurve *curves, uint16_t mask);
+void gauge_curves_export(GaugeCurve *curves, uint16_t *mask);
+
+// Copy into the form cal_lut_build() takes and prepare it
+const char *gauge_curve_to_cal(const GaugeCurve *curve, CalCurve *out);
+
+const char *gauge_curve_mode_name(uint8_t mode);
+
+#endif // GAUGE_CURVES_H
@@ -0,0 +1,78 @@
+// Handler for the /counters page: engine hours and totals
+#include <Arduino.h>
+#include <WebServer.h>
+#include "network_setup.h"
+#include "signalk_config.h"
+#include "engine_counters.h"
+extern WebServer config_server;
+
+static void send_counters_page() {
+    CounterStats cs;
+    counters_get_stats(&cs);
+    String html;
+    html.reserve(5120);
+    html += "<html><head>";
+    html += STYLE;
+    html += "<title>Counters</title></head><body><div class='container'><div class='tab-content'>";
+    html += "<h2>Engine Hours and Totals</h2>"
+            "<p><b>Hours</b> counts time while the slot is above the threshold. <b>Total</b> adds up "
+            "value &times; scale per second, e.g. fuel rate in m&sup3;/s with scale 1000 gives litres. "
+            "Slots are s0 = screen 1 top, s1 = screen 1 bottom, ... A new value in <i>Set to</i> replaces "
+            "the total.</p>"
+            "<form method='POST' action='/counters'><table class='file-table'>"
+            "<tr><th>Name</th><th>Kind</th><th>Slot</th><th>Threshold</th><th>Scale</th><th>Value</th>"
+            "<th>Set to</th></tr>";
+    for (int n = 0; n < COUNTER_MAX; n++) {
+        CounterConfig c;
+        counters_get_config(n, &c);
+        String i = String(n);
+        html += "<tr><td><input type='text' maxlength='" + String(COUNTER_NAME_MAX - 1) + "' name='n" + i +
+                "' value='" + String(c.name) + "'></td><td><select name='k" + i + "'>";
+        const char *kinds[] = {"off", "hours", "total"};
+        for (int k = 0; k < 3; k++) {
+            html += "<option value='" + String(k) + "'" + (c.kind == k ? " selected" : "") + ">" + kinds[k] + "</option>";
+        }
+        html += "</select></td><td><select name='s" + i + "'>";
+        for (int s = 0; s < TOTAL_PARAMS; s++) {
+            html += "<option value='" + String(s) + "'" + (c.slot == s ? " selected" : "") + ">s" + String(s) + "</option>";
+        }
+        html += "</select></td><td><input type='number' step='any' name='t" + i + "' value='" + String(c.threshold, 3) +
+                "'></td><td><input type='number' step='any' name='c" + i + "' value='" +
+                String(c.kind == COUNTER_OFF && c.scale == 0 ? 1.0f : c.scale, 4) + "'></td><td>" +
+                String(counters_get_value(n), 2) + (c.kind == COUNTER_HOURS ? " h" : "") +
+                "</td><td><input type='number' step='any' name='v" + i + "'></td></tr>";
+    }
+    html += "</table><p><input type='submit' value='Save'></p></form>";
+    html += "<p>Checkpoint " + String(cs.seq) + (cs.restored ? " (restored at boot)" : "") + ", " +
+            String(cs.checkpoints) + " written since boot, " + String(cs.write_errors) + " errors, slowest " +
+            String(cs.write_max_ms) + " ms</p>";
+    html += "<p><a href='/'>Back</a></p></div></div></body></html>";
+    config_server.send(200, "text/html", html);
+}
+
+void handle_counters() {
+    if (config_server.method() == HTTP_POST) {
+        CounterConfig cfg[COUNTER_MAX];
+        memset(cfg, 0, sizeof(cfg));
+        for (int n = 0; n < COUNTER_MAX; n++) {
+            String i = String(n);
+            strncpy(cfg[n].name, config_server.arg("n" + i).c_str(), COUNTER_NAME_MAX - 1);
+            long k = config_server.arg("k" + i).toInt();
+            cfg[n].kind = (k == COUNTER_HOURS || k == COUNTER_TOTAL) ? (uint8_t)k : COUNTER_OFF;
+            long s = config_server.arg("s" + i).toInt();
+            cfg[n].slot = (int8_t)((s >= 0 && s < TOTAL_PARAMS) ? s : 0);
+            cfg[n].threshold = config_server.arg("t" + i).toFloat();
+            cfg[n].scale = config_server.arg("c" + i).toFloat();
+        }
+        counters_set_config(cfg);
+        for (int n = 0; n < COUNTER_MAX; n++) {
+            String v = config_server.arg("v" + String(n));
+            v.trim();
+            if (v.length()) counters_set_value(n, v.toDouble());
+        }
+        config_server.sendHeader("Location", "/counters", true);
+        config_server.send(302, "text/plain", "");
+        return;
+    }
+    send_counters_page();
+}
@@ -0,0 +1,168 @@
+// Handler for the /curves page: per-gauge calibration curves
+#include <Arduino.h>
+#include <WebServer.h>
+#include "network_setup.h"
+#include "gauge_config.h"
+#include "gauge_curves.h"
+#include "calibration_store.h"
+#include "sensor_filter.h"
+#include "sensor_store.h"
+extern WebServer config_server;
+
+static String slot_label(int slot) {
+    return "Screen " + String(slot / 2 + 1) + (slot % 2 ? " bottom" : " top");
+}
+
+// %.9g round-trips a float, so saving an unchanged curve keeps it exact
+static String curve_text(const GaugeCurve &c) {
+    String text;
+    for (int i = 0; i < c.n; i++) {
+        char line[40];
+        snprintf(line, sizeof(line), "%.9g %d\n", c.values[i], c.angles[i]);
+        text += line;
+    }
+    return text;
+}
+
+static String escape_html(const String &s) {
+    String out;
+    for (size_t i = 0; i < s.length(); i++) {
+        char ch = s[i];
+        if (ch == '<') out += "&lt;";
+        else if (ch == '&') out += "&amp;";
+        else out += ch;
+    }
+    return out;
+}
+
+// One "value angle" pair per line, separated by spaces, tabs or a comma
+static const char *parse_points(const String &text, GaugeCurve *out) {
+    const char *p = text.c_str();
+    out->n = 0;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+        if (!*p) break;
+        if (out->n >= GAUGE_CURVE_MAX_POINTS) return "too many points";
+        char *end;
+        float v = strtof(p, &end);
+        if (end == p) return "bad value";
+        p = end;
+        while (*p == ' ' || *p == '\t' || *p == ',' || *p == ';') p++;
+        long a = strtol(p, &end, 10);
+        if (end == p) return "missing angle";
+        if (a < -32768 || a > 32767) return "bad angle";
+        p = end;
+        while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+        if (*p && *p != '\n') return "one value and angle per line";
+        out->values[out->n] = v;
+        out->angles[out->n] = (int16_t)a;
+        out->n++;
+    }
+    return out->n ? NULL : "no points";
+}
+
+static void send_list_page() {
+    String html;
+    html.reserve(4096);
+    html += "<html><head>";
+    html += STYLE;
+    html += "<title>Calibration Curves</title></head><body><div class='container'><div class='tab-content'>";
+    html += "<h2>Calibration Curves</h2>"
+            "<p>Each gauge uses its five points from the Gauges page unless it has a curve of its own here, "
+            "with up to " + String(GAUGE_CURVE_MAX_POINTS) + " points and linear, cubic (monotone, no overshoot) "
+            "or log interpolation. While a custom curve is set, the Gauges page points do not move the needle.</p>"
+            "<table class='file-table'><tr><th>Gauge</th><th>Curve</th><th>Mode</th><th>Points</th>"
+            "<th>Range</th><th></th></tr>";
+    for (int slot = 0; slot < TOTAL_PARAMS; slot++) {
+        GaugeCurve c;
+        gauge_curve_get(slot, &c);
+        float lo = c.values[0], hi = c.values[0];
+        for (int i = 1; i < c.n; i++) {
+            if (c.values[i] < lo) lo = c.values[i];
+            if (c.values[i] > hi) hi = c.values[i];
+        }
+        html += "<tr><td>" + slot_label(slot) + "</td><td>" +
+                (gauge_curve_is_custom(slot) ? "custom" : "Gauges page") + "</td><td>" +
+                gauge_curve_mode_name(c.mode) + "</td><td>" + String(c.n) + "</td><td>" + String(lo, 2) +
+                " &ndash; " + String(hi, 2) + "</td><td><a href='/curves?slot=" + String(slot) +
+                "'>Edit</a></td></tr>";
+    }
+    html += "</table>";
+    CalStoreStats cs;
+    cal_store_get_stats(&cs);
+    html += "<p>Calibration blob " + String(cs.bytes) + " bytes, ";
+    if (cs.source == CAL_SOURCE_BLOB) {
+        html += "read at boot in " + String(cs.load_us) + " &micro;s";
+    } else {
+        html += "migrated at boot from " + String(cs.legacy_reads) + " older keys in " +
+                String(cs.load_us + cs.migrate_us) + " &micro;s";
+    }
+    html += "; " + String(cs.saves) + " writes, " + String(cs.save_errors) + " errors</p>";
+    html += "<p><a href='/'>Back</a></p></div></div></body></html>";
+    config_server.send(200, "text/html", html);
+}
+
+static void send_edit_page(int slot, uint8_t mode, const String &points, const char *error) {
+    String html;
+    html.reserve(4096);
+    html += "<html><head>";
+    html += STYLE;
+    html += "<title>Calibration Curve</title></head><body><div class='container'><div class='tab-content'>";
+    html += "<h2>" + slot_label(slot) + " (s" + String(slot) + ")</h2>";
+    if (error) html += "<p><b>Not saved: " + String(error) + "</b></p>";
+    html += "<p>One <i>value angle</i> pair per line, in the gauge's Signal K units (K, Pa, Hz, ratio). "
+            "Cubic and log need increasing values; log needs values above 0. Outside the first and last "
+            "point the needle stays at the end angle.</p>"
+            "<form method='POST' action='/curves'><input type='hidden' name='slot' value='" + String(slot) +
+            "'><p>Mode <select name='mode'>";
+    for (int m = 0; m < CAL_MODE_COUNT; m++) {
+        html += "<option value='" + String(m) + "'" + (mode == m ? " selected" : "") + ">" +
+                gauge_curve_mode_name(m) + "</option>";
+    }
+    html += "</select></p><p><textarea name='pts' rows='16' cols='32'>" + escape_html(points) + "</textarea></p>"
+            "<p><input type='submit' name='action' value='Save'> "
+            "<input type='submit' name='action' value='Use Gauges page points'></p></form>";
+    html += "<p><a href='/curves'>Back</a></p></div></div></body></html>";
+    config_server.send(200, "text/html", html);
+}
+
+void handle_curves() {
+    if (config_server.method() == HTTP_POST) {
+        long slot = config_server.arg("slot").toInt();
+        if (slot < 0 || slot >= TOTAL_PARAMS) {
+            config_server.send(400, "text/plain", "bad slot");
+            return;
+        }
+        if (config_server.arg("action") == "Save") {
+            GaugeCurve c;
+            memset(&c, 0, sizeof(c));
+            long mode = config_server.arg("mode").toInt();
+            c.mode = (mode >= 0 && mode < CAL_MODE_COUNT) ? (uint8_t)mode : CAL_LINEAR;
+            const char *err = parse_points(config_server.arg("pts"), &c);
+            if (!err) err = gauge_curve_set((int)slot, &c);
+            if (err) {
+                send_edit_page((int)slot, c.mode, config_server.arg("pts"), err);
+                return;
+            }
+        } else {
+            gauge_curve_clear((int)slot);
+        }
+        gauge_cal_compile();
+        // Filter resolution follows the calibration range
+        sensor_filter_init();
+        sensor_mark_dirty(1u << slot);
+        config_server.sendHeader("Location", "/curves", true);
+        config_server.send(302, "text/plain", "");
+        return;
+    }
+    if (config_server.hasArg("slot")) {
+        long slot = config_server.arg("slot").toInt();
+        if (slot >= 0 && slot < TOTAL_PARAMS) {
+            GaugeCurve c;
+            gauge_curve_get((int)slot, &c);
+            send_edit_page((int)slot, c.mode, curve_text(c), NULL);
+            return;
+        }
+    }
+    send_list_page();
+}
@@ -0,0 +1,87 @@
+// Handler for the /derived page: computed signals and their status
+#include <Arduino.h>
+#include <WebServer.h>
+#include "network_setup.h"
+#include "derived_signals.h"
+#include "sensor_store.h"
+extern WebServer config_server;
+
+// Escape for an HTML attribute value
+static String attr(const char *s) {
+    String out;
+    for (; *s; s++) {
+        if (*s == '\'') out += "&#39;";
+        else if (*s == '&') out += "&amp;";
+        else if (*s == '<') out += "&lt;";
+        else out += *s;
+    }
+    return out;
+}
+
+static void send_derived_page() {
+    DerivedStats ds;
+    derived_get_stats(&ds);
+    String html;
+    html.reserve(6144);
+    html += "<html><head>";
+    html += STYLE;
+    html += "<title>Derived Signals</title></head><body><div class='container'><div class='tab-content'>";
+    html += "<h2>Derived Signals</h2>"
+            "<p>Expressions may use <code>+ - * /</code>, parentheses, <code>min(a,b)</code>, <code>max(a,b)</code>, "
+            "<code>abs(x)</code> and <code>rate(x)</code> (change per second). Names are gauge slots "
+            "<code>s0</code>&ndash;<code>s9</code> (screen 1 top = s0, screen 1 bottom = s1, ...), other derived "
+            "signals, or Signal K paths. To show a signal on a gauge, set the gauge's Signal K path to "
+            "<code>" DERIVED_SLOT_PREFIX "name</code>.</p>"
+            "<p>Examples: <code>propulsion.main.revolutions * 60 / 6</code>, <code>s1 - 273.15</code>, "
+            "<code>-rate(s3) * 3600</code>, <code>s5 - s4</code></p>"
+            "<form method='POST' action='/derived'><table class='file-table'>"
+            "<tr><th>Name</th><th>Expression</th><th>Status</th><th>Value</th><th>Evaluations</th><th>Shown on</th></tr>";
+    for (int n = 0; n < DERIVED_MAX; n++) {
+        DerivedDef def;
+        derived_get_def(n, &def);
+        DerivedStatus st;
+        derived_get_status(n, &st);
+        String i = String(n);
+        html += "<tr><td><input type='text' maxlength='" + String(DERIVED_NAME_MAX - 1) + "' name='n" + i +
+                "' value='" + attr(def.name) + "'></td>";
+        html += "<td><input type='text' maxlength='" + String(DERIVED_EXPR_MAX - 1) + "' name='x" + i +
+                "' value='" + attr(def.expr) + "' style='width:100%'></td><td>";
+        if (def.name[0] != '\0') html += st.ok ? String("OK") : attr(st.error);
+        html += "</td><td>" + (st.ok && !isnan(st.value) ? String(st.value, 3) : String("-")) + "</td><td>" +
+                String(st.evals) + "</td><td>";
+        for (int s = 0; s < TOTAL_PARAMS; s++) {
+            if (st.out_slots & (1u << s)) html += "s" + String(s) + " ";
+        }
+        html += "</td></tr>";
+    }
+    html += "</table><p><input type='submit' value='Save'></p></form>";
+    html += "<p>" + String(derived_input_count()) + " Signal K inputs; " + String(ds.triggers) + " updates, " +
+            String(ds.evals) + " evaluations, " + String(ds.publishes) + " gauge updates, slowest pass " +
+            String(ds.pass_max_us) + " &micro;s</p>";
+    html += "<p><a href='/'>Back</a></p></div></div></body></html>";
+    config_server.send(200, "text/html", html);
+}
+
+void handle_derived() {
+    if (config_server.method() == HTTP_POST) {
+        DerivedDef defs[DERIVED_MAX];
+        memset(defs, 0, sizeof(defs));
+        for (int n = 0; n < DERIVED_MAX; n++) {
+            String name = config_server.arg("n" + String(n));
+            String expr = config_server.arg("x" + String(n));
+            name.trim();
+            expr.trim();
+            if (name.length() == 0) continue;
+            strncpy(defs[n].name, name.c_str(), DERIVED_NAME_MAX - 1);
+            strncpy(defs[n].expr, expr.c_str(), DERIVED_EXPR_MAX - 1);
+        }
+        derived_set_defs(defs);
+        // New or removed Signal K inputs
+        refresh_signalk_subscriptions();
+        sensor_mark_dirty(~0u);
+        config_server.sendHeader("Location", "/derived", true);
+        config_server.send(302, "text/plain", "");
+        return;
+    }
+    send_derived_page();
+}
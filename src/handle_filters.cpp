@@ -0,0 +1,75 @@
+// Handler for the /filters page: per-slot filter chain settings and counters
+#include <Arduino.h>
+#include <WebServer.h>
+#include "network_setup.h"
+#include "sensor_filter.h"
+extern WebServer config_server;
+
+static void send_filters_page() {
+    String html;
+    html.reserve(6144);
+    html += "<html><head>";
+    html += STYLE;
+    html += "<title>Sensor Filters</title></head><body><div class='container'><div class='tab-content'>";
+    html += "<h2>Sensor Filters</h2>"
+            "<p>Applied in order median &rarr; EMA &rarr; slew limit &rarr; deadband. Deadband and slew "
+            "are in the units of the gauge calibration; 0 turns a stage off, EMA 100% is off.</p>"
+            "<form method='POST' action='/filters'><table class='file-table'>"
+            "<tr><th>Screen</th><th>Gauge</th><th>Path</th><th>Median of</th><th>EMA (%)</th>"
+            "<th>Deadband</th><th>Slew (/s)</th><th>Samples</th><th>Held</th><th>Slewed</th>"
+            "<th>Cost (&micro;s)</th></tr>";
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        SignalFilterConfig cfg;
+        sensor_filter_get_config(i, &cfg);
+        SignalFilterStats st;
+        uint32_t cost_x100 = 0;
+        sensor_filter_get_stats(i, &st, &cost_x100);
+        String path = get_signalk_path_by_index(i);
+        String n = String(i);
+        html += "<tr><td>" + String(i / 2 + 1) + "</td><td>" + String(i % 2 == 0 ? "Top" : "Bottom") + "</td><td>";
+        html += path.length() ? path : String("(none)");
+        html += "</td><td><select name='m" + n + "'>";
+        const uint8_t windows[] = {0, 3, 5, 7};
+        for (uint8_t w : windows) {
+            html += "<option value='" + String(w) + "'" + (cfg.median_n == w ? " selected" : "") + ">" +
+                    (w ? String(w) : String("off")) + "</option>";
+        }
+        html += "</select></td><td><input type='number' min='1' max='100' name='e" + n + "' value='" +
+                String(cfg.ema_pct) + "'></td>";
+        html += "<td><input type='number' min='0' step='any' name='d" + n + "' value='" + String(cfg.deadband, 4) + "'></td>";
+        html += "<td><input type='number' min='0' step='any' name='s" + n + "' value='" + String(cfg.slew_per_s, 4) + "'></td>";
+        html += "<td>" + String(st.samples) + "</td><td>" + String(st.deadband_held) + "</td><td>" +
+                String(st.slew_limited) + "</td><td>" + String(cost_x100 / 100.0f, 2) + "</td></tr>";
+    }
+    html += "</table><p><input type='submit' value='Save'></p></form>"
+            "<p><a href='/'>Back</a></p></div></div></body></html>";
+    config_server.send(200, "text/html", html);
+}
+
+void handle_filters() {
+    if (config_server.method() == HTTP_POST) {
+        for (int i = 0; i < TOTAL_PARAMS; i++) {
+            String n = String(i);
+            if (!config_server.hasArg("e" + n)) continue;
+            SignalFilterConfig cfg;
+            sensor_filter_get_config(i, &cfg);
+            SignalFilterConfig next = cfg;
+            long m = config_server.arg("m" + n).toInt();
+            next.median_n = (m == 3 || m == 5 || m == 7) ? (uint8_t)m : 0;
+            long e = config_server.arg("e" + n).toInt();
+            next.ema_pct = (uint8_t)(e < 1 ? 1 : (e > 100 ? 100 : e));
+            float d = config_server.arg("d" + n).toFloat();
+            next.deadband = (d > 0 && !isnan(d)) ? d : 0;
+            float s = config_server.arg("s" + n).toFloat();
+            next.slew_per_s = (s > 0 && !isnan(s)) ? s : 0;
+            if (next.median_n != cfg.median_n || next.ema_pct != cfg.ema_pct ||
+                next.deadband != cfg.deadband || next.slew_per_s != cfg.slew_per_s) {
+                sensor_filter_set_config(i, &next);
+            }
+        }
+        config_server.sendHeader("Location", "/filters", true);
+        config_server.send(302, "text/plain", "");
+        return;
+    }
+    send_filters_page();
+}
@@ -0,0 +1,49 @@
+// Handler for /history: a slot's value history as JSON
+//   GET /history?slot=0&seconds=3600&points=120[&tier=1s|1m|1h]
+// Points are [t_s, min, max, mean, n], oldest first; t_s is uptime seconds
+// (now_s in the response is the current uptime).
+#include <Arduino.h>
+#include <WebServer.h>
+#include "signalk_config.h"
+#include "sensor_history.h"
+extern WebServer config_server;
+
+#define HISTORY_MAX_POINTS 240
+
+void handle_history() {
+    int slot = config_server.arg("slot").toInt();
+    if (slot < 0 || slot >= TOTAL_PARAMS) {
+        config_server.send(400, "application/json", "{\"error\":\"bad slot\"}");
+        return;
+    }
+    long seconds = config_server.hasArg("seconds") ? config_server.arg("seconds").toInt() : 3600;
+    if (seconds < 1) seconds = 1;
+    long points = config_server.hasArg("points") ? config_server.arg("points").toInt() : 120;
+    if (points < 1) points = 1;
+    if (points > HISTORY_MAX_POINTS) points = HISTORY_MAX_POINTS;
+
+    HistoryTier tier = sensor_history_pick_tier((uint32_t)seconds, (size_t)points);
+    String t = config_server.arg("tier");
+    if (t == "1s") tier = HIST_TIER_1S;
+    else if (t == "1m") tier = HIST_TIER_1M;
+    else if (t == "1h") tier = HIST_TIER_1H;
+
+    uint32_t now_s = sensor_history_now_s();
+    uint32_t from_s = (uint32_t)seconds > now_s ? 0 : now_s - (uint32_t)seconds;
+    static HistoryPoint pts[HISTORY_MAX_POINTS];
+    size_t count = sensor_history_query(slot, tier, from_s, now_s, pts, (size_t)points);
+
+    static const char *TIER_NAMES[HIST_TIERS] = { "1s", "1m", "1h" };
+    static char buf[HISTORY_MAX_POINTS * 64 + 128];
+    size_t n = 0;
+    n += snprintf(buf + n, sizeof(buf) - n,
+        "{\"slot\":%d,\"tier\":\"%s\",\"period_s\":%lu,\"now_s\":%lu,\"points\":[",
+        slot, TIER_NAMES[tier], (unsigned long)history_tier_period_s(tier), (unsigned long)now_s);
+    for (size_t i = 0; i < count && n < sizeof(buf); i++) {
+        const HistoryPoint &p = pts[i];
+        n += snprintf(buf + n, sizeof(buf) - n, "%s[%lu,%.6g,%.6g,%.6g,%lu]", i ? "," : "",
+                      (unsigned long)p.t_s, p.min, p.max, p.mean, (unsigned long)p.n);
+    }
+    if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n, "]}");
+    config_server.send(200, "application/json", buf);
+}
@@ -0,0 +1,45 @@
+// Handler for /latency: per-slot ingest-to-photon histograms as JSON
+// (GET /latency?reset=1 clears them after the response is built)
+#include <Arduino.h>
+#include <WebServer.h>
+#include "signalk_config.h"
+#include "latency_probe.h"
+extern WebServer config_server;
+
+void handle_latency() {
+    latency_service();
+
+    static char buf[4096];
+    size_t n = 0;
+    n += snprintf(buf + n, sizeof(buf) - n,
+        "{\"bucket_upper_ms\":[1,2,4,8,16,32,64,128,256,512,1024,null],"
+        "\"stages\":[\"rx_consume\",\"consume_draw\",\"draw_flush\",\"flush_photon\"],\"slots\":[");
+    for (int i = 0; i < TOTAL_PARAMS && n < sizeof(buf); i++) {
+        LatencySlotStats st;
+        latency_get_slot(i, &st);
+        uint32_t avg = st.samples ? (uint32_t)(st.total_sum_us / st.samples) : 0;
+        n += snprintf(buf + n, sizeof(buf) - n,
+            "%s{\"slot\":%d,\"samples\":%lu,\"avg_us\":%lu,\"max_us\":%lu,\"p50_ms\":%lu,\"p99_ms\":%lu,"
+            "\"no_motion\":%lu,\"superseded\":%lu,\"buckets\":[",
+            i ? "," : "", i, (unsigned long)st.samples, (unsigned long)avg, (unsigned long)st.total_max_us,
+            (unsigned long)latency_percentile_ms(&st, 0.5f), (unsigned long)latency_percentile_ms(&st, 0.99f),
+            (unsigned long)st.no_motion, (unsigned long)st.superseded);
+        for (int b = 0; b < LAT_BUCKETS && n < sizeof(buf); b++) {
+            n += snprintf(buf + n, sizeof(buf) - n, "%s%lu", b ? "," : "", (unsigned long)st.buckets[b]);
+        }
+        if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n, "],\"stage_avg_us\":[");
+        for (int s = 0; s < LAT_STAGES && n < sizeof(buf); s++) {
+            uint32_t sa = st.samples ? (uint32_t)(st.stage_sum_us[s] / st.samples) : 0;
+            n += snprintf(buf + n, sizeof(buf) - n, "%s%lu", s ? "," : "", (unsigned long)sa);
+        }
+        if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n, "],\"stage_max_us\":[");
+        for (int s = 0; s < LAT_STAGES && n < sizeof(buf); s++) {
+            n += snprintf(buf + n, sizeof(buf) - n, "%s%lu", s ? "," : "", (unsigned long)st.stage_max_us[s]);
+        }
+        if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n, "]}");
+    }
+    if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n, "]}");
+    config_server.send(200, "application/json", buf);
+
+    if (config_server.arg("reset") == "1") latency_reset();
+}
@@ -0,0 +1,45 @@
+// Handler for the /log page: recent diagnostics records as plain text.
+// Optional ?since=<seq> returns only newer records; the next value to pass
+// is sent back in the X-Log-Next header.
+#include <Arduino.h>
+#include <WebServer.h>
+#include "diag_log.h"
+extern WebServer config_server;
+
+struct LogChunk {
+    char buf[1024];
+    size_t len;
+};
+
+static void flush_chunk(LogChunk *c) {
+    if (c->len == 0) return;
+    config_server.sendContent(c->buf, c->len);
+    c->len = 0;
+}
+
+static void append_line(const char *line, size_t len, void *ctx) {
+    LogChunk *c = (LogChunk *)ctx;
+    if (c->len + len > sizeof(c->buf)) flush_chunk(c);
+    memcpy(c->buf + c->len, line, len);
+    c->len += len;
+}
+
+void handle_log() {
+    uint32_t since = 0;
+    if (config_server.hasArg("since")) since = strtoul(config_server.arg("since").c_str(), NULL, 10);
+
+    // The header goes out before the body, so fix the range first: records
+    // committed while this response is sent wait for the next poll.
+    diag_log_stats_t st;
+    diag_log_get_stats(&st);
+    config_server.sendHeader("X-Log-Next", String(st.head));
+    config_server.sendHeader("Cache-Control", "no-store");
+    config_server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    config_server.send(200, "text/plain", "");
+
+    static LogChunk chunk;
+    chunk.len = 0;
+    diag_log_read(since, st.head, append_line, &chunk);
+    flush_chunk(&chunk);
+    config_server.sendContent("");
+}
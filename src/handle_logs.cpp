@@ -0,0 +1,171 @@
+// Handlers for /logs: engine data logger status and file list, and
+//   GET /logs/<name>.csv   the log converted to CSV while streaming
+//   GET /logs/<name>.edl   the raw file (format in engine_log_format.h)
+#include <Arduino.h>
+#include <WebServer.h>
+#include <FS.h>
+#include <SD_MMC.h>
+#include <time.h>
+#include "network_setup.h"
+#include "engine_log.h"
+#include "engine_log_format.h"
+#include "LVGL_Driver.h"
+extern WebServer config_server;
+
+// The export runs on the UI task; give LVGL a pass at least this often
+#define LOGS_UI_SLICE_MS 20
+
+static void send_logs_page() {
+    EngineLogStats st;
+    engine_log_get_stats(&st);
+
+    String html = "<html><head>";
+    html += STYLE;
+    html += "<title>Engine Data Log</title></head><body><div class='container'><div class='tab-content'>";
+    html += "<h2>Engine Data Log</h2>";
+    html += "<p>Every changed gauge value is logged to the SD card, one file per day. The CSV link converts a "
+            "file on the fly; times are UTC once a Signal K timestamp has been received.</p>";
+    html += "<form method='POST' action='/logs'>";
+    if (st.enabled) {
+        html += "<p>" + String(st.running ? "Logging to <b>" + String(st.file) + "</b>" : String("Waiting for data")) +
+                ": " + String(st.records) + " records in " + String(st.blocks) + " blocks, " + String(st.dropped) +
+                " dropped, " + String(st.write_errors) + " write errors, slowest write " + String(st.write_max_ms) +
+                " ms. Clock " + (st.clock_known ? "known" : "not known yet") + ".</p>";
+        html += "<input type='hidden' name='action' value='off'><input type='submit' value='Stop logging'>";
+    } else {
+        html += "<p>Logging is off.</p>";
+        html += "<input type='hidden' name='action' value='on'><input type='submit' value='Start logging'>";
+    }
+    html += "</form>";
+
+    html += "<h3>Files</h3><table class='file-table'><tr><th>File</th><th>Size</th><th></th></tr>";
+    File dir = SD_MMC.open("/logs");
+    if (dir && dir.isDirectory()) {
+        for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+            String name = f.name();
+            int slash = name.lastIndexOf('/');
+            if (slash >= 0) name = name.substring(slash + 1);
+            if (!name.endsWith(".edl")) {
+                f.close();
+                continue;
+            }
+            String base = name.substring(0, name.length() - 4);
+            html += "<tr><td>" + name + "</td><td class='file-size'>" + String((unsigned long)(f.size() / 1024)) +
+                    " KB</td><td><a href='/logs/" + base + ".csv'>CSV</a> <a href='/logs/" + name +
+                    "'>Raw</a></td></tr>";
+            f.close();
+        }
+    }
+    html += "</table><p><a href='/'>Back</a></p></div></div></body></html>";
+    config_server.send(200, "text/html", html);
+}
+
+void handle_logs() {
+    if (config_server.method() == HTTP_POST) {
+        engine_log_set_enabled(config_server.arg("action") == "on");
+        config_server.sendHeader("Location", "/logs", true);
+        config_server.send(302, "text/plain", "");
+        return;
+    }
+    send_logs_page();
+}
+
+struct CsvChunk {
+    char buf[1536];
+    size_t len;
+};
+
+static void flush_chunk(CsvChunk *c) {
+    if (c->len == 0) return;
+    config_server.sendContent(c->buf, c->len);
+    c->len = 0;
+}
+
+// One CSV line: uptime_ms,time_utc,slot,value
+static void append_record(CsvChunk *c, uint32_t t_ms, int32_t epoch_offset_s, int slot, float value) {
+    if (c->len + 96 > sizeof(c->buf)) flush_chunk(c);
+    char *p = c->buf + c->len;
+    size_t room = sizeof(c->buf) - c->len;
+    int n;
+    if (epoch_offset_s != 0) {
+        int64_t wall_ms = (int64_t)t_ms + (int64_t)epoch_offset_s * 1000;
+        time_t secs = (time_t)(wall_ms / 1000);
+        struct tm tm;
+        gmtime_r(&secs, &tm);
+        n = snprintf(p, room, "%lu,%04d-%02d-%02dT%02d:%02d:%02d.%03dZ,%d,%.7g\n", (unsigned long)t_ms,
+                     tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                     (int)(wall_ms % 1000), slot, value);
+    } else {
+        n = snprintf(p, room, "%lu,,%d,%.7g\n", (unsigned long)t_ms, slot, value);
+    }
+    if (n > 0 && (size_t)n < room) c->len += n;
+}
+
+static void stream_csv(File &f, const String &name) {
+    config_server.sendHeader("Content-Disposition", "attachment; filename=" + name);
+    config_server.sendHeader("Cache-Control", "no-store");
+    config_server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    config_server.send(200, "text/csv", "");
+
+    static uint8_t block[ELOG_BLOCK_SIZE];
+    static CsvChunk chunk;
+    chunk.len = 0;
+    const char header[] = "uptime_ms,time_utc,slot,value\n";
+    memcpy(chunk.buf, header, sizeof(header) - 1);
+    chunk.len = sizeof(header) - 1;
+
+    // Only whole blocks; the writer may be appending the next one
+    size_t blocks = f.size() / ELOG_BLOCK_SIZE;
+    uint32_t bad = 0;
+    uint32_t last_ui = millis();
+    for (size_t b = 0; b < blocks; b++) {
+        if (!config_server.client().connected()) break;
+        if (f.read(block, ELOG_BLOCK_SIZE) != ELOG_BLOCK_SIZE) break;
+        ElogBlockHeader h;
+        if (!elog_open_block(block, &h)) {
+            bad++;
+            continue;
+        }
+        for (uint16_t i = 0; i < h.count; i++) {
+            int slot;
+            uint32_t dt;
+            float value;
+            elog_get_record(block, i, &slot, &dt, &value);
+            append_record(&chunk, h.base_ms + dt, h.epoch_offset_s, slot, value);
+        }
+        if (millis() - last_ui >= LOGS_UI_SLICE_MS) {
+            Lvgl_Loop();
+            last_ui = millis();
+        }
+    }
+    flush_chunk(&chunk);
+    if (bad) {
+        char note[48];
+        int n = snprintf(note, sizeof(note), "# %lu damaged blocks skipped\n", (unsigned long)bad);
+        config_server.sendContent(note, n);
+    }
+    config_server.sendContent("");
+}
+
+void handle_logs_file() {
+    String name = config_server.pathArg(0);
+    // Plain file names inside /logs only
+    bool csv = name.endsWith(".csv");
+    if (name.length() == 0 || name.indexOf('/') >= 0 || name.indexOf("..") >= 0 || !(csv || name.endsWith(".edl"))) {
+        config_server.send(400, "text/plain", "Bad file name");
+        return;
+    }
+    String edl = csv ? name.substring(0, name.length() - 4) + ".edl" : name;
+    File f = SD_MMC.open("/logs/" + edl, FILE_READ);
+    if (!f) {
+        config_server.send(404, "text/plain", "Not found");
+        return;
+    }
+    if (csv) {
+        stream_csv(f, name);
+    } else {
+        config_server.sendHeader("Content-Disposition", "attachment; filename=" + name);
+        config_server.streamFile(f, "application/octet-stream");
+    }
+    f.close();
+}
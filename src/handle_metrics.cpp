@@ -0,0 +1,110 @@
+// Handler for the /metrics page: runtime counters as JSON
+#include <Arduino.h>
+#include <WebServer.h>
+#include "signalk_config.h"
+#include "nmea_ingest.h"
+#include "sensor_store.h"
+#include "derived_signals.h"
+#include "calibration_store.h"
+#include "diag_log.h"
+extern WebServer config_server;
+
+void handle_metrics() {
+    SignalKStats sk;
+    signalk_get_stats(&sk);
+    NmeaIngestStats nm;
+    nmea_ingest_get_stats(&nm);
+    diag_log_stats_t lg;
+    diag_log_get_stats(&lg);
+
+    static char buf[3200];
+    size_t n = 0;
+    n += snprintf(buf + n, sizeof(buf) - n,
+        "{\"uptime_ms\":%lu,"
+        "\"signalk\":{\"connected\":%s,\"unique_paths\":%u,"
+        "\"delta\":{\"messages\":%lu,\"values\":%lu,\"errors\":%lu,\"bytes\":%lu,\"unmatched\":%lu,\"dropped_busy\":%lu},"
+        "\"outbox\":{\"queued\":%u,\"enqueued\":%lu,\"coalesced\":%lu,\"dropped\":%lu,\"oversize\":%lu,\"sent\":%lu},",
+        millis(),
+        sk.connected ? "true" : "false", (unsigned)sk.unique_paths,
+        (unsigned long)sk.delta_messages, (unsigned long)sk.delta_values,
+        (unsigned long)sk.delta_errors, (unsigned long)sk.delta_bytes,
+        (unsigned long)sk.delta_unmatched, (unsigned long)sk.delta_dropped_busy,
+        (unsigned)sk.outbox_queued, (unsigned long)sk.outbox.enqueued,
+        (unsigned long)sk.outbox.coalesced, (unsigned long)sk.outbox.dropped,
+        (unsigned long)sk.outbox.oversize, (unsigned long)sk.outbox.sent);
+    if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n,
+        "\"conn\":{\"attempts\":%lu,\"connects\":%lu,\"connect_last_ms\":%lu,"
+        "\"ttfd_last_ms\":%lu,\"ttfd_min_ms\":%lu,\"ttfd_max_ms\":%lu,"
+        "\"plan_cached\":%s,\"plan_auth_required\":%s},"
+        "\"auth\":{\"has_token\":%s,\"busy\":%s,\"logins\":%lu,\"login_failures\":%lu,"
+        "\"unauthorized\":%lu,\"nvs_reused\":%lu,\"expires_in_s\":%ld},",
+        (unsigned long)sk.conn.attempts, (unsigned long)sk.conn.connects,
+        (unsigned long)sk.conn.connect_last_ms, (unsigned long)sk.conn.ttfd_last_ms,
+        (unsigned long)sk.conn.ttfd_min_ms, (unsigned long)sk.conn.ttfd_max_ms,
+        sk.plan_cached ? "true" : "false", sk.plan_auth_required ? "true" : "false",
+        sk.auth.has_token ? "true" : "false", sk.auth.busy ? "true" : "false",
+        (unsigned long)sk.auth.logins, (unsigned long)sk.auth.login_failures,
+        (unsigned long)sk.auth.unauthorized, (unsigned long)sk.auth.nvs_reused,
+        (long)sk.auth.expires_in_s);
+    if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n,
+        "\"rest\":{\"active\":%s,\"requests\":%lu,\"batched\":%lu,\"reused\":%lu,"
+        "\"values\":%lu,\"errors\":%lu,\"last_ms\":%lu,\"last_http\":%d},",
+        sk.rest_active ? "true" : "false", (unsigned long)sk.rest.requests,
+        (unsigned long)sk.rest.batched, (unsigned long)sk.rest.reused,
+        (unsigned long)sk.rest.values, (unsigned long)sk.rest.errors,
+        (unsigned long)sk.rest.last_ms, (int)sk.rest.last_http_code);
+    if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n,
+        "\"pump\":{\"wakeups\":%lu,\"socket\":%lu,\"notify\":%lu,\"timer\":%lu,"
+        "\"buffered\":%lu,\"select_errors\":%lu,\"awake_permille\":%u}},",
+        (unsigned long)sk.pump.wakeups, (unsigned long)sk.pump.socket_wakeups,
+        (unsigned long)sk.pump.notify_wakeups, (unsigned long)sk.pump.timer_wakeups,
+        (unsigned long)sk.pump.buffered_passes, (unsigned long)sk.pump.select_errors,
+        (unsigned)sk.pump_awake_permille);
+    if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n,
+        "\"nmea\":{\"running\":%s,\"connected\":%s,\"datagrams\":%lu,\"sentences\":%lu,"
+        "\"stored\":%lu,\"unmapped\":%lu,\"checksum_errors\":%lu,\"missing_checksum\":%lu,\"malformed\":%lu,"
+        "\"latency_avg_us\":%lu,\"latency_max_us\":%lu},",
+        nm.running ? "true" : "false", nm.connected ? "true" : "false",
+        (unsigned long)nm.datagrams, (unsigned long)nm.parse.sentences,
+        (unsigned long)nm.stored, (unsigned long)nm.unmapped,
+        (unsigned long)nm.parse.checksum_errors, (unsigned long)nm.parse.missing_checksum,
+        (unsigned long)nm.parse.malformed,
+        (unsigned long)nm.latency_avg_us, (unsigned long)nm.latency_max_us);
+    const SensorDirtyStats &ds = g_sensor_dirty_stats;
+    // Suppressed redraws per second since the previous /metrics request
+    static uint32_t prev_suppressed = 0, prev_ms = 0;
+    uint32_t now_ms = millis();
+    float suppressed_per_s = 0;
+    if (prev_ms != 0 && now_ms != prev_ms) {
+        suppressed_per_s = (ds.needle_suppressed - prev_suppressed) * 1000.0f / (now_ms - prev_ms);
+    }
+    prev_suppressed = ds.needle_suppressed;
+    prev_ms = now_ms;
+    if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n,
+        "\"ui\":{\"changed\":%lu,\"unchanged\":%lu,\"wakes\":%lu,\"needle_runs\":%lu,"
+        "\"needle_skips\":%lu,\"zone_evals\":%lu,\"zone_skips\":%lu,\"needle_anims\":%lu,"
+        "\"needle_suppressed\":%lu,\"suppressed_per_s\":%.2f},",
+        (unsigned long)ds.changed, (unsigned long)ds.unchanged, (unsigned long)ds.wakes,
+        (unsigned long)ds.needle_runs, (unsigned long)ds.needle_skips,
+        (unsigned long)ds.zone_evals, (unsigned long)ds.zone_skips,
+        (unsigned long)ds.needle_anims, (unsigned long)ds.needle_suppressed, suppressed_per_s);
+    DerivedStats dv;
+    derived_get_stats(&dv);
+    if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n,
+        "\"derived\":{\"triggers\":%lu,\"evals\":%lu,\"publishes\":%lu,\"pass_max_us\":%lu},",
+        (unsigned long)dv.triggers, (unsigned long)dv.evals, (unsigned long)dv.publishes,
+        (unsigned long)dv.pass_max_us);
+    CalStoreStats cs;
+    cal_store_get_stats(&cs);
+    if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n,
+        "\"calibration\":{\"source\":\"%s\",\"bytes\":%u,\"load_us\":%lu,\"migrate_us\":%lu,"
+        "\"legacy_reads\":%u,\"saves\":%lu,\"save_errors\":%lu,\"save_us\":%lu},",
+        cs.source == CAL_SOURCE_BLOB ? "blob" : (cs.source == CAL_SOURCE_LEGACY ? "migrated" : "none"),
+        (unsigned)cs.bytes, (unsigned long)cs.load_us, (unsigned long)cs.migrate_us,
+        (unsigned)cs.legacy_reads, (unsigned long)cs.saves, (unsigned long)cs.save_errors,
+        (unsigned long)cs.save_us);
+    if (n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n,
+        "\"log\":{\"written\":%lu,\"suppressed\":%lu,\"overwritten\":%lu}}",
+        (unsigned long)lg.written, (unsigned long)lg.suppressed, (unsigned long)lg.overwritten);
+    config_server.send(200, "application/json", buf);
+}
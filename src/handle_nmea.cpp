@@ -0,0 +1,78 @@
+// Handler for the /nmea page: NMEA 0183 source settings, slot mapping, stats
+#include <Arduino.h>
+#include <WebServer.h>
+#include "network_setup.h"
+#include "nmea_ingest.h"
+extern WebServer config_server;
+
+static void send_nmea_page() {
+    NmeaIngestConfig cfg;
+    nmea_ingest_load_config(&cfg);
+    NmeaIngestStats st;
+    nmea_ingest_get_stats(&st);
+
+    String html = "<html><head>";
+    html += STYLE;
+    html += "<title>NMEA 0183</title></head><body><div class='container'><div class='tab-content'>";
+    html += "<h2>NMEA 0183 Source</h2>";
+    html += "<p>Reads sentences from a WiFi multiplexer as well as (or instead of) Signal K. "
+            "Supported: XDR (key <code>XDR/&lt;name&gt;</code>), RPM (<code>RPM/E1</code>), "
+            "MTW, DPT, VHW. Values are converted to the units the gauges use (K, Pa, Hz, m/s).</p>";
+    html += "<form method='POST' action='/nmea'>";
+    html += "<div class='form-row'><label>Mode:</label><select name='mode'>";
+    html += "<option value='0'" + String(cfg.mode == NMEA_MODE_OFF ? " selected" : "") + ">Off</option>";
+    html += "<option value='1'" + String(cfg.mode == NMEA_MODE_UDP ? " selected" : "") + ">UDP listen</option>";
+    html += "<option value='2'" + String(cfg.mode == NMEA_MODE_TCP ? " selected" : "") + ">TCP client</option>";
+    html += "</select></div>";
+    html += "<div class='form-row'><label>Port:</label><input type='number' name='port' min='1' max='65535' value='" + String(cfg.port) + "'></div>";
+    html += "<div class='form-row'><label>TCP host:</label><input name='host' value='" + cfg.host + "'></div>";
+    html += "<div class='form-row'><label>No checksum:</label><input type='checkbox' name='nocsum' value='1'" +
+            String(cfg.allow_no_checksum ? " checked" : "") +
+            "> accept sentences without <code>*hh</code> (only for senders that omit it)</div>";
+    html += "<table class='file-table'><tr><th>Screen</th><th>Gauge</th><th>Sentence key</th></tr>";
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        html += "<tr><td>" + String(i / 2 + 1) + "</td><td>" + String(i % 2 == 0 ? "Top" : "Bottom") + "</td>";
+        html += "<td><input name='m" + String(i) + "' maxlength='" + String(NMEA_MAX_KEY - 1) +
+                "' placeholder='e.g. XDR/ENGT#1' value='" + cfg.keys[i] + "'></td></tr>";
+    }
+    html += "</table><p><input type='submit' value='Save'></p></form>";
+
+    html += "<h3>Status</h3><table class='file-table'>";
+    html += "<tr><td>Task</td><td>" + String(st.running ? (st.connected ? "running" : "running, not connected") : "stopped") + "</td></tr>";
+    html += "<tr><td>Datagrams / bytes</td><td>" + String(st.datagrams) + " / " + String(st.bytes) + "</td></tr>";
+    html += "<tr><td>Sentences</td><td>" + String(st.parse.sentences) + " (" + String(st.parse.unsupported) + " unsupported)</td></tr>";
+    html += "<tr><td>Values stored / unmapped</td><td>" + String(st.stored) + " / " + String(st.unmapped) + "</td></tr>";
+    html += "<tr><td>Checksum errors / missing / malformed / too long</td><td>" + String(st.parse.checksum_errors) +
+            " / " + String(st.parse.missing_checksum) + " / " + String(st.parse.malformed) + " / " +
+            String(st.parse.overflows) + "</td></tr>";
+    html += "<tr><td>Receive to store (us)</td><td>last " + String(st.latency_last_us) + ", avg " +
+            String(st.latency_avg_us) + ", max " + String(st.latency_max_us) + "</td></tr>";
+    html += "</table><p><a href='/'>Back</a></p></div></div></body></html>";
+    config_server.send(200, "text/html", html);
+}
+
+void handle_nmea() {
+    if (config_server.method() == HTTP_POST) {
+        NmeaIngestConfig cfg;
+        nmea_ingest_load_config(&cfg);
+        long mode = config_server.arg("mode").toInt();
+        cfg.mode = (mode >= NMEA_MODE_OFF && mode <= NMEA_MODE_TCP) ? (NmeaMode)mode : NMEA_MODE_OFF;
+        long port = config_server.arg("port").toInt();
+        cfg.port = (port > 0 && port <= 65535) ? (uint16_t)port : NMEA_DEFAULT_PORT;
+        cfg.host = config_server.arg("host");
+        cfg.host.trim();
+        cfg.allow_no_checksum = config_server.hasArg("nocsum");
+        for (int i = 0; i < TOTAL_PARAMS; i++) {
+            String key = "m" + String(i);
+            if (!config_server.hasArg(key)) continue;
+            cfg.keys[i] = config_server.arg(key);
+            cfg.keys[i].trim();
+        }
+        nmea_ingest_save_config(&cfg);
+        nmea_ingest_reload();
+        config_server.sendHeader("Location", "/nmea", true);
+        config_server.send(302, "text/plain", "");
+        return;
+    }
+    send_nmea_page();
+}
@@ -0,0 +1,78 @@
+// Handlers for /record: start/stop Signal K stream recordings and download
+// them for replay with scripts/sk_replay.cpp
+#include <Arduino.h>
+#include <WebServer.h>
+#include <FS.h>
+#include <SD_MMC.h>
+#include "network_setup.h"
+#include "signalk_recorder.h"
+extern WebServer config_server;
+
+static void send_record_page() {
+    SkRecStats st;
+    sk_rec_get_stats(&st);
+
+    String html = "<html><head>";
+    html += STYLE;
+    html += "<title>Signal K Recording</title></head><body><div class='container'><div class='tab-content'>";
+    html += "<h2>Signal K Recording</h2>";
+    html += "<p>Records the raw WebSocket frames with their receive time. Replay a download on a PC with "
+            "<code>scripts/sk_replay.cpp</code>.</p>";
+    html += "<form method='POST' action='/record'>";
+    if (st.recording) {
+        html += "<p>Recording to <b>" + String(st.file) + "</b>: " + String(st.frames) + " frames, " +
+                String(st.bytes / 1024) + " KB, " + String(st.dropped) + " dropped</p>";
+        html += "<input type='hidden' name='action' value='stop'><input type='submit' value='Stop'>";
+    } else {
+        if (st.file[0] != '\0') {
+            html += "<p>Last: " + String(st.file) + ", " + String(st.frames) + " frames, " +
+                    String(st.bytes / 1024) + " KB, " + String(st.dropped) + " dropped</p>";
+        }
+        html += "<input type='hidden' name='action' value='start'><input type='submit' value='Start recording'>";
+    }
+    html += "</form>";
+
+    html += "<h3>Recordings</h3><table class='file-table'><tr><th>File</th><th>Size</th><th></th></tr>";
+    File dir = SD_MMC.open("/recordings");
+    if (dir && dir.isDirectory()) {
+        for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+            String name = f.name();
+            int slash = name.lastIndexOf('/');
+            if (slash >= 0) name = name.substring(slash + 1);
+            html += "<tr><td>" + name + "</td><td class='file-size'>" + String((unsigned long)(f.size() / 1024)) +
+                    " KB</td><td><a href='/record/download?file=" + name + "'>Download</a></td></tr>";
+            f.close();
+        }
+    }
+    html += "</table><p><a href='/'>Back</a></p></div></div></body></html>";
+    config_server.send(200, "text/html", html);
+}
+
+void handle_record() {
+    if (config_server.method() == HTTP_POST) {
+        String action = config_server.arg("action");
+        if (action == "start") sk_rec_start();
+        else if (action == "stop") sk_rec_stop();
+        config_server.sendHeader("Location", "/record", true);
+        config_server.send(302, "text/plain", "");
+        return;
+    }
+    send_record_page();
+}
+
+void handle_record_download() {
+    String name = config_server.arg("file");
+    // Plain file names inside /recordings only
+    if (name.length() == 0 || name.indexOf('/') >= 0 || name.indexOf("..") >= 0 || !name.endsWith(".skr")) {
+        config_server.send(400, "text/plain", "Bad file name");
+        return;
+    }
+    File f = SD_MMC.open("/recordings/" + name, FILE_READ);
+    if (!f) {
+        config_server.send(404, "text/plain", "Not found");
+        return;
+    }
+    config_server.sendHeader("Content-Disposition", "attachment; filename=" + name);
+    config_server.streamFile(f, "application/octet-stream");
+    f.close();
+}
@@ -0,0 +1,53 @@
+// Handler for the /staleness page: per-slot freshness and stale timeouts
+#include <Arduino.h>
+#include <WebServer.h>
+#include "network_setup.h"
+#include "sensor_store.h"
+#include "sensor_staleness.h"
+extern WebServer config_server;
+
+static void send_staleness_page() {
+    uint32_t now = millis();
+    String html;
+    html.reserve(4096);
+    html += "<html><head>";
+    html += STYLE;
+    html += "<title>Sensor Staleness</title></head><body><div class='container'><div class='tab-content'>";
+    html += "<h2>Sensor Staleness</h2><form method='POST' action='/staleness'><table class='file-table'>"
+            "<tr><th>Screen</th><th>Gauge</th><th>Path</th><th>State</th><th>Last update</th>"
+            "<th>$source</th><th>Timeout (s, 0=off)</th></tr>";
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        SensorSample smp;
+        get_sensor_sample(i, &smp);
+        String path = get_signalk_path_by_index(i);
+        bool stale = sensor_is_stale(i);
+        html += "<tr><td>" + String(i / 2 + 1) + "</td><td>" + String(i % 2 == 0 ? "Top" : "Bottom") + "</td><td>";
+        html += path.length() ? path : String("(none)");
+        html += "</td><td>" + String(stale ? "<b style='color:#b00'>stale</b>" : "live") + "</td><td>";
+        if (smp.rx_ms) html += String((now - smp.rx_ms) / 1000.0f, 1) + " s ago";
+        else html += "never";
+        html += "</td><td>" + String(smp.source) + "</td><td><input type='number' min='0' max='3600' name='t" + String(i) +
+                "' value='" + String(staleness_get_timeout_s(i)) + "'></td></tr>";
+    }
+    html += "</table><p><input type='submit' value='Save'></p></form>"
+            "<p><a href='/'>Back</a></p></div></div></body></html>";
+    config_server.send(200, "text/html", html);
+}
+
+void handle_staleness() {
+    if (config_server.method() == HTTP_POST) {
+        for (int i = 0; i < TOTAL_PARAMS; i++) {
+            String key = "t" + String(i);
+            if (!config_server.hasArg(key)) continue;
+            long v = config_server.arg(key).toInt();
+            if (v < 0) v = 0;
+            if (v > 3600) v = 3600;
+            if ((uint16_t)v != staleness_get_timeout_s(i)) staleness_set_timeout_s(i, (uint16_t)v);
+        }
+        staleness_init();
+        config_server.sendHeader("Location", "/staleness", true);
+        config_server.send(302, "text/plain", "");
+        return;
+    }
+    send_staleness_page();
+}
@@ -0,0 +1,127 @@
+#include "latency_probe.h"
+#include "signalk_config.h"   // TOTAL_PARAMS
+#include <Arduino.h>
+#include <string.h>
+
+// One value on its way to the glass
+struct LatencyTrack {
+    uint32_t rx_us;
+    uint32_t consume_us;
+    uint32_t draw_us;
+    uint32_t flush_us;
+};
+
+volatile uint32_t g_latency_flushed_mask = 0;
+volatile uint32_t g_latency_photon_mask = 0;
+volatile uint32_t g_latency_photon_us[TOTAL_PARAMS];
+
+// UI task only
+static LatencyTrack pending[TOTAL_PARAMS];     // consumed, not yet flushed
+static LatencyTrack inflight[TOTAL_PARAMS];    // flushed, waiting for vsync
+static uint32_t consumed_mask = 0;             // waiting for the first animation step
+static uint32_t drawn_mask = 0;                // drawn, waiting for the flush
+static uint32_t last_rx_us[TOTAL_PARAMS];      // last stamp consumed per slot
+static LatencySlotStats slot_stats[TOTAL_PARAMS];
+
+static int bucket_for(uint32_t us) {
+    uint32_t ms = us / 1000;
+    if (ms == 0) return 0;
+    int b = 32 - __builtin_clz(ms);
+    return b < LAT_BUCKETS ? b : LAT_BUCKETS - 1;
+}
+
+static void add_stage(LatencySlotStats &st, int stage, uint32_t us) {
+    st.stage_sum_us[stage] += us;
+    if (us > st.stage_max_us[stage]) st.stage_max_us[stage] = us;
+}
+
+void latency_note_consumed(int slot, uint32_t rx_us, bool moved) {
+    if (slot < 0 || slot >= TOTAL_PARAMS || rx_us == 0 || rx_us == last_rx_us[slot]) return;
+    last_rx_us[slot] = rx_us;
+    uint32_t bit = 1u << slot;
+    if (!moved) {
+        slot_stats[slot].no_motion++;
+        return;
+    }
+    if ((consumed_mask | drawn_mask) & bit) slot_stats[slot].superseded++;
+    pending[slot].rx_us = rx_us;
+    pending[slot].consume_us = micros();
+    drawn_mask &= ~bit;
+    consumed_mask |= bit;
+}
+
+void latency_note_drawn(int slot) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) return;
+    uint32_t bit = 1u << slot;
+    if ((consumed_mask & bit) == 0) return;
+    pending[slot].draw_us = micros();
+    consumed_mask &= ~bit;
+    drawn_mask |= bit;
+}
+
+void latency_note_flush(bool last) {
+    if (!last || drawn_mask == 0) return;
+    uint32_t now = micros();
+    uint32_t m = drawn_mask;
+    drawn_mask = 0;
+    // Take these slots away from the ISR first: a frame still waiting for
+    // its vsync is replaced by this one, and anything the ISR already
+    // completed is folded before inflight[] is overwritten.
+    uint32_t replaced = __atomic_fetch_and(&g_latency_flushed_mask, ~m, __ATOMIC_ACQ_REL) & m;
+    latency_service();
+    for (uint32_t left = m; left; left &= left - 1) {
+        int i = __builtin_ctz(left);
+        if (replaced & (1u << i)) slot_stats[i].superseded++;
+        inflight[i] = pending[i];
+        inflight[i].flush_us = now;
+    }
+    __atomic_fetch_or(&g_latency_flushed_mask, m, __ATOMIC_RELEASE);
+}
+
+void latency_service() {
+    uint32_t m = __atomic_exchange_n(&g_latency_photon_mask, 0, __ATOMIC_ACQUIRE);
+    while (m) {
+        int i = __builtin_ctz(m);
+        m &= m - 1;
+        const LatencyTrack &t = inflight[i];
+        uint32_t photon_us = g_latency_photon_us[i];
+        uint32_t total = photon_us - t.rx_us;
+        LatencySlotStats &st = slot_stats[i];
+        st.samples++;
+        st.buckets[bucket_for(total)]++;
+        st.total_sum_us += total;
+        if (total > st.total_max_us) st.total_max_us = total;
+        add_stage(st, 0, t.consume_us - t.rx_us);
+        add_stage(st, 1, t.draw_us - t.consume_us);
+        add_stage(st, 2, t.flush_us - t.draw_us);
+        add_stage(st, 3, photon_us - t.flush_us);
+    }
+}
+
+void latency_get_slot(int slot, LatencySlotStats *out) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = slot_stats[slot];
+}
+
+void latency_reset() {
+    // Drop samples still in flight too, so none straddles the reset
+    __atomic_store_n(&g_latency_flushed_mask, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_latency_photon_mask, 0, __ATOMIC_RELAXED);
+    consumed_mask = 0;
+    drawn_mask = 0;
+    memset(slot_stats, 0, sizeof(slot_stats));
+}
+
+uint32_t latency_percentile_ms(const LatencySlotStats *st, float p) {
+    if (st->samples == 0) return 0;
+    uint32_t target = (uint32_t)(p * (st->samples - 1)) + 1;
+    uint32_t seen = 0;
+    for (int b = 0; b < LAT_BUCKETS - 1; b++) {
+        seen += st->buckets[b];
+        if (seen >= target) return 1u << b;
+    }
+    return (st->total_max_us + 999) / 1000;
+}
@@ -0,0 +1,75 @@
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H
+
+#include <stdint.h>
+
+// Ingest-to-photon latency per slot.
+//
+// A value is followed through five stamps (all micros()):
+//   rx      - frame received (wsEvent / REST poll / NMEA read), carried in
+//             the sensor store with the value
+//   consume - update_needles_for_screen() picked the value up and started a
+//             needle animation
+//   draw    - the first animation step moved the needle's line points
+//   flush   - Lvgl_Display_LCD() finished the last area of that refresh
+//   photon  - the next panel vsync, when the new frame starts scanning out
+//
+// Only values that move a needle produce a sample; a value that maps to the
+// angle already shown is counted as no_motion. A value replaced by a newer
+// one before it reached the glass is counted as superseded.
+//
+// consume/draw/flush and the HTTP handler run on the UI task. The vsync
+// interrupt only swaps a mask and stamps the slots it completes;
+// latency_service() folds them into the histograms on the UI task.
+
+#define LAT_STAGES  4    // rx->consume, consume->draw, draw->flush, flush->photon
+#define LAT_BUCKETS 12   // <1 ms, then [2^(i-1), 2^i) ms, last bucket >= 1024 ms
+
+struct LatencySlotStats {
+    uint32_t samples;
+    uint32_t buckets[LAT_BUCKETS];     // rx -> photon
+    uint64_t total_sum_us;
+    uint32_t total_max_us;
+    uint64_t stage_sum_us[LAT_STAGES];
+    uint32_t stage_max_us[LAT_STAGES];
+    uint32_t no_motion;
+    uint32_t superseded;
+};
+
+extern volatile uint32_t g_latency_flushed_mask;   // flushed, waiting for vsync
+extern volatile uint32_t g_latency_photon_mask;    // reached vsync, not yet folded
+extern volatile uint32_t g_latency_photon_us[];
+
+// Called from the vsync ISR with its esp_timer_get_time() stamp.
+static inline void latency_on_vsync(uint32_t now_us) {
+    uint32_t m = __atomic_exchange_n(&g_latency_flushed_mask, 0, __ATOMIC_ACQUIRE);
+    if (m == 0) return;
+    uint32_t left = m;
+    while (left) {
+        int i = __builtin_ctz(left);
+        left &= left - 1;
+        g_latency_photon_us[i] = now_us;
+    }
+    __atomic_fetch_or(&g_latency_photon_mask, m, __ATOMIC_RELEASE);
+}
+
+// UI task: `slot`'s value with receive stamp rx_us was applied to its
+// needle; `moved` is false when the needle target did not change.
+void latency_note_consumed(int slot, uint32_t rx_us, bool moved);
+
+// UI task: the needle of `slot` got new line points (animation step).
+void latency_note_drawn(int slot);
+
+// UI task, from the flush callback; `last` = last area of this refresh.
+void latency_note_flush(bool last);
+
+// UI task: fold completed samples into the histograms.
+void latency_service();
+
+void latency_get_slot(int slot, LatencySlotStats *out);
+void latency_reset();
+
+// Upper bound (ms) of the bucket holding the p-quantile (0..1); 0 = no data.
+uint32_t latency_percentile_ms(const LatencySlotStats *st, float p);
+
+#endif // LATENCY_PROBE_H
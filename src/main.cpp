@@ -11,6 +11,18 @@ bool test_mode = false;
 #include "ui.h"
 #include "ui_Settings.h"
 #include "signalk_config.h"
+#include "sensor_store.h"
+#include "sensor_staleness.h"
+#include "sensor_filter.h"
+#include "sensor_history.h"
+#include "engine_log.h"
+#include "derived_signals.h"
+#include "engine_counters.h"
+#include "nmea_ingest.h"
+#include "latency_probe.h"
+#define DIAG_TAG "main"
+#define DIAG_MODULE_LEVEL DIAG_LEVEL_MAIN
+#include "diag_log.h"
 #include "screen_config_c_api.h"
 #include "network_setup.h"
 #include "gauge_config.h"
@@ -58,7 +70,7 @@ static void needle_anim_cb(void * var, int32_t v) {
         else if (needle == ui_Needle4) { screen = 3; gauge = 0; }
         else if (needle == ui_Needle5) { screen = 4; gauge = 0; }
 
-        NeedleStyle s = get_needle_style(screen, gauge);
+        const NeedleGeometry &s = get_needle_geometry(screen, gauge);
         float rad = (v - 90) * PI / 180.0f;
         static lv_point_t points[2];
         points[0].x = s.cx + (int16_t)(s.inner * cos(rad));
@@ -66,6 +78,7 @@ static void needle_anim_cb(void * var, int32_t v) {
         points[1].x = s.cx + (int16_t)(s.outer * cos(rad));
         points[1].y = s.cy + (int16_t)(s.outer * sin(rad));
         lv_line_set_points(needle, points, 2);
+        latency_note_drawn(screen * 2 + gauge);
     }
 }
 
@@ -81,7 +94,7 @@ static void lower_needle_anim_cb(void * var, int32_t v) {
         else if (needle == ui_Lower_Needle4) { screen = 3; gauge = 1; }
         else if (needle == ui_Lower_Needle5) { screen = 4; gauge = 1; }
 
-        NeedleStyle s = get_needle_style(screen, gauge);
+        const NeedleGeometry &s = get_needle_geometry(screen, gauge);
         float rad = (v - 90) * PI / 180.0f;
         static lv_point_t points[2];
         points[0].x = s.cx + (int16_t)(s.inner * cos(rad));
@@ -89,6 +102,7 @@ static void lower_needle_anim_cb(void * var, int32_t v) {
         points[1].x = s.cx + (int16_t)(s.outer * cos(rad));
         points[1].y = s.cy + (int16_t)(s.outer * sin(rad));
         lv_line_set_points(needle, points, 2);
+        latency_note_drawn(screen * 2 + gauge);
     }
 }
 
@@ -152,14 +166,73 @@ int16_t value_to_angle_for_param(float value, int screen, int gauge) {
     return angle;
 }
 
-// Generic needle animation helper that caches the last angle per needle
-static void animate_generic_needle(lv_obj_t* needle, int16_t &last_angle, int16_t new_angle, bool is_lower) {
+// Redraw suppression in terms of how far the needle tip actually moves.
+// A move that keeps going the same way must shift the tip by at least
+// NEEDLE_MIN_TIP_PX; one that reverses direction needs NEEDLE_REVERSE_TIP_PX,
+// so a value dithering between two adjacent angles leaves the needle (and
+// the background under it) alone. On a short needle 4 px is several
+// degrees, so a reversal of NEEDLE_REVERSE_MAX_DEG or more always moves.
+//
+// A suppressed target is not dropped: the slot stays unsettled, and once it
+// has been held back for NEEDLE_SETTLE_MS the next tick moves the needle to
+// the current angle whatever the distance. A steady value therefore always
+// ends at its true angle, and a dithering one costs one small redraw per
+// settle period instead of one per tick.
+static const float NEEDLE_MIN_TIP_PX = 1.0f;
+static const float NEEDLE_REVERSE_TIP_PX = 4.0f;
+static const int NEEDLE_REVERSE_MAX_DEG = 2;
+static const uint32_t NEEDLE_SETTLE_MS = 500;
+static int8_t last_needle_dir[NUM_SCREENS][2];   // -1, 0 (none yet), +1
+static uint32_t needle_unsettled = 0;            // slots holding back a suppressed move
+static uint32_t needle_settle_at[TOTAL_PARAMS];  // when each of those moves anyway
+
+// Unsettled slots in `mask` whose settle time has come
+static uint32_t needle_settle_due(uint32_t mask, uint32_t now_ms) {
+    uint32_t due = 0;
+    for (uint32_t m = needle_unsettled & mask; m; m &= m - 1) {
+        int slot = __builtin_ctz(m);
+        if ((int32_t)(now_ms - needle_settle_at[slot]) >= 0) due |= 1u << slot;
+    }
+    return due;
+}
+
+// Chord the tip of a needle of radius `outer` travels for a `delta_deg` turn
+static float needle_tip_travel_px(int16_t outer, int delta_deg) {
+    return 2.0f * fabsf((float)outer) * fabsf(sinf(delta_deg * (PI / 360.0f)));
+}
+
+// Generic needle animation helper that caches the last angle per needle.
+// Returns true when an animation was started. Moves the tip would not
+// visibly make (see NEEDLE_MIN_TIP_PX) start nothing and are counted until
+// the slot's settle time comes.
+static bool animate_generic_needle(lv_obj_t* needle, int16_t &last_angle, int16_t new_angle, bool is_lower,
+                                   int screen, int gauge) {
     if (needle == NULL) {
-        return;
+        return false;
     }
+    uint32_t slot_bit = 1u << (screen * 2 + gauge);
     if (new_angle == last_angle) {
-        return;
+        needle_unsettled &= ~slot_bit;
+        return false;
+    }
+    int delta = new_angle - last_angle;
+    int8_t dir = delta > 0 ? 1 : -1;
+    float travel = needle_tip_travel_px(get_needle_geometry(screen, gauge).outer, delta);
+    int8_t &prev_dir = last_needle_dir[screen][gauge];
+    bool reversing = prev_dir != 0 && dir != prev_dir;
+    float needed = reversing ? NEEDLE_REVERSE_TIP_PX : NEEDLE_MIN_TIP_PX;
+    if (reversing && abs(delta) >= NEEDLE_REVERSE_MAX_DEG) needed = NEEDLE_MIN_TIP_PX;
+    if (travel < needed && !needle_settle_due(slot_bit, millis())) {
+        if (!(needle_unsettled & slot_bit)) {
+            needle_unsettled |= slot_bit;
+            needle_settle_at[screen * 2 + gauge] = millis() + NEEDLE_SETTLE_MS;
+        }
+        g_sensor_dirty_stats.needle_suppressed++;
+        return false;
     }
+    needle_unsettled &= ~slot_bit;
+    prev_dir = dir;
+    g_sensor_dirty_stats.needle_anims++;
 
     lv_anim_t a;
     lv_anim_init(&a);
@@ -173,6 +246,7 @@ static void animate_generic_needle(lv_obj_t* needle, int16_t &last_angle, int16_
     
 
     last_angle = new_angle;
+    return true;
 }
 
 // Initialize all needle positions to defaults: top needles at 0°, bottom needles at 180°
@@ -213,13 +287,15 @@ extern "C" void update_needles_for_screen(int screen_num) {
     ParamType bottom_type = PARAM_COOLANT_TEMP;
     float top_value = 0.0f;
     float bottom_value = 0.0f;
+    uint32_t top_rx_us = 0;      // receive stamps, for the latency probe
+    uint32_t bottom_rx_us = 0;
 
     switch (screen_num) {
         case 1:  // RPM + Coolant Temp
             top_needle = ui_Needle;
             bottom_needle = ui_Lower_Needle;
-            top_value = get_sensor_value(SCREEN1_RPM);
-            bottom_value = get_sensor_value(SCREEN1_COOLANT_TEMP);
+            top_value = get_sensor_value_stamped(SCREEN1_RPM, &top_rx_us);
+            bottom_value = get_sensor_value_stamped(SCREEN1_COOLANT_TEMP, &bottom_rx_us);
             top_type = PARAM_RPM;
             bottom_type = PARAM_COOLANT_TEMP;
             // Debug output disabled for performance
@@ -227,32 +303,32 @@ extern "C" void update_needles_for_screen(int screen_num) {
         case 2:  // RPM + Fuel
             top_needle = ui_Needle2;
             bottom_needle = ui_Lower_Needle2;
-            top_value = get_sensor_value(SCREEN2_RPM);
-            bottom_value = get_sensor_value(SCREEN2_FUEL);
+            top_value = get_sensor_value_stamped(SCREEN2_RPM, &top_rx_us);
+            bottom_value = get_sensor_value_stamped(SCREEN2_FUEL, &bottom_rx_us);
             top_type = PARAM_RPM;
             bottom_type = PARAM_FUEL;
             break;
         case 3:  // Coolant Temp + Exhaust Temp
             top_needle = ui_Needle3;
             bottom_needle = ui_Lower_Needle3;
-            top_value = get_sensor_value(SCREEN3_COOLANT_TEMP);
-            bottom_value = get_sensor_value(SCREEN3_EXHAUST_TEMP);
+            top_value = get_sensor_value_stamped(SCREEN3_COOLANT_TEMP, &top_rx_us);
+            bottom_value = get_sensor_value_stamped(SCREEN3_EXHAUST_TEMP, &bottom_rx_us);
             top_type = PARAM_COOLANT_TEMP;
             bottom_type = PARAM_EXHAUST_TEMP;
             break;
         case 4:  // Fuel + Coolant Temp
             top_needle = ui_Needle4;
             bottom_needle = ui_Lower_Needle4;
-            top_value = get_sensor_value(SCREEN4_FUEL);
-            bottom_value = get_sensor_value(SCREEN4_COOLANT_TEMP);
+            top_value = get_sensor_value_stamped(SCREEN4_FUEL, &top_rx_us);
+            bottom_value = get_sensor_value_stamped(SCREEN4_COOLANT_TEMP, &bottom_rx_us);
             top_type = PARAM_FUEL;
             bottom_type = PARAM_COOLANT_TEMP;
             break;
         case 5:  // Oil Pressure + Coolant Temp
             top_needle = ui_Needle5;
             bottom_needle = ui_Lower_Needle5;
-            top_value = get_sensor_value(SCREEN5_OIL_PRESSURE);
-            bottom_value = get_sensor_value(SCREEN5_COOLANT_TEMP);
+            top_value = get_sensor_value_stamped(SCREEN5_OIL_PRESSURE, &top_rx_us);
+            bottom_value = get_sensor_value_stamped(SCREEN5_COOLANT_TEMP, &bottom_rx_us);
             top_type = PARAM_OIL_PRESSURE;
             bottom_type = PARAM_COOLANT_TEMP;
             break;
@@ -262,6 +338,7 @@ extern "C" void update_needles_for_screen(int screen_num) {
 
     // Set defaults on first run, then use sensor data or keep defaults if no valid data
     int16_t top_angle, bottom_angle;
+    bool live = initialized[screen_num];
     
     if (!initialized[screen_num]) {
         // First run: set to defaults
@@ -289,8 +366,13 @@ extern "C" void update_needles_for_screen(int screen_num) {
 
     // Reduced debug output for production build
 
-    animate_generic_needle(top_needle, last_top_angle[screen_num], top_angle, false);
-    animate_generic_needle(bottom_needle, last_bottom_angle[screen_num], bottom_angle, true);
+    bool top_moved = animate_generic_needle(top_needle, last_top_angle[screen_num], top_angle, false, screen_num - 1, 0);
+    bool bottom_moved = animate_generic_needle(bottom_needle, last_bottom_angle[screen_num], bottom_angle, true, screen_num - 1, 1);
+    int slot0 = (screen_num - 1) * 2;
+    if (live) {
+        if (!isnan(top_value)) latency_note_consumed(slot0, top_rx_us, top_moved);
+        if (!isnan(bottom_value)) latency_note_consumed(slot0 + 1, bottom_rx_us, bottom_moved);
+    }
 
     // Update dynamic icon recoloring for this screen/gauges based on current values
     lv_obj_t* top_icon = NULL;
@@ -321,8 +403,9 @@ extern "C" void update_needles_for_screen(int screen_num) {
             break;
     }
 
-    if (top_icon) _ui_apply_icon_style(top_icon, screen_num - 1, 0);
-    if (bottom_icon) _ui_apply_icon_style(bottom_icon, screen_num - 1, 1);
+    // Stale gauges keep their icon hidden (see apply_stale_transitions)
+    if (top_icon && !sensor_is_stale(slot0)) _ui_apply_icon_style(top_icon, screen_num - 1, 0);
+    if (bottom_icon && !sensor_is_stale(slot0 + 1)) _ui_apply_icon_style(bottom_icon, screen_num - 1, 1);
 }
 
 // Move the specified gauge (top/bottom) on a given screen to the specified angle for testing
@@ -373,12 +456,109 @@ void test_move_gauge(int screen, int gauge, int angle) {
     }
 }
 
+// Slots that can trigger the buzzer while their screen is hidden (global
+// buzzer mode only; per-screen mode just watches the visible screen).
+static uint32_t alarm_slot_mask() {
+    if (buzzer_mode != 1) return 0;
+    uint32_t mask = 0;
+    for (int s = 0; s < NUM_SCREENS; ++s) {
+        for (int g = 0; g < 2; ++g) {
+            for (int z = 1; z <= 4; ++z) {
+                if (screen_configs[s].buzzer[g][z] != 0) { mask |= 1u << (s * 2 + g); break; }
+            }
+        }
+    }
+    return mask;
+}
+
+// Zone (1..4) of a gauge for `val`. The most specific matching zone (smallest
+// range) wins so narrow alert zones win when ranges overlap. With no numeric
+// match and a NaN value the first configured zone is used; otherwise zone 1.
+static int choose_zone(int s, int g, float val) {
+    int chosen_zone = -1;
+    float best_range = 1e30f;
+    for (int z = 1; z <= 4; ++z) {
+        float mn = screen_configs[s].min[g][z];
+        float mx = screen_configs[s].max[g][z];
+        if (mn == mx) continue;
+        if (!isnan(val) && val >= mn && val <= mx) {
+            float range = mx - mn;
+            if (range < best_range) { best_range = range; chosen_zone = z; }
+        }
+    }
+    if (chosen_zone == -1 && isnan(val)) {
+        for (int z = 1; z <= 4; ++z) {
+            float mn = screen_configs[s].min[g][z];
+            float mx = screen_configs[s].max[g][z];
+            if (mn != mx) { chosen_zone = z; break; }
+        }
+    }
+    if (chosen_zone == -1) chosen_zone = 1;
+    return chosen_zone;
+}
+
+// Change-driven UI state. loop() takes the sensor store's dirty bits once per
+// pass; needles and zones keep their own pending sets because they consume
+// them at different times (needles on the 100 ms tick, zones every pass).
+static uint32_t needle_pending = 0;
+static uint32_t zone_pending = 0;
+static int8_t slot_zone[TOTAL_PARAMS] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+
+// Slot -> needle / icon objects (slot = (screen-1)*2 + gauge)
+static lv_obj_t* needle_for_slot(int slot) {
+    switch (slot) {
+        case 0: return ui_Needle;   case 1: return ui_Lower_Needle;
+        case 2: return ui_Needle2;  case 3: return ui_Lower_Needle2;
+        case 4: return ui_Needle3;  case 5: return ui_Lower_Needle3;
+        case 6: return ui_Needle4;  case 7: return ui_Lower_Needle4;
+        case 8: return ui_Needle5;  case 9: return ui_Lower_Needle5;
+        default: return NULL;
+    }
+}
+
+static lv_obj_t* icon_for_slot(int slot) {
+    switch (slot) {
+        case 0: return ui_TopIcon1; case 1: return ui_BottomIcon1;
+        case 2: return ui_TopIcon2; case 3: return ui_BottomIcon2;
+        case 4: return ui_TopIcon3; case 5: return ui_BottomIcon3;
+        case 6: return ui_TopIcon4; case 7: return ui_BottomIcon4;
+        case 8: return ui_TopIcon5; case 9: return ui_BottomIcon5;
+        default: return NULL;
+    }
+}
+
+// Apply stale/live transitions reported by the staleness engine: stale
+// gauges get a dimmed needle and a hidden icon. Only slots whose state
+// changed are touched.
+static void apply_stale_transitions() {
+    uint32_t changed = staleness_service(millis());
+    while (changed) {
+        int slot = __builtin_ctz(changed);
+        changed &= changed - 1;
+        bool stale = sensor_is_stale(slot);
+        lv_obj_t* needle = needle_for_slot(slot);
+        if (needle) lv_obj_set_style_line_opa(needle, stale ? LV_OPA_40 : LV_OPA_COVER, 0);
+        lv_obj_t* icon = icon_for_slot(slot);
+        if (icon) {
+            if (stale) {
+                lv_obj_add_flag(icon, LV_OBJ_FLAG_HIDDEN);
+            } else {
+                // Restore visibility; the style pass re-hides unconfigured icons
+                lv_obj_clear_flag(icon, LV_OBJ_FLAG_HIDDEN);
+                _ui_apply_icon_style(icon, slot / 2, slot % 2);
+            }
+        }
+        DIAG_I("slot %d is %s", slot, stale ? "stale" : "live again");
+    }
+}
+
 void setup() {
         // test_nvs_minimal() removed during cleanup
     // Serial for debugging - with timeout
     Serial.setTxTimeoutMs(0);  // Non-blocking serial
     Serial.begin(115200);
     delay(500);
+    diag_log_init();
     
     Serial.println("\n\n=== ESP32 Round Display Starting ===");
     Serial.flush();
@@ -442,8 +622,16 @@ void setup() {
         set_auto_scroll_interval(auto_scroll_sec);
     }
     
-    // Initialize sensor mutex for thread-safe access
-    init_sensor_mutex();
+    // Seed the lock-free sensor store with its power-on defaults; new
+    // values wake this task early from its idle delay
+    init_sensor_store();
+    sensor_store_set_notify_task(xTaskGetCurrentTaskHandle());
+    staleness_init();
+    sensor_filter_init();
+    sensor_history_init();
+    derived_init();
+    engine_log_start();
+    counters_init();
     
     // Enable WiFi with optimizations
     Serial.println("Starting WiFi setup...");
@@ -470,6 +658,11 @@ void setup() {
         Serial.println("Connect to web UI to configure Signal K server");
         Serial.flush();
     }
+
+    // NMEA 0183 multiplexer input (UDP/TCP), if configured
+    if (is_wifi_connected()) {
+        nmea_ingest_start();
+    }
     
     Serial.println("Display initialized with WiFi optimizations.");
     Serial.print("WiFi SSID: ");
@@ -482,6 +675,12 @@ void setup() {
 
 void loop() {
     config_server.handleClient();
+    apply_stale_transitions();
+    latency_service();
+    counters_service(millis());
+    uint32_t dirty = sensor_take_dirty();
+    needle_pending |= dirty;
+    zone_pending |= dirty;
     // Use Signal K data instead of demo animation
     static int16_t needle_angle = 0;
     static int16_t lower_needle_angle = 0;
@@ -490,14 +689,17 @@ void loop() {
     // Switch to Signal K mode
     static bool use_demo_mode = false;
     
+    // Needles were not driven by live data while paused; redraw on resume
+    static bool was_paused = false;
+    bool paused = gauge_is_setup_mode() || test_mode;
+    if (was_paused && !paused) needle_pending = ~0u;
+    was_paused = paused;
+
     // Check if in setup mode - use preview angles instead of Signal K data
     if (gauge_is_setup_mode()) {
         int16_t top_angle = gauge_get_preview_top_angle();
         int16_t bottom_angle = gauge_get_preview_bottom_angle();
-        Serial.print("[DEBUG] Setup mode active. Preview angles: top=");
-        Serial.print(top_angle);
-        Serial.print(", bottom=");
-        Serial.println(bottom_angle);
+        DIAG_D("Setup mode active. Preview angles: top=%d, bottom=%d", top_angle, bottom_angle);
         rotate_needle(top_angle);
         rotate_lower_needle(bottom_angle);
     } else if (use_demo_mode) {
@@ -538,7 +740,25 @@ void loop() {
                 last_seen_screen = current_screen;
             }
 
-            update_needles_for_screen(current_screen);
+            // Ask for high-rate Signal K updates only for what is on screen
+            uint32_t visible_mask = (current_screen >= 1 && current_screen <= NUM_SCREENS)
+                ? (3u << ((current_screen - 1) * 2)) : 0;
+            signalk_set_slot_demand(visible_mask, alarm_slot_mask());
+
+            // Only touch the needles when a value on screen changed or a
+            // held-back move is due to settle. The first call per screen
+            // just seeds the default angles, so its slots stay pending for
+            // the next tick.
+            static bool needles_primed[6] = {false, false, false, false, false, false};
+            uint32_t settle = needle_settle_due(visible_mask, now);
+            if (!test_mode && ((needle_pending & visible_mask) || settle)) {
+                update_needles_for_screen(current_screen);
+                if (needles_primed[current_screen]) needle_pending &= ~visible_mask;
+                needles_primed[current_screen] = true;
+                g_sensor_dirty_stats.needle_runs++;
+            } else {
+                g_sensor_dirty_stats.needle_skips++;
+            }
             last_needle_update = now;
         }
         
@@ -566,66 +786,32 @@ void loop() {
                 default: break;
             }
 
-            // Determine runtime values for top/bottom gauges for this screen
-            float runtime_val[2] = { NAN, NAN };
-            switch (current_screen) {
-                case 1:
-                    runtime_val[0] = get_sensor_value(SCREEN1_RPM);
-                    runtime_val[1] = get_sensor_value(SCREEN1_COOLANT_TEMP);
-                    break;
-                case 2:
-                    runtime_val[0] = get_sensor_value(SCREEN2_RPM);
-                    runtime_val[1] = get_sensor_value(SCREEN2_FUEL);
-                    break;
-                case 3:
-                    runtime_val[0] = get_sensor_value(SCREEN3_COOLANT_TEMP);
-                    runtime_val[1] = get_sensor_value(SCREEN3_EXHAUST_TEMP);
-                    break;
-                case 4:
-                    runtime_val[0] = get_sensor_value(SCREEN4_FUEL);
-                    runtime_val[1] = get_sensor_value(SCREEN4_COOLANT_TEMP);
-                    break;
-                case 5:
-                    runtime_val[0] = get_sensor_value(SCREEN5_OIL_PRESSURE);
-                    runtime_val[1] = get_sensor_value(SCREEN5_COOLANT_TEMP);
-                    break;
-                default:
-                    break;
+            // Recompute zones only for watched slots whose value changed
+            uint32_t alarm_mask = alarm_slot_mask();
+            uint32_t watched = alarm_mask;
+            if (current_screen >= 1 && current_screen <= NUM_SCREENS) watched |= 3u << (screen_idx * 2);
+            uint32_t evaluate = zone_pending & watched;
+            zone_pending &= ~evaluate;
+            g_sensor_dirty_stats.zone_evals += __builtin_popcount(evaluate);
+            g_sensor_dirty_stats.zone_skips += __builtin_popcount(watched & ~evaluate);
+            while (evaluate) {
+                int slot = __builtin_ctz(evaluate);
+                evaluate &= evaluate - 1;
+                slot_zone[slot] = (int8_t)choose_zone(slot / 2, slot % 2, get_sensor_value(slot));
             }
 
-            // For each gauge, choose zone and optionally trigger buzzer if configured
+            // For each gauge, apply the zone and optionally trigger buzzer if configured
             for (int g = 0; g < 2; ++g) {
                 lv_obj_t* icon = icons[g];
                 if (icon == NULL) continue;
 
-                float val = runtime_val[g];
-                int chosen_zone = -1;
-                // Prefer the most specific matching zone (smallest range) so
-                // narrow alert zones win when ranges overlap.
-                float best_range = 1e30f;
-                for (int z = 1; z <= 4; ++z) {
-                    float mn = screen_configs[screen_idx].min[g][z];
-                    float mx = screen_configs[screen_idx].max[g][z];
-                    if (mn == mx) continue;
-                    if (!isnan(val) && val >= mn && val <= mx) {
-                        float range = mx - mn;
-                        if (range < best_range) { best_range = range; chosen_zone = z; }
-                    }
-                }
-                // If no numeric match but there is a configured zone and value is NaN,
-                // pick the first configured zone (fallback behavior).
-                if (chosen_zone == -1 && isnan(val)) {
-                    for (int z = 1; z <= 4; ++z) {
-                        float mn = screen_configs[screen_idx].min[g][z];
-                        float mx = screen_configs[screen_idx].max[g][z];
-                        if (mn != mx) { chosen_zone = z; break; }
-                    }
-                }
-                if (chosen_zone == -1) chosen_zone = 1;
+                int slot = screen_idx * 2 + g;
+                int chosen_zone = slot_zone[slot];
                 int current_state = chosen_zone - 1;
 
                 // Make icon visible and apply style for the chosen zone when it changes
-                if (current_state != last_zone_state[g]) {
+                // (stale gauges keep their icon hidden until data returns)
+                if (current_state != last_zone_state[g] && !sensor_is_stale(slot)) {
                     lv_obj_clear_flag(icon, LV_OBJ_FLAG_HIDDEN);
                     _ui_apply_icon_style(icon, screen_idx, g);
                     last_zone_state[g] = current_state;
@@ -637,8 +823,8 @@ void loop() {
                 bool cooldown_expired = (now - last_buzzer_time > ALERT_COOLDOWN_MS);
                 if (buzzer_mode == 2 && buz_enabled && (first_run_buzzer || cooldown_expired)) {
                     // Debug: log buzzer decision
-                    printf("[ALERT] screen=%d gauge=%d chosen_zone=%d val=%.2f buz_enabled=%d first_run=%d cooldown_expired=%d\n",
-                           screen_idx, g, chosen_zone, val, (int)buz_enabled, (int)first_run_buzzer, (int)cooldown_expired);
+                    DIAG_I("[ALERT] screen=%d gauge=%d chosen_zone=%d val=%.2f buz_enabled=%d first_run=%d cooldown_expired=%d",
+                           screen_idx, g, chosen_zone, get_sensor_value(slot), (int)buz_enabled, (int)first_run_buzzer, (int)cooldown_expired);
                     trigger_buzzer_alert();
                     last_buzzer_time = now;
                     first_run_buzzer = false;
@@ -650,49 +836,21 @@ void loop() {
                 unsigned long now = millis();
                 bool cooldown_expired = (now - last_buzzer_time > ALERT_COOLDOWN_MS);
                 if (first_run_buzzer || cooldown_expired) {
-                    bool fired = false;
-                    for (int s = 0; s < NUM_SCREENS && !fired; ++s) {
-                        // For each gauge on screen s
-                        for (int g = 0; g < 2 && !fired; ++g) {
-                            // Get runtime value for that screen/gauge
-                            float rval = NAN;
-                            switch (s+1) {
-                                case 1: rval = (g==0) ? get_sensor_value(SCREEN1_RPM) : get_sensor_value(SCREEN1_COOLANT_TEMP); break;
-                                case 2: rval = (g==0) ? get_sensor_value(SCREEN2_RPM) : get_sensor_value(SCREEN2_FUEL); break;
-                                case 3: rval = (g==0) ? get_sensor_value(SCREEN3_COOLANT_TEMP) : get_sensor_value(SCREEN3_EXHAUST_TEMP); break;
-                                case 4: rval = (g==0) ? get_sensor_value(SCREEN4_FUEL) : get_sensor_value(SCREEN4_COOLANT_TEMP); break;
-                                case 5: rval = (g==0) ? get_sensor_value(SCREEN5_OIL_PRESSURE) : get_sensor_value(SCREEN5_COOLANT_TEMP); break;
-                                default: rval = NAN; break;
-                            }
-                            int chosen_zone = -1;
-                            float best_range = 1e30f;
-                            for (int z = 1; z <= 4; ++z) {
-                                float mn = screen_configs[s].min[g][z];
-                                float mx = screen_configs[s].max[g][z];
-                                if (mn == mx) continue;
-                                if (!isnan(rval) && rval >= mn && rval <= mx) {
-                                    float range = mx - mn;
-                                    if (range < best_range) { best_range = range; chosen_zone = z; }
-                                }
-                            }
-                            if (chosen_zone == -1 && isnan(rval)) {
-                                for (int z = 1; z <= 4; ++z) {
-                                    float mn = screen_configs[s].min[g][z];
-                                    float mx = screen_configs[s].max[g][z];
-                                    if (mn != mx) { chosen_zone = z; break; }
-                                }
-                            }
-                            if (chosen_zone == -1) chosen_zone = 1;
-                            bool buz_enabled = (screen_configs[s].buzzer[g][chosen_zone] != 0);
-                            if (buz_enabled) {
-                                printf("[ALERT-GLOBAL] screen=%d gauge=%d chosen_zone=%d val=%.2f buz_enabled=%d\n",
-                                       s, g, chosen_zone, rval, (int)buz_enabled);
-                                trigger_buzzer_alert();
-                                last_buzzer_time = now;
-                                first_run_buzzer = false;
-                                fired = true;
-                                break;
-                            }
+                    // Only slots with a buzzer zone can fire; their zones are current
+                    uint32_t alarm = alarm_mask;
+                    while (alarm) {
+                        int slot = __builtin_ctz(alarm);
+                        alarm &= alarm - 1;
+                        int s = slot / 2, g = slot % 2;
+                        int chosen_zone = slot_zone[slot];
+                        bool buz_enabled = (screen_configs[s].buzzer[g][chosen_zone] != 0);
+                        if (buz_enabled) {
+                            DIAG_I("[ALERT-GLOBAL] screen=%d gauge=%d chosen_zone=%d val=%.2f buz_enabled=%d",
+                                   s, g, chosen_zone, get_sensor_value(slot), (int)buz_enabled);
+                            trigger_buzzer_alert();
+                            last_buzzer_time = now;
+                            first_run_buzzer = false;
+                            break;
                         }
                     }
                 }
@@ -702,7 +860,8 @@ void loop() {
     
     Lvgl_Loop();
 
-    // Small delay to prevent excessive loop iterations
-    delay(1);
+    // Small delay to prevent excessive loop iterations (cut short when a
+    // sensor value changes)
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1));
     yield();
 }
@@ -66,6 +66,24 @@ NeedleStyle get_needle_style(int screen, int gauge) {
     return s;
 }
 
+static NeedleGeometry geometry_cache[NUM_SCREENS][2];
+static bool geometry_valid = false;
+
+const NeedleGeometry &get_needle_geometry(int screen, int gauge) {
+    if (screen < 0 || screen >= NUM_SCREENS) screen = 0;
+    if (gauge < 0 || gauge > 1) gauge = 0;
+    if (!geometry_valid) {
+        for (int sc = 0; sc < NUM_SCREENS; ++sc) {
+            for (int g = 0; g < 2; ++g) {
+                NeedleStyle st = get_needle_style(sc, g);
+                geometry_cache[sc][g] = { st.inner, st.outer, st.cx, st.cy };
+            }
+        }
+        geometry_valid = true;
+    }
+    return geometry_cache[screen][gauge];
+}
+
 void apply_needle_style_to_obj(lv_obj_t* obj, int screen, int gauge) {
     if (!obj) return;
     NeedleStyle s = get_needle_style(screen, gauge);
@@ -103,5 +121,6 @@ void save_needle_style_from_args(int screen, int gauge, const String& color, uin
     preferences.putUShort(pref_key_gradient(screen,gauge).c_str(), gradient ? 1 : 0);
     preferences.putUShort(pref_key_fg(screen,gauge).c_str(), fg ? 1 : 0);
     preferences.end();
+    geometry_valid = false;   // cx/cy are shared by both gauges of a screen
 }
 
@@ -21,6 +21,16 @@ void needle_style_init_defaults();
 // Return the style for given screen (0-based) and gauge (0=top,1=bottom)
 NeedleStyle get_needle_style(int screen, int gauge);
 
+// Line geometry only, cached in RAM (get_needle_style reads NVS). For the
+// animation callbacks and redraw suppression; refreshed after a save.
+struct NeedleGeometry {
+    int16_t inner;
+    int16_t outer;
+    uint16_t cx;
+    uint16_t cy;
+};
+const NeedleGeometry &get_needle_geometry(int screen, int gauge);
+
 // Apply style to a specific lv line object
 void apply_needle_style_to_obj(lv_obj_t* obj, int screen, int gauge);
 
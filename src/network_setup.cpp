@@ -48,6 +48,7 @@ extern "C" void show_fallback_error_screen_if_needed() {
 #include <Arduino.h>
 #include <WiFi.h>
 #include <WebServer.h>
+#include <uri/UriBraces.h>
 #include <ESPmDNS.h>
 #include <Preferences.h>
 #include "network_setup.h"
@@ -63,6 +64,10 @@ extern "C" void show_fallback_error_screen_if_needed() {
 #include <esp_err.h>
 #include "esp_log.h"
 #include "needle_style.h"
+#include "sensor_store.h"
+#include "sensor_filter.h"
+#include "derived_signals.h"
+#include "calibration_store.h"
 
 static const char *TAG_SETUP = "network_setup";
 
@@ -128,6 +133,20 @@ input[type=number]{width:120px;padding:6px;border:1px solid #dfe9fb;border-radiu
 
 // Forward declaration for toggle test mode handler
 void handle_toggle_test_mode();
+void handle_metrics();
+void handle_log();
+void handle_staleness();
+void handle_filters();
+void handle_derived();
+void handle_counters();
+void handle_curves();
+void handle_history();
+void handle_nmea();
+void handle_record();
+void handle_record_download();
+void handle_logs();
+void handle_logs_file();
+void handle_latency();
 void handle_test_gauge();
 void handle_nvs_test();
 void handle_set_screen();
@@ -551,6 +570,11 @@ void load_preferences() {
             }
         }
     }
+    // The calibration blob is authoritative; the screen configs seed it once
+    cal_store_load_screens();
+    gauge_cal_compile();
+    // Zones and calibration may differ: re-evaluate every gauge
+    sensor_mark_dirty(~0u);
 
     // No automatic default icon set; keep blank unless user selects one via UI
 }
@@ -898,6 +922,7 @@ void handle_save_gauges() {
                 }
             }
         }
+        cal_store_save();
         // Print updated gauge_cal values before saving
         Serial.println("[DEBUG] gauge_cal values after POST:");
         for (int s = 0; s < NUM_SCREENS; ++s) {
@@ -926,9 +951,17 @@ void handle_save_gauges() {
         // Persist to NVS/Preferences as well
         save_preferences();
 
+        // Gauges may have switched to or from derived signals, which changes
+        // the derived inputs to subscribe
+        derived_init();
         // Refresh Signal K subscriptions immediately in case any SK paths changed
         // (safe to call even if WS not connected; function will no-op locally)
         refresh_signalk_subscriptions();
+        // Filter resolution follows the calibration range
+        sensor_filter_init();
+        gauge_cal_compile();
+        // Redraw needles and recompute icon zones with the new settings
+        sensor_mark_dirty(~0u);
 
         // Prefer hot-apply: try to apply visuals now. If successful, skip reloading
         // stored preferences when rendering the gauges page so the user sees the
@@ -1341,6 +1374,20 @@ void setup_network() {
     config_server.on("/toggle-test-mode", HTTP_POST, handle_toggle_test_mode);
     config_server.on("/set-screen", handle_set_screen);
     config_server.on("/nvs_test", HTTP_GET, handle_nvs_test);
+    config_server.on("/metrics", HTTP_GET, handle_metrics);
+    config_server.on("/log", HTTP_GET, handle_log);
+    config_server.on("/staleness", handle_staleness);
+    config_server.on("/filters", handle_filters);
+    config_server.on("/derived", handle_derived);
+    config_server.on("/counters", handle_counters);
+    config_server.on("/curves", handle_curves);
+    config_server.on("/history", HTTP_GET, handle_history);
+    config_server.on("/nmea", handle_nmea);
+    config_server.on("/record", handle_record);
+    config_server.on("/record/download", HTTP_GET, handle_record_download);
+    config_server.on("/logs", handle_logs);
+    config_server.on(UriBraces("/logs/{}"), HTTP_GET, handle_logs_file);
+    config_server.on("/latency", HTTP_GET, handle_latency);
     config_server.begin();
     Serial.println("[WebServer] Configuration web UI started on port 80");
 }
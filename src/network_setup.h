@@ -12,6 +12,9 @@ extern GaugeCalibrationPoint gauge_cal[NUM_SCREENS][2][5];
 // Global web server instance
 extern WebServer config_server;
 
+// Shared <style> block for the configuration pages
+extern const String STYLE;
+
 // Auto-scroll interval in seconds (0 = off)
 extern uint16_t auto_scroll_sec;
 
@@ -0,0 +1,227 @@
+#include "nmea0183_parser.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const float KELVIN_OFFSET = 273.15f;
+static const float KNOTS_TO_MS = 0.514444f;
+static const float DEG_TO_RAD = 0.01745329252f;
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Numeric field -> float. Empty or non-numeric fields are "no data".
+static bool field_float(const char *f, float *out) {
+    if (f == NULL || *f == '\0') return false;
+    char *end;
+    float v = strtof(f, &end);
+    if (end == f || *end != '\0') return false;
+    *out = v;
+    return true;
+}
+
+// "<prefix><a><b>" into key; returns the length (truncated to NMEA_MAX_KEY-1)
+static size_t make_key(char *key, const char *prefix, const char *a, const char *b) {
+    size_t n = 0;
+    const char *parts[3] = { prefix, a, b };
+    for (int p = 0; p < 3; p++) {
+        for (const char *c = parts[p]; c != NULL && *c != '\0' && n < NMEA_MAX_KEY - 1; c++) key[n++] = *c;
+    }
+    key[n] = '\0';
+    return n;
+}
+
+// XDR value in its transducer unit -> the SI unit the gauges expect.
+// Percentages stay percentages (the fuel gauges are calibrated 0-100).
+static float xdr_to_si(char type, char unit, float v) {
+    switch (type) {
+    case 'C':
+        if (unit == 'C') return v + KELVIN_OFFSET;
+        if (unit == 'F') return (v - 32.0f) * (5.0f / 9.0f) + KELVIN_OFFSET;
+        return v;
+    case 'P':
+        if (unit == 'B') return v * 100000.0f;   // bar -> Pa
+        return v;                                // 'P' = Pa
+    case 'T':
+        if (unit == 'R') return v / 60.0f;       // rpm -> Hz
+        return v;
+    case 'A':
+        if (unit == 'D') return v * DEG_TO_RAD;
+        return v;
+    default:
+        return v;
+    }
+}
+
+struct Sentence {
+    char *fields[NMEA_MAX_FIELDS];   // fields[0] = address ("IIXDR")
+    int count;
+    char talker[3];
+};
+
+static int emit(nmea_value_cb cb, void *ctx, const Sentence &s, const char *key, size_t key_len, float v) {
+    if (cb) cb(key, key_len, v, s.talker, ctx);
+    return 1;
+}
+
+static int parse_xdr(const Sentence &s, nmea_value_cb cb, void *ctx) {
+    int n = 0;
+    char key[NMEA_MAX_KEY];
+    // Quadruples: type, data, unit, name
+    for (int i = 1; i + 2 < s.count; i += 4) {
+        float v;
+        const char *type = s.fields[i];
+        if (type[0] == '\0' || !field_float(s.fields[i + 1], &v)) continue;
+        const char *name = (i + 3 < s.count) ? s.fields[i + 3] : "";
+        size_t key_len = make_key(key, "XDR/", name[0] != '\0' ? name : type, NULL);
+        n += emit(cb, ctx, s, key, key_len, xdr_to_si(type[0], s.fields[i + 2][0], v));
+    }
+    return n;
+}
+
+static int parse_rpm(const Sentence &s, nmea_value_cb cb, void *ctx) {
+    // RPM,source(S/E),number,rpm,pitch,status
+    float rpm;
+    if (s.count < 4 || !field_float(s.fields[3], &rpm)) return 0;
+    if (s.count > 5 && s.fields[5][0] != '\0' && s.fields[5][0] != 'A') return 0;
+    char key[NMEA_MAX_KEY];
+    size_t key_len = make_key(key, "RPM/", s.fields[1], s.fields[2]);
+    return emit(cb, ctx, s, key, key_len, rpm / 60.0f);
+}
+
+static int parse_mtw(const Sentence &s, nmea_value_cb cb, void *ctx) {
+    // MTW,temperature,C
+    float t;
+    if (s.count < 2 || !field_float(s.fields[1], &t)) return 0;
+    return emit(cb, ctx, s, "MTW", 3, t + KELVIN_OFFSET);
+}
+
+static int parse_dpt(const Sentence &s, nmea_value_cb cb, void *ctx) {
+    // DPT,depth(m),offset(m)[,range]
+    float d;
+    if (s.count < 2 || !field_float(s.fields[1], &d)) return 0;
+    return emit(cb, ctx, s, "DPT", 3, d);
+}
+
+static int parse_vhw(const Sentence &s, nmea_value_cb cb, void *ctx) {
+    // VHW,hdgT,T,hdgM,M,knots,N,kmh,K
+    float v;
+    if (s.count > 5 && field_float(s.fields[5], &v)) return emit(cb, ctx, s, "VHW", 3, v * KNOTS_TO_MS);
+    if (s.count > 7 && field_float(s.fields[7], &v)) return emit(cb, ctx, s, "VHW", 3, v / 3.6f);
+    return 0;
+}
+
+int nmea_parse_sentence(char *buf, size_t len, nmea_value_cb cb, void *ctx, NmeaParseStats *stats,
+                        bool require_checksum) {
+    if (len < 7 || (buf[0] != '$' && buf[0] != '!')) {
+        if (stats) stats->malformed++;
+        return -1;
+    }
+
+    // Checksum over everything between the start character and '*'
+    uint8_t sum = 0;
+    size_t body_end = len;
+    for (size_t i = 1; i < len; i++) {
+        if (buf[i] == '*') { body_end = i; break; }
+        sum ^= (uint8_t)buf[i];
+    }
+    if (body_end < len) {
+        if (body_end + 3 > len) {
+            if (stats) stats->malformed++;
+            return -1;
+        }
+        int hi = hex_digit(buf[body_end + 1]);
+        int lo = hex_digit(buf[body_end + 2]);
+        if (hi < 0 || lo < 0 || (uint8_t)((hi << 4) | lo) != sum) {
+            if (stats) stats->checksum_errors++;
+            return -1;
+        }
+    } else if (require_checksum) {
+        if (stats) stats->missing_checksum++;
+        return -1;
+    }
+    buf[body_end] = '\0';
+
+    // Split in place
+    Sentence s;
+    s.count = 0;
+    char *p = buf + 1;
+    s.fields[s.count++] = p;
+    for (; *p != '\0'; p++) {
+        if (*p == ',') {
+            *p = '\0';
+            if (s.count == NMEA_MAX_FIELDS) break;
+            s.fields[s.count++] = p + 1;
+        }
+    }
+
+    const char *addr = s.fields[0];
+    size_t addr_len = strlen(addr);
+    if (addr_len != 5) {   // talker (2) + type (3); proprietary 'P' sentences are longer
+        if (stats) {
+            if (addr_len > 5) stats->unsupported++;
+            else stats->malformed++;
+        }
+        return addr_len > 5 ? 0 : -1;
+    }
+    s.talker[0] = addr[0];
+    s.talker[1] = addr[1];
+    s.talker[2] = '\0';
+    const char *type = addr + 2;
+    if (stats) stats->sentences++;
+
+    int n;
+    if (memcmp(type, "XDR", 3) == 0) n = parse_xdr(s, cb, ctx);
+    else if (memcmp(type, "RPM", 3) == 0) n = parse_rpm(s, cb, ctx);
+    else if (memcmp(type, "MTW", 3) == 0) n = parse_mtw(s, cb, ctx);
+    else if (memcmp(type, "DPT", 3) == 0) n = parse_dpt(s, cb, ctx);
+    else if (memcmp(type, "VHW", 3) == 0) n = parse_vhw(s, cb, ctx);
+    else {
+        if (stats) stats->unsupported++;
+        return 0;
+    }
+    if (stats) stats->values += n;
+    return n;
+}
+
+void nmea_reader_init(NmeaReader *r) {
+    r->len = 0;
+    r->in_sentence = false;
+    r->overflow = false;
+    r->require_checksum = true;
+}
+
+int nmea_feed(NmeaReader *r, const char *data, size_t len, nmea_value_cb cb, void *ctx, NmeaParseStats *stats) {
+    int total = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == '$' || c == '!') {
+            // A start character always begins a new sentence; a previous
+            // unterminated one is dropped.
+            if (r->in_sentence && r->len > 0 && stats) stats->malformed++;
+            r->line[0] = c;
+            r->len = 1;
+            r->in_sentence = true;
+            r->overflow = false;
+        } else if (c == '\r' || c == '\n') {
+            if (r->in_sentence) {
+                if (r->overflow) {
+                    if (stats) stats->overflows++;
+                } else {
+                    r->line[r->len] = '\0';
+                    int n = nmea_parse_sentence(r->line, r->len, cb, ctx, stats, r->require_checksum);
+                    if (n > 0) total += n;
+                }
+            }
+            r->in_sentence = false;
+            r->len = 0;
+        } else if (r->in_sentence && !r->overflow) {
+            if (r->len < NMEA_MAX_LINE) r->line[r->len++] = c;
+            else r->overflow = true;
+        }
+    }
+    return total;
+}
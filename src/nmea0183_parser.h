@@ -0,0 +1,69 @@
+#ifndef NMEA0183_PARSER_H
+#define NMEA0183_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Allocation-free NMEA 0183 sentence parser.
+//
+// Bytes from a UDP datagram or TCP stream are fed in any chunking; complete
+// lines are checksum-validated and split in place, and every measurement the
+// parser understands is reported as a key/value pair in SI units (the units
+// the gauges use for Signal K values):
+//
+//   XDR  one value per transducer quadruple, key "XDR/<name>", or
+//        "XDR/<type>" when the name field is empty
+//   RPM  key "RPM/<source><n>", e.g. "RPM/E1" (shaft/engine 1), in Hz
+//   MTW  key "MTW", water temperature in K
+//   DPT  key "DPT", depth below transducer in m
+//   VHW  key "VHW", speed through water in m/s
+//
+// The talker ID is ignored so "$IIXDR" and "$ECXDR" give the same keys.
+// A wrong checksum is always rejected. A missing one is too unless the
+// reader is told otherwise: over UDP a truncated datagram would otherwise
+// parse as good data.
+//
+// Plain C++ with no Arduino dependencies so it can also be built on a host.
+
+#define NMEA_MAX_LINE 96            // longest sentence kept (spec: 82)
+#define NMEA_MAX_FIELDS 32
+#define NMEA_MAX_KEY 40
+
+// Called once per measurement. `key` and `talker` are NUL-terminated and
+// only valid during the callback.
+typedef void (*nmea_value_cb)(const char *key, size_t key_len, float value,
+                              const char *talker, void *ctx);
+
+struct NmeaParseStats {
+    uint32_t sentences;        // checksum-valid sentences
+    uint32_t values;           // measurements reported
+    uint32_t checksum_errors;
+    uint32_t missing_checksum; // rejected for having no *hh
+    uint32_t malformed;        // bad framing / fields
+    uint32_t unsupported;      // valid sentences of a type not handled
+    uint32_t overflows;        // lines longer than NMEA_MAX_LINE
+};
+
+// Line assembler state for one stream.
+struct NmeaReader {
+    char line[NMEA_MAX_LINE + 1];
+    uint16_t len;
+    bool in_sentence;          // saw '$' or '!', collecting until CR/LF
+    bool overflow;             // current line too long, skip to end
+    bool require_checksum;     // reject sentences without *hh (default)
+};
+
+void nmea_reader_init(NmeaReader *r);
+
+// Feed raw bytes. Returns the number of measurements reported.
+int nmea_feed(NmeaReader *r, const char *data, size_t len, nmea_value_cb cb, void *ctx,
+              NmeaParseStats *stats = nullptr);
+
+// Parse one sentence without its line terminator ("$IIMTW,18.5,C*hh").
+// The buffer is modified in place. Without `require_checksum` a sentence
+// with no *hh is accepted. Returns the number of measurements
+// reported, or -1 if the sentence was rejected.
+int nmea_parse_sentence(char *s, size_t len, nmea_value_cb cb, void *ctx,
+                        NmeaParseStats *stats = nullptr, bool require_checksum = true);
+
+#endif // NMEA0183_PARSER_H
@@ -0,0 +1,256 @@
+#include "nmea_ingest.h"
+#include "signalk_config.h"
+#include "signalk_path_index.h"
+#include "sensor_store.h"
+#include "sensor_staleness.h"
+#define DIAG_TAG "NMEA"
+#define DIAG_MODULE_LEVEL DIAG_LEVEL_SIGNALK
+#include "diag_log.h"
+#include <WiFi.h>
+#include <Preferences.h>
+#include <lwip/sockets.h>
+
+static const uint32_t TCP_RETRY_MS = 5000;
+static const uint32_t TCP_CONNECT_TIMEOUT_MS = 3000;
+static const uint32_t WAIT_MAX_MS = 200;     // longest sleep, bounds stop latency
+
+static NmeaIngestConfig active_cfg;          // what the task runs with
+static SkPathIndex key_index;                // mapping key -> slot mask
+static SemaphoreHandle_t key_index_mutex = NULL;
+static volatile uint32_t mapped_mask = 0;
+static TaskHandle_t ingest_task_handle = NULL;
+static volatile bool stop_requested = false;
+static NmeaIngestStats stats = {};
+
+void nmea_ingest_load_config(NmeaIngestConfig *cfg) {
+    Preferences prefs;
+    bool open = prefs.begin("nmea", true);
+    cfg->mode = (NmeaMode)(open ? prefs.getUChar("mode", NMEA_MODE_OFF) : NMEA_MODE_OFF);
+    cfg->port = open ? prefs.getUShort("port", NMEA_DEFAULT_PORT) : NMEA_DEFAULT_PORT;
+    cfg->host = open ? prefs.getString("host", "") : String("");
+    cfg->allow_no_checksum = open ? prefs.getBool("nocsum", false) : false;
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        char key[8];
+        snprintf(key, sizeof(key), "m%d", i);
+        cfg->keys[i] = open ? prefs.getString(key, "") : String("");
+        cfg->keys[i].trim();
+    }
+    if (open) prefs.end();
+    if (cfg->mode > NMEA_MODE_TCP) cfg->mode = NMEA_MODE_OFF;
+    if (cfg->port == 0) cfg->port = NMEA_DEFAULT_PORT;
+}
+
+void nmea_ingest_save_config(const NmeaIngestConfig *cfg) {
+    Preferences prefs;
+    if (!prefs.begin("nmea", false)) {
+        DIAG_W("cannot open NVS namespace, settings not saved");
+        return;
+    }
+    prefs.putUChar("mode", (uint8_t)cfg->mode);
+    prefs.putUShort("port", cfg->port);
+    prefs.putString("host", cfg->host);
+    prefs.putBool("nocsum", cfg->allow_no_checksum);
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        char key[8];
+        snprintf(key, sizeof(key), "m%d", i);
+        prefs.putString(key, cfg->keys[i]);
+    }
+    prefs.end();
+}
+
+static void rebuild_key_index(const NmeaIngestConfig &cfg) {
+    if (key_index_mutex == NULL) key_index_mutex = xSemaphoreCreateMutex();
+    if (!xSemaphoreTake(key_index_mutex, pdMS_TO_TICKS(100))) {
+        DIAG_W("mapping busy, rebuild skipped");
+        return;
+    }
+    sk_path_index_clear(&key_index);
+    uint32_t mask = 0;
+    // Without a transport nothing feeds the slots
+    if (cfg.mode != NMEA_MODE_OFF) {
+        for (int i = 0; i < TOTAL_PARAMS; i++) {
+            if (cfg.keys[i].length() == 0) continue;
+            if (sk_path_index_add(&key_index, cfg.keys[i].c_str(), cfg.keys[i].length(), i) < 0) {
+                DIAG_W("slot %d key '%s' not mapped (too long or table full)", i, cfg.keys[i].c_str());
+                continue;
+            }
+            mask |= 1u << i;
+        }
+    }
+    mapped_mask = mask;
+    xSemaphoreGive(key_index_mutex);
+}
+
+// Parser callback: route one measurement to its slots (key_index_mutex held).
+// ctx points at the micros() receive stamp of the chunk being parsed.
+static void store_value(const char *key, size_t key_len, float value, const char *talker, void *ctx) {
+    const SkPathEntry *e = sk_path_index_find(&key_index, key, key_len);
+    if (e == NULL) {
+        stats.unmapped++;
+        return;
+    }
+    char source[16];
+    int source_len = snprintf(source, sizeof(source), "nmea0183.%s", talker);
+    uint32_t m = e->slot_mask;
+    while (m) {
+        int i = __builtin_ctz(m);
+        m &= m - 1;
+        set_sensor_sample(i, value, 0, source, (size_t)source_len, *(const uint32_t *)ctx);
+        stats.stored++;
+    }
+}
+
+static void ingest_chunk(NmeaReader *reader, const char *data, size_t len, bool end_of_datagram, uint32_t rx_us) {
+    stats.datagrams++;
+    stats.bytes += len;
+    if (xSemaphoreTake(key_index_mutex, pdMS_TO_TICKS(20))) {
+        nmea_feed(reader, data, len, store_value, &rx_us, &stats.parse);
+        // A datagram holds whole sentences; flush one sent without CR/LF
+        if (end_of_datagram) nmea_feed(reader, "\n", 1, store_value, &rx_us, &stats.parse);
+        xSemaphoreGive(key_index_mutex);
+    }
+    uint32_t lat = micros() - rx_us;
+    stats.latency_last_us = lat;
+    if (lat > stats.latency_max_us) stats.latency_max_us = lat;
+    stats.latency_avg_us = stats.latency_avg_us == 0 ? lat : (stats.latency_avg_us * 7 + lat) / 8;
+}
+
+// Sleep until `fd` is readable or `wait_ms` passes. Returns true if readable.
+static bool wait_readable(int fd, uint32_t wait_ms) {
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    FD_SET(fd, &rfds);
+    struct timeval tv = { (time_t)(wait_ms / 1000), (suseconds_t)((wait_ms % 1000) * 1000) };
+    int r = select(fd + 1, &rfds, NULL, NULL, &tv);
+    if (r < 0) vTaskDelay(pdMS_TO_TICKS(10));   // socket closed under us; don't spin
+    return r > 0;
+}
+
+static int open_udp(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void nmea_task(void *param) {
+    (void)param;
+    static char buf[1472];   // one Ethernet-MTU datagram
+    NmeaReader reader;
+    nmea_reader_init(&reader);
+    reader.require_checksum = !active_cfg.allow_no_checksum;
+    int udp_fd = -1;
+    WiFiClient tcp;
+    uint32_t next_connect_ms = 0;
+    stats.running = true;
+
+    if (active_cfg.mode == NMEA_MODE_UDP) {
+        udp_fd = open_udp(active_cfg.port);
+        stats.connected = udp_fd >= 0;
+        if (stats.connected) DIAG_I("listening for UDP on port %u", (unsigned)active_cfg.port);
+        else DIAG_E("cannot bind UDP port %u", (unsigned)active_cfg.port);
+    }
+
+    while (!stop_requested) {
+        if (active_cfg.mode == NMEA_MODE_UDP) {
+            if (udp_fd < 0) {
+                vTaskDelay(pdMS_TO_TICKS(WAIT_MAX_MS));
+                continue;
+            }
+            if (!wait_readable(udp_fd, WAIT_MAX_MS)) continue;
+            uint32_t rx_us = micros();
+            int n = recv(udp_fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n > 0) ingest_chunk(&reader, buf, (size_t)n, true, rx_us);
+        } else if (!tcp.connected()) {
+            stats.connected = false;
+            uint32_t now = millis();
+            int32_t due = (int32_t)(next_connect_ms - now);
+            if (due > 0 || WiFi.status() != WL_CONNECTED) {
+                vTaskDelay(pdMS_TO_TICKS(due > 0 && (uint32_t)due < WAIT_MAX_MS ? (uint32_t)due : WAIT_MAX_MS));
+                continue;
+            }
+            if (tcp.connect(active_cfg.host.c_str(), active_cfg.port, TCP_CONNECT_TIMEOUT_MS)) {
+                stats.connected = true;
+                nmea_reader_init(&reader);
+                reader.require_checksum = !active_cfg.allow_no_checksum;
+                DIAG_I("connected to %s:%u", active_cfg.host.c_str(), (unsigned)active_cfg.port);
+            } else {
+                DIAG_W("cannot connect to %s:%u, retrying", active_cfg.host.c_str(), (unsigned)active_cfg.port);
+                next_connect_ms = now + TCP_RETRY_MS;
+            }
+        } else {
+            if (tcp.available() <= 0 && !wait_readable(tcp.fd(), WAIT_MAX_MS)) continue;
+            uint32_t rx_us = micros();
+            // Readable with nothing to read is the peer closing; connected() notices
+            int n = tcp.read((uint8_t *)buf, sizeof(buf));
+            if (n > 0) ingest_chunk(&reader, buf, (size_t)n, false, rx_us);
+        }
+    }
+
+    if (udp_fd >= 0) close(udp_fd);
+    tcp.stop();
+    stats.running = false;
+    stats.connected = false;
+    ingest_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+void nmea_ingest_start() {
+    if (ingest_task_handle != NULL) return;
+    nmea_ingest_load_config(&active_cfg);
+    rebuild_key_index(active_cfg);
+    staleness_init();
+    if (active_cfg.mode == NMEA_MODE_OFF) return;
+    if (active_cfg.mode == NMEA_MODE_TCP && active_cfg.host.length() == 0) {
+        DIAG_W("TCP mode without a host, not started");
+        return;
+    }
+    if (WiFi.status() != WL_CONNECTED) {
+        DIAG_W("WiFi not connected, not started");
+        return;
+    }
+    stop_requested = false;
+    xTaskCreatePinnedToCore(nmea_task, "NMEA0183", 4096, NULL, 2, &ingest_task_handle, 0);
+}
+
+void nmea_ingest_stop() {
+    if (ingest_task_handle == NULL) return;
+    stop_requested = true;
+    // The task closes its sockets and exits on its next pass (which can be
+    // behind a TCP connect attempt)
+    for (int i = 0; i < 400 && ingest_task_handle != NULL; i++) vTaskDelay(pdMS_TO_TICKS(10));
+    if (ingest_task_handle != NULL) DIAG_W("ingest task did not stop");
+}
+
+void nmea_ingest_reload() {
+    NmeaIngestConfig cfg;
+    nmea_ingest_load_config(&cfg);
+    bool transport_changed = cfg.mode != active_cfg.mode || cfg.port != active_cfg.port || cfg.host != active_cfg.host ||
+                             cfg.allow_no_checksum != active_cfg.allow_no_checksum;
+    if (transport_changed || ingest_task_handle == NULL) {
+        nmea_ingest_stop();
+        nmea_ingest_start();
+    } else {
+        // Same transport: only the mapping changed
+        for (int i = 0; i < TOTAL_PARAMS; i++) active_cfg.keys[i] = cfg.keys[i];
+        rebuild_key_index(active_cfg);
+        staleness_init();
+    }
+}
+
+uint32_t nmea_ingest_slot_mask() {
+    return mapped_mask;
+}
+
+void nmea_ingest_get_stats(NmeaIngestStats *out) {
+    *out = stats;
+}
@@ -0,0 +1,61 @@
+#ifndef NMEA_INGEST_H
+#define NMEA_INGEST_H
+
+#include <Arduino.h>
+#include "signalk_config.h"  // TOTAL_PARAMS
+#include "nmea0183_parser.h"
+
+// NMEA 0183 over WiFi as an alternative (or additional) data source.
+//
+// A task on core 0 listens for UDP datagrams (the usual multiplexer
+// broadcast, port 10110) or reads a TCP stream, parses the sentences and
+// stores the mapped measurements with set_sensor_sample(), exactly like the
+// Signal K client does. The mapping is one key per slot ("RPM/E1",
+// "XDR/ENGT#1", "MTW", ...; see nmea0183_parser.h); several slots may share
+// a key. Settings live in NVS namespace "nmea".
+//
+// The task blocks in select() on its socket, so an idle source costs no
+// CPU; the timeout only bounds how long a stop request or TCP retry waits.
+
+enum NmeaMode : uint8_t { NMEA_MODE_OFF = 0, NMEA_MODE_UDP = 1, NMEA_MODE_TCP = 2 };
+
+#define NMEA_DEFAULT_PORT 10110
+
+struct NmeaIngestConfig {
+    NmeaMode mode;
+    uint16_t port;       // UDP listen port or TCP server port
+    String host;         // TCP server (unused for UDP)
+    bool allow_no_checksum;  // accept sentences without *hh (off: rejected)
+    String keys[TOTAL_PARAMS];
+};
+
+struct NmeaIngestStats {
+    bool running;
+    bool connected;            // TCP: connected; UDP: socket open
+    uint32_t datagrams;        // UDP packets / TCP reads
+    uint32_t bytes;
+    uint32_t stored;           // values written to slots
+    uint32_t unmapped;         // values with no slot
+    uint32_t latency_last_us;  // receive -> stored, per datagram/read
+    uint32_t latency_max_us;
+    uint32_t latency_avg_us;   // moving average
+    NmeaParseStats parse;
+};
+
+void nmea_ingest_load_config(NmeaIngestConfig *cfg);
+void nmea_ingest_save_config(const NmeaIngestConfig *cfg);
+
+// Start the ingest task if a mode is configured (WiFi must be up).
+void nmea_ingest_start();
+void nmea_ingest_stop();
+
+// Reload the configuration: re-reads the mapping and restarts the task if
+// the transport settings changed.
+void nmea_ingest_reload();
+
+// Slots with a mapping (bit i = slot i); valid after start/reload.
+uint32_t nmea_ingest_slot_mask();
+
+void nmea_ingest_get_stats(NmeaIngestStats *out);
+
+#endif // NMEA_INGEST_H
@@ -0,0 +1,97 @@
+#include "sensor_filter.h"
+#include "network_setup.h"
+#include "gauge_curves.h"
+#include <Arduino.h>
+#include <Preferences.h>
+
+static SignalFilterChain chains[TOTAL_PARAMS];           // under the sensor store's slot lock
+static SignalFilterConfig configs[TOTAL_PARAMS];         // current settings
+static SignalFilterConfig pending_cfg[TOTAL_PARAMS];     // handed to the writer
+static uint8_t pending_frac[TOTAL_PARAMS];
+static volatile uint32_t pending_mask = 0;               // bit i = slot i reconfigured
+static uint64_t cost_cycles[TOTAL_PARAMS];               // summed over enabled samples
+static uint32_t cost_samples[TOTAL_PARAMS];
+
+// Largest calibrated magnitude of a slot's gauge; 0 when uncalibrated
+static float calibrated_max_abs(int slot) {
+    GaugeCurve curve;
+    gauge_curve_get(slot, &curve);
+    float m = 0;
+    for (int p = 0; p < curve.n; p++) {
+        float v = fabsf(curve.values[p]);
+        if (v > m) m = v;
+    }
+    return m;
+}
+
+static void load_config(Preferences &prefs, bool open, int slot, SignalFilterConfig *cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->ema_pct = 100;
+    if (!open) return;
+    char key[8];
+    snprintf(key, sizeof(key), "f%d", slot);
+    if (prefs.getBytesLength(key) == sizeof(*cfg)) prefs.getBytes(key, cfg, sizeof(*cfg));
+}
+
+void sensor_filter_init() {
+    Preferences prefs;
+    bool open = prefs.begin("filter", true);
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        load_config(prefs, open, i, &configs[i]);
+        float max_abs = calibrated_max_abs(i);
+        // Uncalibrated gauges get a range wide enough for Pa
+        pending_frac[i] = signal_filter_frac_bits(max_abs > 0 ? max_abs : 1e6f);
+        pending_cfg[i] = configs[i];
+    }
+    if (open) prefs.end();
+    __atomic_store_n(&pending_mask, (1u << TOTAL_PARAMS) - 1, __ATOMIC_RELEASE);
+}
+
+void sensor_filter_get_config(int slot, SignalFilterConfig *out) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) return;
+    *out = configs[slot];
+}
+
+void sensor_filter_set_config(int slot, const SignalFilterConfig *cfg) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) return;
+    configs[slot] = *cfg;
+    Preferences prefs;
+    if (prefs.begin("filter", false)) {
+        char key[8];
+        snprintf(key, sizeof(key), "f%d", slot);
+        prefs.putBytes(key, cfg, sizeof(*cfg));
+        prefs.end();
+    }
+    pending_cfg[slot] = *cfg;
+    __atomic_fetch_or(&pending_mask, 1u << slot, __ATOMIC_RELEASE);
+}
+
+float sensor_filter_apply(int slot, float value, uint32_t now_ms) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) return value;
+    SignalFilterChain &f = chains[slot];
+    uint32_t bit = 1u << slot;
+    if (__atomic_load_n(&pending_mask, __ATOMIC_ACQUIRE) & bit) {
+        // Clear first: a change racing with the copy re-arms the bit
+        __atomic_fetch_and(&pending_mask, ~bit, __ATOMIC_ACQ_REL);
+        signal_filter_reset(&f, &pending_cfg[slot], pending_frac[slot]);
+        cost_cycles[slot] = 0;
+        cost_samples[slot] = 0;
+    }
+    if (!f.enabled) {
+        f.stats.samples++;
+        return value;
+    }
+    uint32_t c0 = ESP.getCycleCount();
+    float out = signal_filter_step(&f, value, now_ms);
+    cost_cycles[slot] += ESP.getCycleCount() - c0;
+    cost_samples[slot]++;
+    return out;
+}
+
+void sensor_filter_get_stats(int slot, SignalFilterStats *out, uint32_t *cost_us_x100) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) return;
+    *out = chains[slot].stats;
+    uint32_t n = cost_samples[slot];
+    uint32_t mhz = getCpuFrequencyMhz();
+    *cost_us_x100 = (n && mhz) ? (uint32_t)(cost_cycles[slot] * 100 / n / mhz) : 0;
+}
@@ -0,0 +1,32 @@
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <stdint.h>
+#include "signal_filter.h"
+
+// Per-slot filter chains (signal_filter.h) applied by the sensor store to
+// every incoming value before it is stored, so needles, icon zones and alarms
+// all see the filtered value.
+//
+// Settings live in NVS namespace "filter" (all stages off by default) and
+// are edited on the /filters page. The fixed-point resolution of a slot
+// follows its gauge calibration. A new configuration is handed to the
+// slot's writer through a pending copy and takes effect with the next
+// sample, so the chain state is only ever touched by writers, which the
+// sensor store serialises per slot.
+
+// Load the settings and calibration ranges. Call again after either changes.
+void sensor_filter_init();
+
+void sensor_filter_get_config(int slot, SignalFilterConfig *out);
+void sensor_filter_set_config(int slot, const SignalFilterConfig *cfg);   // persists
+
+// Writer side (sensor store, holding the slot's lock): filter one value for
+// `slot`.
+float sensor_filter_apply(int slot, float value, uint32_t now_ms);
+
+// Counters for the /filters page; cost_us_x100 is the average cost per
+// sample in hundredths of a microsecond.
+void sensor_filter_get_stats(int slot, SignalFilterStats *out, uint32_t *cost_us_x100);
+
+#endif // SENSOR_FILTER_H
@@ -0,0 +1,158 @@
+#include "sensor_history.h"
+#include "signalk_config.h"   // TOTAL_PARAMS
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <math.h>
+
+static const uint32_t TIER_PERIOD_S[HIST_TIERS] = { 1, 60, 3600 };
+static const uint32_t TIER_BUCKETS[HIST_TIERS] = { 3600, 1440, 720 };
+
+// A bucket stored in a ring; idx = t_s / period + 1 (0 = never used)
+struct HistBucket {
+    uint32_t idx;
+    float min;
+    float max;
+    float mean;
+    uint32_t n;
+};
+
+struct SlotHistory {
+    HistBucket open[HIST_TIERS];      // bucket currently accumulating
+    HistBucket *ring[HIST_TIERS];     // closed buckets (PSRAM)
+    portMUX_TYPE lock;
+};
+
+static SlotHistory hist[TOTAL_PARAMS];
+static bool history_ready = false;
+
+uint32_t history_tier_period_s(HistoryTier tier) {
+    return TIER_PERIOD_S[tier < HIST_TIERS ? tier : HIST_TIER_1H];
+}
+
+uint32_t history_tier_span_s(HistoryTier tier) {
+    int t = tier < HIST_TIERS ? tier : HIST_TIER_1H;
+    return TIER_PERIOD_S[t] * TIER_BUCKETS[t];
+}
+
+bool sensor_history_init() {
+    if (history_ready) return true;
+    size_t per_slot = 0;
+    for (int t = 0; t < HIST_TIERS; t++) per_slot += TIER_BUCKETS[t];
+    HistBucket *block = (HistBucket *)heap_caps_calloc(per_slot * TOTAL_PARAMS, sizeof(HistBucket), MALLOC_CAP_SPIRAM);
+    if (block == NULL) {
+        Serial.println("[history] not enough PSRAM, value history disabled");
+        return false;
+    }
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        memset(hist[i].open, 0, sizeof(hist[i].open));
+        for (int t = 0; t < HIST_TIERS; t++) {
+            hist[i].ring[t] = block;
+            block += TIER_BUCKETS[t];
+        }
+        hist[i].lock = unlocked;
+    }
+    history_ready = true;
+    return true;
+}
+
+uint32_t sensor_history_now_s() {
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+void sensor_history_append(int slot, float value) {
+    if (!history_ready || slot < 0 || slot >= TOTAL_PARAMS || isnan(value)) return;
+    SlotHistory &h = hist[slot];
+    uint32_t t_s = sensor_history_now_s();
+    portENTER_CRITICAL(&h.lock);
+    for (int t = 0; t < HIST_TIERS; t++) {
+        HistBucket &o = h.open[t];
+        uint32_t idx = t_s / TIER_PERIOD_S[t] + 1;
+        if (o.idx != idx) {
+            if (o.n) h.ring[t][(o.idx - 1) % TIER_BUCKETS[t]] = o;
+            o.idx = idx;
+            o.min = o.max = o.mean = value;
+            o.n = 1;
+        } else {
+            if (value < o.min) o.min = value;
+            if (value > o.max) o.max = value;
+            o.n++;
+            o.mean += (value - o.mean) / (float)o.n;
+        }
+    }
+    portEXIT_CRITICAL(&h.lock);
+}
+
+HistoryTier sensor_history_pick_tier(uint32_t span_s, size_t max_points) {
+    for (int t = 0; t < HIST_TIERS; t++) {
+        uint32_t buckets = span_s / TIER_PERIOD_S[t] + 1;
+        if (span_s <= TIER_PERIOD_S[t] * TIER_BUCKETS[t] && buckets <= max_points * 8) return (HistoryTier)t;
+    }
+    return HIST_TIER_1H;
+}
+
+// Copy bucket `idx` of `tier`; false if it holds no samples
+static bool read_bucket(SlotHistory &h, int tier, uint32_t idx, HistBucket *out) {
+    bool ok = false;
+    portENTER_CRITICAL(&h.lock);
+    if (h.open[tier].idx == idx) {
+        *out = h.open[tier];
+        ok = out->n > 0;
+    } else {
+        const HistBucket &b = h.ring[tier][(idx - 1) % TIER_BUCKETS[tier]];
+        if (b.idx == idx) {
+            *out = b;
+            ok = b.n > 0;
+        }
+    }
+    portEXIT_CRITICAL(&h.lock);
+    return ok;
+}
+
+size_t sensor_history_query(int slot, HistoryTier tier, uint32_t from_s, uint32_t to_s,
+                            HistoryPoint *out, size_t max_points) {
+    if (!history_ready || slot < 0 || slot >= TOTAL_PARAMS || tier >= HIST_TIERS) return 0;
+    if (from_s > to_s || max_points == 0) return 0;
+    SlotHistory &h = hist[slot];
+    uint32_t period = TIER_PERIOD_S[tier];
+    uint32_t cap = TIER_BUCKETS[tier];
+
+    portENTER_CRITICAL(&h.lock);
+    uint32_t latest = h.open[tier].idx;
+    portEXIT_CRITICAL(&h.lock);
+    if (latest == 0) return 0;
+
+    uint32_t first = from_s / period + 1;
+    uint32_t last = to_s / period + 1;
+    if (last > latest) last = latest;
+    if (latest >= cap && first < latest - cap + 1) first = latest - cap + 1;
+    if (first > last) return 0;
+
+    uint32_t total = last - first + 1;
+    uint32_t step = (uint32_t)((total + max_points - 1) / max_points);
+    size_t count = 0;
+    for (uint32_t g = first; g <= last && count < max_points; g += step) {
+        HistoryPoint p = {};
+        uint32_t end = g + step - 1;
+        if (end > last || end < g) end = last;
+        for (uint32_t i = g; i <= end; i++) {
+            HistBucket b;
+            if (!read_bucket(h, tier, i, &b)) continue;
+            if (p.n == 0) {
+                p.t_s = (i - 1) * period;
+                p.min = b.min;
+                p.max = b.max;
+                p.mean = b.mean;
+            } else {
+                if (b.min < p.min) p.min = b.min;
+                if (b.max > p.max) p.max = b.max;
+                p.mean += (b.mean - p.mean) * ((float)b.n / (float)(p.n + b.n));
+            }
+            p.n += b.n;
+        }
+        if (p.n) out[count++] = p;
+    }
+    return count;
+}
@@ -0,0 +1,67 @@
+#ifndef SENSOR_HISTORY_H
+#define SENSOR_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-slot value history in PSRAM, kept at three resolutions:
+//
+//   tier   bucket   buckets   covers
+//   1s       1 s     3600      1 hour
+//   1m      60 s     1440     24 hours
+//   1h    3600 s      720     30 days
+//
+// Every tier accumulates min/max/mean straight from the samples, so a
+// minute's mean is exact rather than a mean of means. An append updates the
+// open bucket of each tier and, when a bucket's period is over, stores it in
+// the tier's ring: constant time, no allocation after sensor_history_init().
+// The rings take 5760 buckets of 20 bytes per slot, about 1.15 MB of PSRAM
+// for the 10 slots.
+// Each stored bucket carries its own index, so time without samples leaves
+// stale ring entries that queries skip instead of being filled in.
+//
+// Time is device uptime in seconds from the 64-bit esp_timer, so it does not
+// wrap with millis() after 49.7 days. Appends come from each slot's writer
+// (the sensor store); queries may run on any task. A short per-slot spinlock
+// keeps them consistent.
+
+enum HistoryTier {
+    HIST_TIER_1S = 0,
+    HIST_TIER_1M,
+    HIST_TIER_1H,
+    HIST_TIERS
+};
+
+struct HistoryPoint {
+    uint32_t t_s;      // start of the bucket (uptime seconds)
+    float min;
+    float max;
+    float mean;
+    uint32_t n;        // samples in the bucket
+};
+
+// Allocate the rings in PSRAM. Returns false (and history stays off) when
+// there is not enough PSRAM.
+bool sensor_history_init();
+
+// Writer side: record `value` for `slot`, received now.
+void sensor_history_append(int slot, float value);
+
+// Uptime in seconds on the history's timeline.
+uint32_t sensor_history_now_s();
+
+uint32_t history_tier_period_s(HistoryTier tier);
+uint32_t history_tier_span_s(HistoryTier tier);
+
+// Finest tier that still holds `span_s` seconds of history and needs at
+// most `max_points * 8` buckets to cover it.
+HistoryTier sensor_history_pick_tier(uint32_t span_s, size_t max_points);
+
+// Buckets of `tier` within [from_s, to_s], oldest first, including the
+// still-open current bucket. Empty buckets are skipped. When the range holds
+// more than `max_points` buckets, runs of neighbours are merged so the
+// result spans the whole range. Returns the number of points written.
+size_t sensor_history_query(int slot, HistoryTier tier, uint32_t from_s, uint32_t to_s,
+                            HistoryPoint *out, size_t max_points);
+
+#endif // SENSOR_HISTORY_H
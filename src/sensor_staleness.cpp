@@ -0,0 +1,120 @@
+#include "sensor_staleness.h"
+#include "sensor_store.h"
+#include "network_setup.h"
+#include "nmea_ingest.h"
+#include <Preferences.h>
+
+volatile uint32_t g_stale_mask = 0;
+volatile uint32_t g_revived_mask = 0;
+
+static uint16_t timeout_s[TOTAL_PARAMS];
+static uint32_t watched_mask = 0;       // slots with a path and a timeout
+static uint32_t baseline_ms = 0;        // "last update" for never-updated slots
+static uint32_t next_deadline_ms = 0;   // earliest possible expiry
+static bool deadline_armed = false;
+static uint32_t pending_changes = 0;    // from staleness_init()
+
+void staleness_init() {
+    Preferences prefs;
+    bool open = prefs.begin("stale", true);
+    uint32_t watched = 0;
+    uint32_t nmea_mask = nmea_ingest_slot_mask();
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        char key[8];
+        snprintf(key, sizeof(key), "t%d", i);
+        timeout_s[i] = open ? prefs.getUShort(key, STALE_DEFAULT_TIMEOUT_S) : STALE_DEFAULT_TIMEOUT_S;
+        if (timeout_s[i] == 0) continue;
+        if (((nmea_mask >> i) & 1u) || get_signalk_path_by_index(i).length() > 0) watched |= 1u << i;
+    }
+    if (open) prefs.end();
+
+    watched_mask = watched;
+    baseline_ms = millis();
+    // Slots no longer watched come back to life immediately
+    uint32_t unwatched_stale = __atomic_fetch_and(&g_stale_mask, watched, __ATOMIC_SEQ_CST) & ~watched;
+    pending_changes |= unwatched_stale;
+    deadline_armed = false;   // rescan on the next service call
+}
+
+uint16_t staleness_get_timeout_s(int slot) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) return 0;
+    return timeout_s[slot];
+}
+
+void staleness_set_timeout_s(int slot, uint16_t seconds) {
+    if (slot < 0 || slot >= TOTAL_PARAMS) return;
+    Preferences prefs;
+    if (prefs.begin("stale", false)) {
+        char key[8];
+        snprintf(key, sizeof(key), "t%d", slot);
+        prefs.putUShort(key, seconds);
+        prefs.end();
+    }
+}
+
+static uint32_t last_update(int slot) {
+    uint32_t rx = get_sensor_rx_ms(slot);
+    // Treat "never" and anything before the baseline as the baseline
+    if (rx == 0 || (int32_t)(rx - baseline_ms) < 0) rx = baseline_ms;
+    return rx;
+}
+
+uint32_t staleness_service(uint32_t now_ms) {
+    uint32_t changed = pending_changes;
+    pending_changes = 0;
+
+    // Revivals flagged by writers
+    uint32_t revived = __atomic_exchange_n(&g_revived_mask, 0, __ATOMIC_ACQUIRE);
+    revived &= __atomic_load_n(&g_stale_mask, __ATOMIC_RELAXED);
+    if (revived) {
+        __atomic_fetch_and(&g_stale_mask, ~revived, __ATOMIC_SEQ_CST);
+        changed |= revived;
+        deadline_armed = false;
+    }
+
+    if (deadline_armed && (int32_t)(now_ms - next_deadline_ms) < 0) return changed;
+
+    // Scan live watched slots: expire the overdue ones, find the next deadline
+    uint32_t stale = __atomic_load_n(&g_stale_mask, __ATOMIC_RELAXED);
+    uint32_t live = watched_mask & ~stale;
+    uint32_t newly_stale = 0;
+    bool have_deadline = false;
+    uint32_t deadline = 0;
+    while (live) {
+        int i = __builtin_ctz(live);
+        live &= live - 1;
+        uint32_t due = last_update(i) + (uint32_t)timeout_s[i] * 1000UL;
+        if ((int32_t)(now_ms - due) >= 0) {
+            newly_stale |= 1u << i;
+        } else if (!have_deadline || (int32_t)(due - deadline) < 0) {
+            deadline = due;
+            have_deadline = true;
+        }
+    }
+
+    if (newly_stale) {
+        __atomic_fetch_or(&g_stale_mask, newly_stale, __ATOMIC_SEQ_CST);
+        // A write that raced with the scan did not see the stale bit; undo
+        // those here (the writer publishes rx before reading the mask).
+        uint32_t m = newly_stale;
+        while (m) {
+            int i = __builtin_ctz(m);
+            m &= m - 1;
+            uint32_t due = last_update(i) + (uint32_t)timeout_s[i] * 1000UL;
+            if ((int32_t)(now_ms - due) < 0) {
+                __atomic_fetch_and(&g_stale_mask, ~(1u << i), __ATOMIC_SEQ_CST);
+                newly_stale &= ~(1u << i);
+                if (!have_deadline || (int32_t)(due - deadline) < 0) {
+                    deadline = due;
+                    have_deadline = true;
+                }
+            }
+        }
+        changed |= newly_stale;
+    }
+
+    // Nothing live to watch: check again in a second (config may change)
+    next_deadline_ms = have_deadline ? deadline : now_ms + 1000;
+    deadline_armed = true;
+    return changed;
+}
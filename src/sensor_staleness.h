@@ -0,0 +1,47 @@
+#ifndef SENSOR_STALENESS_H
+#define SENSOR_STALENESS_H
+
+#include <stdint.h>
+
+// Staleness engine: a slot that has not been updated within its timeout is
+// marked stale, and becomes live again with its next update.
+//
+// Transitions are events, not polls. Writers flag a revival with one atomic
+// OR (staleness_note_update, called by the sensor store). The UI thread calls
+// staleness_service() from a timer; it only scans the slots when the
+// earliest possible expiry has passed, and returns just the slots whose
+// state changed so the UI touches nothing else.
+//
+// Timeouts are per slot (i.e. per configured path), stored in NVS namespace
+// "stale". A timeout of 0 disables the check; slots fed by neither a Signal K
+// path nor an NMEA 0183 mapping are never stale.
+
+#define STALE_DEFAULT_TIMEOUT_S 15
+
+extern volatile uint32_t g_stale_mask;      // bit i = slot i is stale
+extern volatile uint32_t g_revived_mask;    // updates seen on stale slots
+
+// Called by the sensor store after every write to `slot`.
+static inline void staleness_note_update(int slot) {
+    uint32_t bit = 1u << slot;
+    if (__atomic_load_n(&g_stale_mask, __ATOMIC_SEQ_CST) & bit) {
+        __atomic_fetch_or(&g_revived_mask, bit, __ATOMIC_RELEASE);
+    }
+}
+
+// Load the timeouts and the set of configured slots. Call again after the
+// Signal K paths change.
+void staleness_init();
+
+uint16_t staleness_get_timeout_s(int slot);
+void staleness_set_timeout_s(int slot, uint16_t seconds);   // persists
+
+static inline bool sensor_is_stale(int slot) {
+    return (__atomic_load_n(&g_stale_mask, __ATOMIC_RELAXED) >> slot) & 1u;
+}
+
+// Advance the engine; returns the slots whose stale state changed since the
+// previous call. Call from one task only (the UI loop).
+uint32_t staleness_service(uint32_t now_ms);
+
+#endif // SENSOR_STALENESS_H
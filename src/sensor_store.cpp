@@ -0,0 +1,183 @@
+#include "sensor_store.h"
+#include "sensor_staleness.h"
+#include "sensor_filter.h"
+#include "sensor_history.h"
+#include "engine_log.h"
+#include "derived_signals.h"
+#include <string.h>
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Power-on defaults for each slot (shown until the first update arrives)
+static const float SENSOR_DEFAULTS[TOTAL_PARAMS] = {
+    0,        // SCREEN1_RPM
+    313.15,   // SCREEN1_COOLANT_TEMP
+    0,        // SCREEN2_RPM
+    50.0,     // SCREEN2_FUEL
+    313.15,   // SCREEN3_COOLANT_TEMP
+    373.15,   // SCREEN3_EXHAUST_TEMP
+    50.0,     // SCREEN4_FUEL
+    313.15,   // SCREEN4_COOLANT_TEMP
+    2.0,      // SCREEN5_OIL_PRESSURE
+    313.15    // SCREEN5_COOLANT_TEMP
+};
+
+static_assert(TOTAL_PARAMS <= 32, "dirty mask holds one bit per slot");
+
+static SensorSlot sensor_slots[TOTAL_PARAMS];
+static portMUX_TYPE slot_locks[TOTAL_PARAMS];   // writers of a slot, see set_sensor_sample()
+static bool sensor_store_seeded = false;
+
+// Everything starts dirty so the first UI pass evaluates every slot
+volatile uint32_t g_sensor_dirty_mask = (TOTAL_PARAMS >= 32) ? 0xFFFFFFFFu : ((1u << TOTAL_PARAMS) - 1);
+SensorDirtyStats g_sensor_dirty_stats = {};
+static TaskHandle_t notify_task = NULL;
+
+// Claim a slot for writing: moves seq from even to odd. Returns the odd value.
+static inline uint32_t slot_write_begin(SensorSlot &slot) {
+    uint32_t s = __atomic_load_n(&slot.seq, __ATOMIC_RELAXED);
+    for (;;) {
+        if ((s & 1) == 0 &&
+            __atomic_compare_exchange_n(&slot.seq, &s, s + 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return s + 1;
+        }
+        s = __atomic_load_n(&slot.seq, __ATOMIC_RELAXED);
+    }
+}
+
+static inline void slot_write_end(SensorSlot &slot, uint32_t odd_seq) {
+    __atomic_store_n(&slot.seq, odd_seq + 1, __ATOMIC_RELEASE);
+}
+
+// Lock-free getter for any sensor value
+float get_sensor_value(int index) {
+    if (index < 0 || index >= TOTAL_PARAMS) return 0;
+    SensorSlot &slot = sensor_slots[index];
+    for (;;) {
+        uint32_t s1 = __atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1) continue;  // writer mid-update (a few instructions)
+        float val = slot.value;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot.seq, __ATOMIC_RELAXED) == s1) return val;
+    }
+}
+
+bool get_sensor_sample(int index, SensorSample *out) {
+    if (index < 0 || index >= TOTAL_PARAMS) return false;
+    SensorSlot &slot = sensor_slots[index];
+    for (;;) {
+        uint32_t s1 = __atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1) continue;
+        out->value = slot.value;
+        out->rx_ms = slot.rx_ms;
+        out->rx_us = slot.rx_us;
+        out->sk_time_ms = slot.sk_time_ms;
+        memcpy(out->source, slot.source, sizeof(out->source));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot.seq, __ATOMIC_RELAXED) == s1) return true;
+    }
+}
+
+float get_sensor_value_stamped(int index, uint32_t *rx_us) {
+    *rx_us = 0;
+    if (index < 0 || index >= TOTAL_PARAMS) return 0;
+    SensorSlot &slot = sensor_slots[index];
+    for (;;) {
+        uint32_t s1 = __atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1) continue;
+        float val = slot.value;
+        uint32_t us = slot.rx_us;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot.seq, __ATOMIC_RELAXED) == s1) {
+            *rx_us = us;
+            return val;
+        }
+    }
+}
+
+uint32_t get_sensor_rx_ms(int index) {
+    if (index < 0 || index >= TOTAL_PARAMS) return 0;
+    return __atomic_load_n(&sensor_slots[index].rx_ms, __ATOMIC_ACQUIRE);
+}
+
+// Setter for any sensor value; readers stay lock-free
+void set_sensor_value(int index, float value) {
+    set_sensor_sample(index, value, 0, NULL, 0);
+}
+
+void set_sensor_sample(int index, float value, int64_t sk_time_ms, const char *source, size_t source_len,
+                       uint32_t rx_us) {
+    if (index < 0 || index >= TOTAL_PARAMS) return;
+    SensorSlot &slot = sensor_slots[index];
+    uint32_t now = millis();
+    if (now == 0) now = 1;
+    if (rx_us == 0) rx_us = micros();
+    if (rx_us == 0) rx_us = 1;
+    if (source_len >= SENSOR_SOURCE_MAX) source_len = SENSOR_SOURCE_MAX - 1;
+
+    // Several tasks feed slots (Signal K WS and REST, NMEA 0183, derived
+    // signals), sometimes the same one. The slot's lock serialises them so
+    // the filter chain, the stored value and the history see each sample
+    // once and in the same order. It also masks interrupts on this core, so
+    // a writer cannot be preempted while the sequence is odd.
+    portENTER_CRITICAL(&slot_locks[index]);
+    value = sensor_filter_apply(index, value, now);
+    uint32_t seq = slot_write_begin(slot);
+    // Bitwise compare so NaN -> NaN counts as unchanged
+    float old_value = slot.value;
+    bool changed = memcmp(&old_value, &value, sizeof(value)) != 0;
+    slot.value = value;
+    __atomic_store_n(&slot.rx_ms, now, __ATOMIC_RELAXED);
+    slot.rx_us = rx_us;
+    slot.sk_time_ms = sk_time_ms;
+    if (source != NULL) {
+        memcpy(slot.source, source, source_len);
+        slot.source[source_len] = '\0';
+    }
+    slot_write_end(slot, seq);
+    staleness_note_update(index);
+    sensor_history_append(index, value);
+    portEXIT_CRITICAL(&slot_locks[index]);
+
+    // Outside the lock: derived signals write other slots from here. They
+    // see unchanged values too, which keeps their own slots fresh.
+    derived_note_slot(index, value, now);
+    if (!changed) {
+        __atomic_fetch_add(&g_sensor_dirty_stats.unchanged, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    __atomic_fetch_add(&g_sensor_dirty_stats.changed, 1, __ATOMIC_RELAXED);
+    engine_log_note(index, value, now, sk_time_ms);
+    uint32_t bit = 1u << index;
+    uint32_t prev = __atomic_fetch_or(&g_sensor_dirty_mask, bit, __ATOMIC_RELEASE);
+    TaskHandle_t task = notify_task;
+    if ((prev & bit) == 0 && task != NULL) {
+        xTaskNotifyGive(task);
+        __atomic_fetch_add(&g_sensor_dirty_stats.wakes, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void sensor_mark_dirty(uint32_t mask) {
+    __atomic_fetch_or(&g_sensor_dirty_mask, mask, __ATOMIC_RELEASE);
+    TaskHandle_t task = notify_task;
+    if (task != NULL) xTaskNotifyGive(task);
+}
+
+void sensor_store_set_notify_task(void *task_handle) {
+    notify_task = (TaskHandle_t)task_handle;
+}
+
+void init_sensor_store() {
+    if (sensor_store_seeded) return;
+    sensor_store_seeded = true;
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        slot_locks[i] = unlocked;
+        portENTER_CRITICAL(&slot_locks[i]);
+        uint32_t seq = slot_write_begin(sensor_slots[i]);
+        sensor_slots[i].value = SENSOR_DEFAULTS[i];
+        slot_write_end(sensor_slots[i], seq);
+        portEXIT_CRITICAL(&slot_locks[i]);
+    }
+}
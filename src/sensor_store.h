@@ -0,0 +1,101 @@
+#ifndef SENSOR_STORE_H
+#define SENSOR_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "signalk_config.h"  // TOTAL_PARAMS, get_sensor_value/set_sensor_value
+
+// Lock-free backing store for get_sensor_value()/set_sensor_value().
+//
+// Every slot is a seqlock: the writer bumps the sequence to odd, writes the
+// payload and bumps it back to even; readers retry while the sequence is odd
+// or changed underneath them. Readers never block and never see a torn or
+// defaulted value.
+//
+// Contract: any number of writers and readers on either core. Slots are fed
+// by several tasks (Signal K WebSocket and REST, NMEA 0183, derived signals),
+// so writers of a slot serialise on its spinlock for the filter step, the
+// store and the history append; interrupts stay masked for those few
+// microseconds, so a preempted writer can never leave a reader spinning.
+// Readers never take the lock.
+//
+// Besides the value each slot records when it was last received (millis),
+// the Signal K timestamp of the update and its $source, so a live zero can
+// be told apart from a sensor that went quiet. It also carries the micros()
+// stamp of the frame the value arrived in, for the latency probe.
+//
+// A write that changes the value sets the slot's bit in g_sensor_dirty_mask
+// and, on a clean-to-dirty transition, notifies the UI task if one is
+// registered. The UI loop takes the whole mask once per pass and only
+// recomputes needles, icon zones and alarms for the slots that changed.
+
+#define SENSOR_SOURCE_MAX 32
+
+struct SensorSlot {
+    volatile uint32_t seq;   // even = stable, odd = write in progress
+    volatile float value;
+    uint32_t rx_ms;          // millis() of the last update, 0 = never
+    uint32_t rx_us;          // micros() when the frame was received, 0 = never
+    int64_t sk_time_ms;      // Signal K timestamp (epoch ms), 0 = unknown
+    char source[SENSOR_SOURCE_MAX];
+};
+
+// Change notification counters for /metrics. The first three are bumped
+// (atomically) by writers, the rest by the UI loop.
+struct SensorDirtyStats {
+    uint32_t changed;        // writes that changed a value
+    uint32_t unchanged;      // writes that only refreshed the receive time
+    uint32_t wakes;          // UI task notifications sent
+    uint32_t needle_runs;    // needle ticks that updated the visible screen
+    uint32_t needle_skips;   // needle ticks with nothing new on screen
+    uint32_t zone_evals;     // per-slot zone recomputations
+    uint32_t zone_skips;     // watched slots whose cached zone was reused
+    uint32_t needle_anims;       // needle animations started
+    uint32_t needle_suppressed;  // angle changes too small to see at the tip
+};
+
+extern volatile uint32_t g_sensor_dirty_mask;   // bit i = slot i changed
+extern SensorDirtyStats g_sensor_dirty_stats;
+
+// UI task: take (and clear) the set of slots changed since the last call.
+static inline uint32_t sensor_take_dirty() {
+    return __atomic_exchange_n(&g_sensor_dirty_mask, 0, __ATOMIC_ACQUIRE);
+}
+
+// Force a full re-evaluation of `mask` (e.g. after zones or calibration
+// changed), as if those slots had received new values.
+void sensor_mark_dirty(uint32_t mask);
+
+// Task to notify (xTaskNotifyGive) when a slot turns dirty; NULL = none.
+void sensor_store_set_notify_task(void *task_handle);
+
+// Consistent copy of one slot
+struct SensorSample {
+    float value;
+    uint32_t rx_ms;
+    uint32_t rx_us;
+    int64_t sk_time_ms;
+    char source[SENSOR_SOURCE_MAX];
+};
+
+// Seed every slot with its power-on default value (first call only).
+void init_sensor_store();
+
+// Store a value with its Signal K metadata. The value goes through the
+// slot's filter chain (sensor_filter.h) first and is then added to its
+// history (sensor_history.h). Refreshes the receive time
+// even when the value itself did not change. `source` may be NULL. `rx_us` is the
+// micros() at which the carrying frame was received (0 = now).
+void set_sensor_sample(int index, float value, int64_t sk_time_ms, const char *source, size_t source_len,
+                       uint32_t rx_us = 0);
+
+// Read value and metadata together. Returns false for a bad index.
+bool get_sensor_sample(int index, SensorSample *out);
+
+// Value plus the receive stamp (micros) of the frame it came from.
+float get_sensor_value_stamped(int index, uint32_t *rx_us);
+
+// millis() of the last update of a slot (0 = never received).
+uint32_t get_sensor_rx_ms(int index);
+
+#endif // SENSOR_STORE_H
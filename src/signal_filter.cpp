@@ -0,0 +1,130 @@
+#include "signal_filter.h"
+#include <math.h>
+#include <string.h>
+
+static inline int32_t to_q(const SignalFilterChain *f, float x) {
+    float v = x * (float)(1u << f->frac_bits);
+    if (v >= 2147483000.0f) return INT32_MAX;
+    if (v <= -2147483000.0f) return -INT32_MAX;
+    return (int32_t)lrintf(v);
+}
+
+static inline float from_q(const SignalFilterChain *f, int32_t q) {
+    return (float)q * f->lsb;
+}
+
+static inline int32_t sat32(int64_t v) {
+    if (v > INT32_MAX) return INT32_MAX;
+    if (v < -INT32_MAX) return -INT32_MAX;
+    return (int32_t)v;
+}
+
+uint8_t signal_filter_frac_bits(float max_abs) {
+    float lim = fabsf(max_abs) * 4.0f;
+    if (!(lim >= 1.0f)) lim = 1.0f;   // also catches NaN
+    int int_bits = 0;
+    while (int_bits < 30 && (float)(1u << int_bits) < lim) int_bits++;
+    int frac = 30 - int_bits;
+    if (frac > 24) frac = 24;
+    return (uint8_t)frac;
+}
+
+void signal_filter_reset(SignalFilterChain *f, const SignalFilterConfig *cfg, uint8_t frac_bits) {
+    memset(f, 0, sizeof(*f));
+    f->cfg = *cfg;
+    f->frac_bits = frac_bits > 24 ? 24 : frac_bits;
+    f->lsb = 1.0f / (float)(1u << f->frac_bits);
+
+    uint8_t n = cfg->median_n;
+    if (n > SIGNAL_FILTER_MEDIAN_MAX) n = SIGNAL_FILTER_MEDIAN_MAX;
+    if (n > 1 && (n & 1) == 0) n--;          // odd windows only
+    f->med_n = n > 1 ? n : 0;
+
+    uint8_t pct = cfg->ema_pct;
+    if (pct == 0 || pct > 100) pct = 100;
+    f->ema_alpha_q8 = (uint16_t)((pct * 256 + 50) / 100);
+    if (f->ema_alpha_q8 == 0) f->ema_alpha_q8 = 1;
+
+    f->deadband_q = cfg->deadband > 0 ? to_q(f, cfg->deadband) : 0;
+    f->slew_q_per_s = cfg->slew_per_s > 0 ? to_q(f, cfg->slew_per_s) : 0;
+    if (cfg->slew_per_s > 0 && f->slew_q_per_s == 0) f->slew_q_per_s = 1;
+
+    f->enabled = f->med_n > 0 || f->ema_alpha_q8 < 256 || f->deadband_q > 0 || f->slew_q_per_s > 0;
+}
+
+// Median of the first n entries (n <= SIGNAL_FILTER_MEDIAN_MAX)
+static int32_t median_of(const int32_t *buf, uint8_t n) {
+    int32_t tmp[SIGNAL_FILTER_MEDIAN_MAX];
+    for (uint8_t i = 0; i < n; i++) {
+        int32_t v = buf[i];
+        uint8_t j = i;
+        while (j > 0 && tmp[j - 1] > v) {
+            tmp[j] = tmp[j - 1];
+            j--;
+        }
+        tmp[j] = v;
+    }
+    return tmp[(n - 1) / 2];
+}
+
+float signal_filter_step(SignalFilterChain *f, float x, uint32_t now_ms) {
+    f->stats.samples++;
+    if (!f->enabled) return x;
+    if (isnan(x)) {
+        // No data: pass it on and start over with the next real value
+        f->primed = false;
+        f->med_count = 0;
+        f->med_pos = 0;
+        return x;
+    }
+
+    int32_t q = to_q(f, x);
+
+    if (f->med_n) {
+        f->med_buf[f->med_pos] = q;
+        f->med_pos = (uint8_t)((f->med_pos + 1) % f->med_n);
+        if (f->med_count < f->med_n) f->med_count++;
+        q = median_of(f->med_buf, f->med_count);
+    }
+
+    if (!f->primed) {
+        f->primed = true;
+        f->ema_q = f->slew_q = f->out_q = q;
+        f->last_ms = now_ms;
+        return from_q(f, q);
+    }
+
+    if (f->ema_alpha_q8 < 256) {
+        int64_t d = (int64_t)q - f->ema_q;
+        f->ema_q = sat32(f->ema_q + ((d * f->ema_alpha_q8) >> 8));
+        q = f->ema_q;
+    }
+
+    if (f->slew_q_per_s > 0) {
+        uint32_t dt = now_ms - f->last_ms;
+        if (dt > 10000) dt = 10000;
+        int64_t max_step = (int64_t)f->slew_q_per_s * dt / 1000;
+        int64_t d = (int64_t)q - f->slew_q;
+        if (d > max_step) {
+            f->slew_q = sat32(f->slew_q + max_step);
+            f->stats.slew_limited++;
+        } else if (d < -max_step) {
+            f->slew_q = sat32(f->slew_q - max_step);
+            f->stats.slew_limited++;
+        } else {
+            f->slew_q = q;
+        }
+        q = f->slew_q;
+    }
+    f->last_ms = now_ms;
+
+    if (f->deadband_q > 0) {
+        int64_t d = (int64_t)q - f->out_q;
+        if (d < 0) d = -d;
+        if (d >= f->deadband_q) f->out_q = q;
+        else f->stats.deadband_held++;
+    } else {
+        f->out_q = q;
+    }
+    return from_q(f, f->out_q);
+}
@@ -0,0 +1,64 @@
+#ifndef SIGNAL_FILTER_H
+#define SIGNAL_FILTER_H
+
+#include <stdint.h>
+
+// Fixed-point filter chain for one sensor slot:
+//
+//   median-of-N -> EMA -> slew-rate limit -> deadband
+//
+// The median removes single-sample spikes (W-terminal RPM glitches), the EMA
+// smooths sloshing tank levels, the slew limit caps how fast the needle may
+// travel and the deadband holds the output until the input has really moved,
+// so a steady but noisy value stops starting new needle animations.
+//
+// Values are converted to int32 with `frac_bits` fractional bits, chosen per
+// slot from the magnitude the gauge is calibrated for (see
+// signal_filter_frac_bits); conversions saturate instead of wrapping. No
+// allocation: all state lives in the chain. NaN passes through and restarts
+// the chain. Plain C++ with no Arduino dependencies, so the host benchmark
+// (scripts/filter_bench.cpp) runs the same code.
+
+#define SIGNAL_FILTER_MEDIAN_MAX 7
+
+struct SignalFilterConfig {
+    uint8_t median_n;     // window, odd 3..7; 0 or 1 = off
+    uint8_t ema_pct;      // weight of a new sample in percent, 1..100 (100 = off)
+    float deadband;       // hold until the value moves this far (gauge units), 0 = off
+    float slew_per_s;     // max change per second (gauge units), 0 = off
+};
+
+struct SignalFilterStats {
+    uint32_t samples;
+    uint32_t deadband_held;   // outputs held back by the deadband
+    uint32_t slew_limited;    // outputs clipped by the slew limit
+};
+
+struct SignalFilterChain {
+    SignalFilterConfig cfg;
+    bool enabled;             // any stage configured
+    bool primed;              // seen a sample since the last reset
+    uint8_t frac_bits;
+    uint8_t med_n, med_count, med_pos;
+    uint16_t ema_alpha_q8;    // 256 = off
+    float lsb;                // value of one fixed-point step
+    int32_t med_buf[SIGNAL_FILTER_MEDIAN_MAX];
+    int32_t deadband_q;
+    int32_t slew_q_per_s;
+    int32_t ema_q;
+    int32_t slew_q;
+    int32_t out_q;
+    uint32_t last_ms;
+    SignalFilterStats stats;
+};
+
+// Fractional bits that leave headroom for values up to 4x `max_abs`.
+uint8_t signal_filter_frac_bits(float max_abs);
+
+// (Re)configure and clear the chain's state and counters.
+void signal_filter_reset(SignalFilterChain *f, const SignalFilterConfig *cfg, uint8_t frac_bits);
+
+// Feed one sample received at `now_ms`; returns the filtered value.
+float signal_filter_step(SignalFilterChain *f, float x, uint32_t now_ms);
+
+#endif // SIGNAL_FILTER_H
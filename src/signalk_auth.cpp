@@ -0,0 +1,246 @@
+#include "signalk_auth.h"
+#include <HTTPClient.h>
+#include <ArduinoJson.h>
+#include <Preferences.h>
+#include <time.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#define DIAG_TAG "SKAuth"
+#define DIAG_MODULE_LEVEL DIAG_LEVEL_SIGNALK
+#include "diag_log.h"
+
+// Credentials used for /signalk/v1/auth/login
+static const char *SK_USERNAME = "pi";
+static const char *SK_PASSWORD = "raspberry";
+
+static const uint32_t LOGIN_RETRY_MS = 30000;      // after a failed login
+static const uint32_t TASK_MAX_SLEEP_MS = 60000;
+static const time_t WALL_CLOCK_VALID = 1609459200; // 2021-01-01: time() is set
+
+static String server_key = "";          // "host:port" the token belongs to
+static String server_base = "";         // "http://host:port"
+static String token = "";
+static SemaphoreHandle_t auth_mutex = NULL;
+static TaskHandle_t auth_task_handle = NULL;
+static volatile bool auth_running = false;
+static volatile bool login_requested = false;
+static volatile bool login_busy = false;
+static volatile uint32_t generation = 0;
+static uint32_t expires_at_ms = 0;      // 0 = lifetime unknown
+static uint32_t refresh_at_ms = 0;      // 0 = no proactive refresh
+static uint32_t retry_at_ms = 0;
+static SkAuthStats stats = {};
+
+// Decode the payload segment of a JWT and pull out iat/exp (seconds).
+static bool jwt_times(const String &jwt, uint32_t *iat, uint32_t *exp) {
+    int a = jwt.indexOf('.');
+    int b = a < 0 ? -1 : jwt.indexOf('.', a + 1);
+    if (a < 0 || b < 0) return false;
+    String seg = jwt.substring(a + 1, b);
+    static const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    String json;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < seg.length(); i++) {
+        const char *p = strchr(alphabet, seg[i]);
+        if (p == NULL || *p == '\0') break;
+        acc = (acc << 6) | (uint32_t)(p - alphabet);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            json += (char)((acc >> bits) & 0xFF);
+        }
+    }
+    DynamicJsonDocument doc(512);
+    if (deserializeJson(doc, json)) return false;
+    *iat = doc["iat"] | 0u;
+    *exp = doc["exp"] | 0u;
+    return *exp != 0;
+}
+
+// Set deadlines from a lifetime (seconds) starting now.
+static void schedule_from_lifetime(uint32_t lifetime_s) {
+    if (lifetime_s == 0) {
+        expires_at_ms = 0;
+        refresh_at_ms = 0;
+        return;
+    }
+    uint32_t now = millis();
+    expires_at_ms = now + lifetime_s * 1000UL;
+    refresh_at_ms = now + (lifetime_s * 1000UL / 10) * 8;
+    if (refresh_at_ms == 0) refresh_at_ms = 1;
+}
+
+static void store_token(const String &tok, uint32_t exp_epoch) {
+    Preferences prefs;
+    if (!prefs.begin("skauth", false)) return;
+    prefs.putString("server", server_key);
+    prefs.putString("token", tok);
+    prefs.putUInt("exp", exp_epoch);
+    prefs.end();
+}
+
+static void load_token() {
+    Preferences prefs;
+    if (!prefs.begin("skauth", true)) return;
+    String srv = prefs.getString("server", "");
+    String tok = prefs.getString("token", "");
+    uint32_t exp = prefs.getUInt("exp", 0);
+    prefs.end();
+    if (srv != server_key || tok.length() == 0) return;
+
+    time_t now = time(NULL);
+    if (exp != 0 && now > WALL_CLOCK_VALID) {
+        if ((time_t)exp <= now) {
+            DIAG_I("cached token expired, will log in");
+            return;
+        }
+        schedule_from_lifetime((uint32_t)(exp - now));
+    } else {
+        // No wall clock: keep using it until the server says otherwise.
+        schedule_from_lifetime(0);
+    }
+    token = tok;
+    generation++;
+    stats.nvs_reused++;
+    DIAG_I("reusing cached token for %s", server_key.c_str());
+}
+
+static bool do_login() {
+    HTTPClient http;
+    http.setTimeout(5000);
+    http.begin(server_base + "/signalk/v1/auth/login");
+    http.addHeader("Content-Type", "application/json");
+    String body = String("{\"username\":\"") + SK_USERNAME + "\",\"password\":\"" + SK_PASSWORD + "\"}";
+    int code = http.POST(body);
+    if (code != 200) {
+        http.end();
+        DIAG_W("login failed HTTP %d", code);
+        return false;
+    }
+    String response = http.getString();
+    http.end();
+
+    DynamicJsonDocument doc(1024);
+    if (deserializeJson(doc, response)) return false;
+    String tok = doc["token"].as<String>();
+    if (tok.length() == 0 || tok == "null") return false;
+
+    // Lifetime: timeToLive from the login response, else the JWT claims
+    uint32_t lifetime = doc["timeToLive"] | 0u;
+    uint32_t iat = 0, exp = 0;
+    bool has_jwt = jwt_times(tok, &iat, &exp);
+    if (lifetime == 0 && has_jwt && iat != 0 && exp > iat) lifetime = exp - iat;
+    time_t now = time(NULL);
+    uint32_t exp_epoch = has_jwt ? exp : 0;
+    if (exp_epoch == 0 && lifetime != 0 && now > WALL_CLOCK_VALID) exp_epoch = (uint32_t)now + lifetime;
+
+    xSemaphoreTake(auth_mutex, portMAX_DELAY);
+    token = tok;
+    schedule_from_lifetime(lifetime);
+    generation++;
+    xSemaphoreGive(auth_mutex);
+
+    store_token(tok, exp_epoch);
+    DIAG_I("token obtained: %.20s... (lifetime %lus)", tok.c_str(), (unsigned long)lifetime);
+    return true;
+}
+
+static void auth_task(void *parameter) {
+    (void)parameter;
+    while (auth_running) {
+        uint32_t now = millis();
+        bool refresh_due = refresh_at_ms != 0 && (int32_t)(now - refresh_at_ms) >= 0;
+        bool retry_ok = retry_at_ms == 0 || (int32_t)(now - retry_at_ms) >= 0;
+        if ((login_requested || refresh_due) && retry_ok) {
+            login_busy = true;
+            login_requested = false;
+            if (do_login()) {
+                stats.logins++;
+                retry_at_ms = 0;
+            } else {
+                // Retried on the next 401 (not before LOGIN_RETRY_MS), so a
+                // server that accepts anonymous clients is not polled.
+                stats.login_failures++;
+                retry_at_ms = millis() + LOGIN_RETRY_MS;
+                if (retry_at_ms == 0) retry_at_ms = 1;
+            }
+            login_busy = false;
+            continue;
+        }
+
+        uint32_t sleep_ms = TASK_MAX_SLEEP_MS;
+        if (refresh_at_ms != 0) {
+            int32_t d = (int32_t)(refresh_at_ms - now);
+            if (d > 0 && (uint32_t)d < sleep_ms) sleep_ms = d;
+        }
+        if (login_requested && retry_at_ms != 0) {
+            int32_t d = (int32_t)(retry_at_ms - now);
+            if (d > 0 && (uint32_t)d < sleep_ms) sleep_ms = d;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleep_ms));
+    }
+    auth_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+void sk_auth_begin(const String &host, uint16_t port, bool login_now) {
+    if (auth_mutex == NULL) auth_mutex = xSemaphoreCreateMutex();
+    server_key = host + ":" + String(port);
+    server_base = String("http://") + server_key;
+    token = "";
+    expires_at_ms = 0;
+    refresh_at_ms = 0;
+    retry_at_ms = 0;
+    load_token();
+    login_requested = login_now && (token.length() == 0);
+    login_busy = login_requested;   // reconnects wait for the first login (starts at once)
+    auth_running = true;
+    if (auth_task_handle == NULL) {
+        xTaskCreatePinnedToCore(auth_task, "SignalKAuth", 6144, NULL, 1, &auth_task_handle, 0);
+    }
+}
+
+void sk_auth_end() {
+    auth_running = false;
+    if (auth_task_handle != NULL) xTaskNotifyGive(auth_task_handle);
+}
+
+String sk_auth_header() {
+    if (auth_mutex == NULL) return String();
+    xSemaphoreTake(auth_mutex, portMAX_DELAY);
+    String h = token.length() ? String("Bearer ") + token : String();
+    xSemaphoreGive(auth_mutex);
+    return h;
+}
+
+bool sk_auth_busy() {
+    return login_busy;
+}
+
+uint32_t sk_auth_generation() {
+    return generation;
+}
+
+void sk_auth_on_unauthorized() {
+    stats.unauthorized++;
+    if (auth_mutex != NULL) {
+        xSemaphoreTake(auth_mutex, portMAX_DELAY);
+        token = "";
+        xSemaphoreGive(auth_mutex);
+    }
+    DIAG_W("server rejected token (401), logging in again");
+    // login_busy is left to auth_task: after a failed login the next one
+    // waits up to LOGIN_RETRY_MS, and reconnects and REST polls must not
+    // stall behind a login that is not running.
+    login_requested = true;
+    if (auth_task_handle != NULL) xTaskNotifyGive(auth_task_handle);
+}
+
+void sk_auth_get_stats(SkAuthStats *out) {
+    *out = stats;
+    out->has_token = token.length() > 0;
+    out->busy = login_busy;
+    out->expires_in_s = expires_at_ms ? (int32_t)(expires_at_ms - millis()) / 1000 : -1;
+}
@@ -0,0 +1,45 @@
+#ifndef SIGNALK_AUTH_H
+#define SIGNALK_AUTH_H
+
+#include <Arduino.h>
+
+// Signal K access token lifecycle.
+//
+// The token is kept in NVS together with the server it belongs to and its
+// lifetime, so reconnects and reboots reuse it without a login round trip.
+// Logins run on a small background task: proactively once ~80% of the
+// token lifetime has passed, and on demand when the server rejects the
+// token (HTTP 401 on the WebSocket handshake). The WebSocket task never
+// blocks on HTTP.
+
+struct SkAuthStats {
+    bool has_token;
+    bool busy;                  // login in flight
+    uint32_t logins;            // successful logins
+    uint32_t login_failures;
+    uint32_t unauthorized;      // 401s reported by the WS client
+    uint32_t nvs_reused;        // tokens restored from NVS at start
+    int32_t expires_in_s;       // -1 when the lifetime is unknown
+};
+
+// Load the cached token for `host:port` and start the refresh task. If no
+// token is cached and `login_now` is set, a login is started right away;
+// otherwise the first login waits for a 401.
+void sk_auth_begin(const String &host, uint16_t port, bool login_now = true);
+void sk_auth_end();
+
+// "Bearer <token>", or an empty string when there is no token.
+String sk_auth_header();
+
+// True while a login is in flight; callers may hold off a reconnect briefly.
+bool sk_auth_busy();
+
+// Bumped every time a new token is stored.
+uint32_t sk_auth_generation();
+
+// The server refused the current token: drop it and log in again.
+void sk_auth_on_unauthorized();
+
+void sk_auth_get_stats(SkAuthStats *out);
+
+#endif // SIGNALK_AUTH_H
@@ -1,34 +1,39 @@
 #include "signalk_config.h"
 #include "network_setup.h"
+#include "signalk_delta_parser.h"
+#include "signalk_ingest.h"
+#include "signalk_recorder.h"
+#include "signalk_path_index.h"
+#include "signalk_outbox.h"
+#include "signalk_auth.h"
+#include "signalk_discovery.h"
+#include "signalk_rest.h"
+#include "sensor_store.h"
+#include "sensor_staleness.h"
+#include "derived_signals.h"
+#define DIAG_TAG "SignalK"
+#define DIAG_MODULE_LEVEL DIAG_LEVEL_SIGNALK
+#include "diag_log.h"
 #include <WiFi.h>
 #include <esp_wifi.h>
 #include <WebSocketsClient.h>
 #include <ArduinoJson.h>
 #include <esp_system.h>
+#include <esp_timer.h>
+#include <esp_vfs_eventfd.h>
+#include <sys/select.h>
+#include <unistd.h>
 #include <HTTPClient.h>
 
-// Global array to hold all sensor values (10 parameters)
-float g_sensor_values[TOTAL_PARAMS] = {
-    0,        // SCREEN1_RPM
-    313.15,   // SCREEN1_COOLANT_TEMP
-    0,        // SCREEN2_RPM
-    50.0,     // SCREEN2_FUEL
-    313.15,   // SCREEN3_COOLANT_TEMP
-    373.15,   // SCREEN3_EXHAUST_TEMP
-    50.0,     // SCREEN4_FUEL
-    313.15,   // SCREEN4_COOLANT_TEMP
-    2.0,      // SCREEN5_OIL_PRESSURE
-    313.15    // SCREEN5_COOLANT_TEMP
-};
-
-// Mutex for thread-safe access to sensor variables
-SemaphoreHandle_t sensor_mutex = NULL;
-
 // WiFi and HTTP client (static to this file)
 static WebSocketsClient ws_client;
 static String server_ip_str = "";
 static uint16_t server_port_num = 0;
 static String signalk_paths[TOTAL_PARAMS];  // Array of 10 paths
+static_assert(TOTAL_PARAMS <= SK_PATH_INDEX_MAX_SLOTS, "slot masks are 32 bits wide");
+// Hashed path -> slot index used by wsEvent; rebuilt whenever paths reload
+static SkPathIndex path_index;
+static SemaphoreHandle_t path_index_mutex = NULL;
 static TaskHandle_t signalk_task_handle = NULL;
 static bool signalk_enabled = false;
 
@@ -41,185 +46,519 @@ static const unsigned long RECONNECT_BASE_MS = 2000;
 static const unsigned long RECONNECT_MAX_MS = 60000;
 static const unsigned long MESSAGE_TIMEOUT_MS = 30000; // 30s without messages => reconnect
 static const unsigned long PING_INTERVAL_MS = 15000; // send periodic ping
-
-// Outgoing message queue (simple ring buffer)
+static unsigned long last_ping_ms = 0;
+
+// signalk_task sleeps in select() on the WebSocket and a wake eventfd until
+// data arrives, another task hands it work (outbox message, subscription
+// change) or its next ping/timeout/reconnect/REST deadline is due.
+static const uint32_t PUMP_MAX_WAIT_MS = 1000;
+static int wake_fd = -1;
+static int64_t pump_started_us = 0;
+static SignalKPumpStats pump_stats = {};
+
+// Subscription policy: paths drawn on the visible screen stream every change
+// (capped at the needle refresh rate); paths only feeding alarms or hidden
+// screens are sampled at a fixed low rate by the server.
+enum SkSubClass : uint8_t { SK_SUB_NONE = 0, SK_SUB_BACKGROUND, SK_SUB_ALARM, SK_SUB_VISIBLE };
+static const unsigned int SUB_VISIBLE_MIN_PERIOD_MS = 100;
+static const unsigned int SUB_ALARM_PERIOD_MS = 2000;
+static const unsigned int SUB_BACKGROUND_PERIOD_MS = 5000;
+// Slot demand reported by the UI loop (all slots count as visible until then)
+static volatile uint32_t demand_visible_mask = 0xFFFFFFFFu;
+static volatile uint32_t demand_alarm_mask = 0;
+// What the server currently has, per path index entry (touched by signalk_task only)
+static uint8_t applied_class[SK_PATH_INDEX_CAPACITY];
+static uint32_t applied_visible_mask = 0;
+static uint32_t applied_alarm_mask = 0;
+static volatile bool full_resubscribe_pending = false;
+
+// REST polling fallback, used while the stream cannot be established. Paths
+// are polled at a per-class period; due paths are fetched in one batch.
+static const uint8_t REST_FALLBACK_AFTER_ATTEMPTS = 2;   // failed WS attempts
+static const unsigned int REST_VISIBLE_PERIOD_MS = 1000;
+static const unsigned int REST_BATCH_WINDOW_MS = 250;    // poll early to share a request
+static bool rest_active = false;
+static uint32_t rest_next_due[SK_PATH_INDEX_CAPACITY];
+static uint8_t rest_class[SK_PATH_INDEX_CAPACITY];
+static uint32_t rest_next_wake = 0;
+static uint32_t rest_visible_mask = 0;
+static uint32_t rest_alarm_mask = 0;
+static uint32_t rest_index_generation = 0;
+static uint32_t path_index_generation = 1;                // bumped on every rebuild
+static void rest_stop(const char *why);
+
+// Outgoing message queue (typed, coalescing, preallocated buffers)
 static SemaphoreHandle_t ws_queue_mutex = NULL;
-static const int OUTGOING_QUEUE_SIZE = 8;
-static String outgoing_queue[OUTGOING_QUEUE_SIZE];
-static int queue_head = 0;
-static int queue_tail = 0;
-static int queue_count = 0;
-
-// SignalK auth token
-static String sk_token = "";
-static String sk_username = "pi";
-static String sk_password = "raspberry";
-
-static bool fetch_signalk_token() {
-    HTTPClient http;
-    String url = String("http://") + server_ip_str + ":" + server_port_num + "/signalk/v1/auth/login";
-    http.begin(url);
-    http.addHeader("Content-Type", "application/json");
-    String body = String("{\"username\":\"") + sk_username + "\",\"password\":\"" + sk_password + "\"}";
-    int code = http.POST(body);
-    if (code == 200) {
-        String response = http.getString();
-        DynamicJsonDocument doc(512);
-        deserializeJson(doc, response);
-        sk_token = doc["token"].as<String>();
-        Serial.println("Signal K: token obtained: " + sk_token.substring(0,20) + "...");
-        http.end();
-        return true;
-    }
-    Serial.printf("Signal K: token fetch failed HTTP %d\n", code);
-    http.end();
-    return false;
+static SkOutbox outbox;
+
+// Time-to-first-delta bookkeeping (reconnect attempt -> first value applied)
+static unsigned long attempt_started_ms = 0;
+static bool awaiting_first_delta = false;
+static uint32_t last_auth_generation = 0;
+static SignalKConnStats conn_stats = {};
+
+// Connection plan (stream endpoint + auth), cached in NVS after it worked
+static SkConnPlan conn_plan;
+static uint8_t failed_attempts = 0;         // attempts since the last connect
+static uint8_t plan_attempts = 0;           // of those, with the current plan
+static bool attempt_used_token = false;
+static const uint8_t PLAN_MAX_FAILURES = 3; // then try the next plan
+
+// Wake signalk_task from another task (safe to call from any task)
+static void signalk_wake() {
+    if (wake_fd < 0) return;
+    uint64_t one = 1;
+    write(wake_fd, &one, sizeof(one));
 }
 
-
-static bool enqueue_outgoing(const String &msg) {
+static bool enqueue_outgoing(SkOutKind kind, const char *key, const char *msg, size_t len) {
     if (ws_queue_mutex == NULL) return false;
-    if (xSemaphoreTake(ws_queue_mutex, pdMS_TO_TICKS(100))) {
-        if (queue_count >= OUTGOING_QUEUE_SIZE) {
-            // Drop oldest to make room
-            queue_head = (queue_head + 1) % OUTGOING_QUEUE_SIZE;
-            queue_count--;
-        }
-        outgoing_queue[queue_tail] = msg;
-        queue_tail = (queue_tail + 1) % OUTGOING_QUEUE_SIZE;
-        queue_count++;
-        xSemaphoreGive(ws_queue_mutex);
-        return true;
-    }
-    return false;
+    if (!xSemaphoreTake(ws_queue_mutex, pdMS_TO_TICKS(100))) return false;
+    bool ok = sk_outbox_push(&outbox, kind, key, msg, len);
+    xSemaphoreGive(ws_queue_mutex);
+    if (!ok) DIAG_W("outgoing message too long (%u bytes), dropped", (unsigned)len);
+    else signalk_wake();
+    return ok;
+}
+
+static bool send_outgoing(SkOutKind kind, const char *body, size_t len, void *ctx) {
+    (void)kind;
+    (void)ctx;
+    if (!ws_client.isConnected()) return false;
+    return ws_client.sendTXT(body, len);
 }
 
 static void flush_outgoing() {
     if (ws_queue_mutex == NULL) return;
     if (!ws_client.isConnected()) return;
     if (!xSemaphoreTake(ws_queue_mutex, pdMS_TO_TICKS(100))) return;
-    while (queue_count > 0 && ws_client.isConnected()) {
-        String &m = outgoing_queue[queue_head];
-        ws_client.sendTXT(m);
-        queue_head = (queue_head + 1) % OUTGOING_QUEUE_SIZE;
-        queue_count--;
-    }
+    sk_outbox_drain(&outbox, send_outgoing, NULL);
     xSemaphoreGive(ws_queue_mutex);
 }
 
-// Public enqueue wrapper (declared in header)
+// Public enqueue wrappers (declared in header)
 void enqueue_signalk_message(const String &msg) {
-    if (ws_queue_mutex == NULL) return;
-    enqueue_outgoing(msg);
+    char key[SK_OUTBOX_KEY_MAX];
+    SkOutKind kind = sk_outbox_classify(msg.c_str(), msg.length(), key, sizeof(key));
+    enqueue_outgoing(kind, key, msg.c_str(), msg.length());
+}
+
+// Delta parser counters (messages/values/errors/bytes seen by wsEvent)
+static SkDeltaParseStats delta_stats = {0, 0, 0, 0, 0};
+
+// Rebuild the hashed path index from signalk_paths[]
+static void rebuild_path_index() {
+    if (path_index_mutex == NULL) {
+        path_index_mutex = xSemaphoreCreateMutex();
+    }
+    if (!xSemaphoreTake(path_index_mutex, pdMS_TO_TICKS(100))) {
+        Serial.println("[SignalK] path index busy, rebuild skipped");
+        return;
+    }
+    sk_path_index_clear(&path_index);
+    path_index_generation++;
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        // Gauges showing a derived signal are fed by derived_signals.cpp
+        if (signalk_paths[i].length() == 0 || signalk_paths[i].startsWith(DERIVED_SLOT_PREFIX)) continue;
+        if (sk_path_index_add(&path_index, signalk_paths[i].c_str(), signalk_paths[i].length(), i) < 0) {
+            Serial.printf("[SignalK] path[%d] '%s' not indexed (too long or index full)\n", i, signalk_paths[i].c_str());
+        }
+    }
+    // Paths read by derived signals, routed as slots past the gauges
+    for (int k = 0; k < derived_input_count(); k++) {
+        const char *p = derived_input_path(k);
+        if (sk_path_index_add(&path_index, p, strlen(p), TOTAL_PARAMS + k) < 0) {
+            Serial.printf("[SignalK] derived input '%s' not indexed (too long or index full)\n", p);
+        }
+    }
+    Serial.printf("[SignalK] path index: %u unique paths for %d slots\n", (unsigned)path_index.count, TOTAL_PARAMS);
+    xSemaphoreGive(path_index_mutex);
 }
 
-// Convert dot-delimited Signal K path to REST URL form
-static String build_signalk_url(const String &path) {
-    String cleaned = path;
-    cleaned.trim();
-    cleaned.replace(".", "/");
-    return String("/signalk/v1/api/vessels/self/") + cleaned;
+static uint8_t classify_entry(const SkPathEntry &e, uint32_t visible, uint32_t alarm) {
+    if (e.slot_mask & visible) return SK_SUB_VISIBLE;
+    if (e.slot_mask & alarm) return SK_SUB_ALARM;
+    return SK_SUB_BACKGROUND;
 }
 
-// Thread-safe getter for any sensor value
-float get_sensor_value(int index) {
-    if (index < 0 || index >= TOTAL_PARAMS) return 0;
-    
-    float val = 0;
-    if (sensor_mutex != NULL && xSemaphoreTake(sensor_mutex, pdMS_TO_TICKS(50))) {
-        val = g_sensor_values[index];
-        xSemaphoreGive(sensor_mutex);
+static void add_subscription(JsonArray subs, const char *path, uint8_t cls) {
+    JsonObject s = subs.createNestedObject();
+    s["path"] = path;
+    if (cls == SK_SUB_VISIBLE) {
+        s["policy"] = "instant";
+        s["minPeriod"] = SUB_VISIBLE_MIN_PERIOD_MS;
+    } else {
+        s["policy"] = "fixed";
+        s["period"] = (cls == SK_SUB_ALARM) ? SUB_ALARM_PERIOD_MS : SUB_BACKGROUND_PERIOD_MS;
     }
-    return val;
 }
 
-// Thread-safe setter for any sensor value
-void set_sensor_value(int index, float value) {
-    if (index < 0 || index >= TOTAL_PARAMS) return;
-    
-    if (sensor_mutex != NULL && xSemaphoreTake(sensor_mutex, pdMS_TO_TICKS(50))) {
-        float old = g_sensor_values[index];
-        if (old != value) {
-            g_sensor_values[index] = value;
-        } else {
-            // No change; keep as-is
+// Paths per subscribe message: at the longest path (SK_PATH_MAX_LEN) and
+// policy text a chunk stays well inside SK_OUTBOX_MSG_MAX. The server adds
+// up subscribe messages, so a large set goes out as several.
+static const uint8_t SUB_CHUNK_PATHS = 8;
+static const int SUB_CHUNKS_MAX = (SK_PATH_INDEX_CAPACITY + SUB_CHUNK_PATHS - 1) / SUB_CHUNK_PATHS;
+
+// Build the subscribe messages from the unique paths in the index, so a path
+// shared by several gauges is only subscribed (and delivered) once. Each path
+// gets the rate class of its most demanding consumer, which is recorded as
+// applied. Returns the number of messages, 0 when no paths are configured.
+static int build_subscription_payloads(String out[SUB_CHUNKS_MAX]) {
+    if (path_index_mutex == NULL || !xSemaphoreTake(path_index_mutex, pdMS_TO_TICKS(100))) return 0;
+    uint32_t visible = demand_visible_mask;
+    uint32_t alarm = demand_alarm_mask;
+    uint8_t refs = 0;
+    uint8_t fast = 0;
+    int chunks = 0;
+    for (uint8_t first = 0; first < path_index.count; first += SUB_CHUNK_PATHS) {
+        DynamicJsonDocument subdoc(2048);
+        subdoc["context"] = "vessels.self";
+        JsonArray subs = subdoc.createNestedArray("subscribe");
+        for (uint8_t id = first; id < path_index.count && id < first + SUB_CHUNK_PATHS; id++) {
+            const SkPathEntry &e = path_index.entries[id];
+            uint8_t cls = classify_entry(e, visible, alarm);
+            add_subscription(subs, e.path, cls);
+            applied_class[id] = cls;
+            refs += e.refcount;
+            if (cls == SK_SUB_VISIBLE) fast++;
+        }
+        out[chunks] = "";
+        serializeJson(subdoc, out[chunks]);
+        chunks++;
+    }
+    uint8_t unique = path_index.count;
+    applied_visible_mask = visible;
+    applied_alarm_mask = alarm;
+    xSemaphoreGive(path_index_mutex);
+    if (unique > 0) {
+        DIAG_I("subscribing %u unique paths (%u consumers, %u high-rate) in %d messages",
+               (unsigned)unique, (unsigned)refs, (unsigned)fast, chunks);
+    }
+    return chunks;
+}
+
+// Queue the current subscription set in place of any queued one and send
+// it. When the server may still hold an older set it is dropped first:
+// Signal K servers only honour an unsubscribe of everything ("context":"*",
+// "path":"*"), so a rate change cannot be applied to single paths. The
+// outbox sends oldest first, so the unsubscribe goes out before the new
+// subscribe messages. Runs in signalk_task.
+static void queue_subscription(bool unsubscribe_first, const char *why) {
+    String out[SUB_CHUNKS_MAX];
+    int chunks = build_subscription_payloads(out);
+    if (ws_queue_mutex == NULL || !xSemaphoreTake(ws_queue_mutex, pdMS_TO_TICKS(100))) {
+        full_resubscribe_pending = true;   // try again on the next pass
+        return;
+    }
+    sk_outbox_discard_kind(&outbox, SK_OUT_UNSUBSCRIBE);
+    sk_outbox_discard_kind(&outbox, SK_OUT_SUBSCRIBE);
+    if (unsubscribe_first) {
+        static const char unsub_all[] = "{\"context\":\"*\",\"unsubscribe\":[{\"path\":\"*\"}]}";
+        sk_outbox_push(&outbox, SK_OUT_UNSUBSCRIBE, "*", unsub_all, sizeof(unsub_all) - 1);
+    }
+    for (int c = 0; c < chunks; c++) {
+        char key[24];
+        snprintf(key, sizeof(key), "vessels.self#%d", c);
+        if (!sk_outbox_push(&outbox, SK_OUT_SUBSCRIBE, key, out[c].c_str(), out[c].length())) {
+            DIAG_W("subscribe message too long (%u bytes), dropped", (unsigned)out[c].length());
         }
-        xSemaphoreGive(sensor_mutex);
     }
+    xSemaphoreGive(ws_queue_mutex);
+    flush_outgoing();
+    if (chunks > 0) DIAG_I("subscription queued (%s)", why);
 }
 
-// Initialize mutex
-void init_sensor_mutex() {
-    if (sensor_mutex == NULL) {
-        sensor_mutex = xSemaphoreCreateMutex();
+// Resubscribe when the visible screen or the alarm config moved a path to
+// another rate class; a demand change that moves none costs nothing.
+static void apply_subscription_policy() {
+    uint32_t visible = demand_visible_mask;
+    uint32_t alarm = demand_alarm_mask;
+    if (visible == applied_visible_mask && alarm == applied_alarm_mask) return;
+    if (path_index_mutex == NULL || !xSemaphoreTake(path_index_mutex, pdMS_TO_TICKS(20))) return;
+    uint8_t changed = 0;
+    for (uint8_t id = 0; id < path_index.count; id++) {
+        if (classify_entry(path_index.entries[id], visible, alarm) != applied_class[id]) changed++;
+    }
+    if (changed == 0) {
+        applied_visible_mask = visible;
+        applied_alarm_mask = alarm;
     }
+    xSemaphoreGive(path_index_mutex);
+    if (changed > 0) queue_subscription(true, "new visibility");
 }
 
+void signalk_set_slot_demand(uint32_t visible_mask, uint32_t alarm_mask) {
+    // What a derived gauge is computed from is in demand with it
+    visible_mask |= derived_demand_mask(visible_mask);
+    alarm_mask |= derived_demand_mask(alarm_mask);
+    if (visible_mask == demand_visible_mask && alarm_mask == demand_alarm_mask) return;
+    demand_visible_mask = visible_mask;
+    demand_alarm_mask = alarm_mask;
+    signalk_wake();
+}
+
+// Slot sink for the shared ingest code: store with the Signal K metadata
+static void store_slot_value(int slot, float value, int64_t sk_time_ms,
+                             const char *source, size_t source_len, void *ctx) {
+    if (slot >= TOTAL_PARAMS) {
+        derived_note_input(slot - TOTAL_PARAMS, value, sk_time_ms, millis());
+        return;
+    }
+    set_sensor_sample(slot, value, sk_time_ms, source, source_len, *(const uint32_t *)ctx);
+    DIAG_D("WS Path[%d]: %f", slot, value);
+}
+
+// Routes delta/REST values through path_index (use with path_index_mutex held).
+// frame_rx_us is the micros() stamp of the frame being ingested; every slot
+// it updates carries it to the latency probe.
+static uint32_t frame_rx_us = 0;
+static SkIngest ingest = { &path_index, store_slot_value, &frame_rx_us, 0 };
+
 // WebSocket event handler
 static void wsEvent(WStype_t type, uint8_t * payload, size_t length) {
     if (type == WStype_DISCONNECTED) {
-        Serial.printf("Signal K: WS disconnected at %lums, length=%u\n", millis(), (unsigned)length);
+        awaiting_first_delta = false;
+        if (ws_client.getLastHandshakeCode() == 401) {
+            // Token rejected: get a new one in the background; the task
+            // reconnects as soon as it arrives.
+            failed_attempts = 0;
+            plan_attempts = 0;
+            if (!conn_plan.auth_required) {
+                conn_plan.auth_required = true;
+                if (conn_plan.from_cache) sk_plan_save(server_ip_str, server_port_num, conn_plan);
+            }
+            sk_auth_on_unauthorized();
+        } else {
+            DIAG_W("WS disconnected, length=%u", (unsigned)length);
+        }
     }
     if (type == WStype_ERROR) {
-        Serial.printf("Signal K: WS error, length=%u payload=%s\n", (unsigned)length, payload ? (char*)payload : "null");
+        DIAG_W("WS error, length=%u payload=%s", (unsigned)length, payload ? (char*)payload : "null");
     }
     if (type == WStype_CONNECTED) {
-        Serial.println("Signal K: WebSocket connected");
+        DIAG_I("WebSocket connected");
+        rest_stop("stream available");
         last_message_time = millis();
+        conn_stats.connects++;
+        conn_stats.connect_last_ms = last_message_time - attempt_started_ms;
+        awaiting_first_delta = true;
+        // Remember what worked so the next boot skips discovery
+        failed_attempts = 0;
+        plan_attempts = 0;
+        bool plan_changed = !conn_plan.from_cache;
+        if (!attempt_used_token && conn_plan.auth_required) {
+            conn_plan.auth_required = false;
+            plan_changed = true;
+        }
+        if (plan_changed) {
+            sk_plan_save(server_ip_str, server_port_num, conn_plan);
+            conn_plan.from_cache = true;
+        }
         // reset backoff on successful connect
         current_backoff_ms = RECONNECT_BASE_MS;
-        // Build subscription JSON
-        DynamicJsonDocument subdoc(1024);
-        subdoc["context"] = "vessels.self";
-        JsonArray subs = subdoc.createNestedArray("subscribe");
-        for (int i = 0; i < TOTAL_PARAMS; i++) {
-            if (signalk_paths[i].length() > 0) {
-                JsonObject s = subs.createNestedObject();
-                s["path"] = signalk_paths[i];
-                s["period"] = 0; // instant updates (server may push immediately)
-            }
-        }
-        String out;
-        serializeJson(subdoc, out);
-        ws_client.sendTXT(out);
-        // flush any queued outgoing messages (resubscribe, etc)
-        flush_outgoing();
+        // Subscribe once per unique path, at the rate its consumers need.
+        // This supersedes any subscription messages queued while offline
+        // (the new connection has nothing to unsubscribe); other queued
+        // messages go out with it.
+        full_resubscribe_pending = false;
+        queue_subscription(false, "connected");
         return;
     }
 
     if (type == WStype_TEXT) {
+        uint32_t rx_us = micros();
         last_message_time = millis();
-        String msg = String((char*)payload, length);
-        // Parse incoming JSON and look for updates->values
-        Serial.println("SK RAW: " + msg);  // ADD THIS LINE
-        DynamicJsonDocument doc(4096);
-        DeserializationError err = deserializeJson(doc, msg);
-        if (err) return;
-
-        if (doc.containsKey("updates")) {
-            JsonArray updates = doc["updates"].as<JsonArray>();
-            for (JsonVariant update : updates) {
-                if (!update.containsKey("values")) continue;
-                JsonArray values = update["values"].as<JsonArray>();
-                for (JsonVariant val : values) {
-                    if (!val.containsKey("path") || !val.containsKey("value")) continue;
-                    const char* path = val["path"];
-                    float value = val["value"].as<float>();
-                    for (int i = 0; i < TOTAL_PARAMS; i++) {
-                        if (signalk_paths[i].length() > 0 && signalk_paths[i].equals(path)) {
-                            set_sensor_value(i, value);
-                            // Serial logging for visibility
-                            Serial.print("WS Path["); Serial.print(i); Serial.print("]: "); Serial.println(value);
-                        }
-                    }
-                }
-            }
+        sk_rec_frame(payload, length, last_message_time);
+        // Walk the payload in place: only updates[].values[] path/value
+        // pairs are extracted, nothing is copied or allocated per frame.
+        if (path_index_mutex == NULL || !xSemaphoreTake(path_index_mutex, pdMS_TO_TICKS(50))) {
+            // The path index is being rebuilt; the frame's values are lost
+            delta_stats.frames_dropped_busy++;
+            DIAG_W("path index busy, delta frame dropped (%lu so far)",
+                   (unsigned long)delta_stats.frames_dropped_busy);
+            return;
+        }
+        frame_rx_us = rx_us;
+        int n = sk_ingest_frame(&ingest, (const char*)payload, length, &delta_stats);
+        xSemaphoreGive(path_index_mutex);
+        if (awaiting_first_delta && n > 0) {
+            uint32_t ttfd = last_message_time - attempt_started_ms;
+            awaiting_first_delta = false;
+            conn_stats.ttfd_last_ms = ttfd;
+            if (conn_stats.ttfd_min_ms == 0 || ttfd < conn_stats.ttfd_min_ms) conn_stats.ttfd_min_ms = ttfd;
+            if (ttfd > conn_stats.ttfd_max_ms) conn_stats.ttfd_max_ms = ttfd;
+            DIAG_I("first delta %lums after connect attempt", (unsigned long)ttfd);
         }
     }
     // handle pong or ping responses if available
     if (type == WStype_PONG) {
         last_message_time = millis();
-        Serial.println("Signal K: received PONG");
+        DIAG_D("received PONG");
+    }
+}
+
+// Open the WebSocket with the current token. begin() resets the client's
+// headers, so the authorization has to be set after it. A plan that keeps
+// failing is replaced in turn: cached -> discovered -> the configured
+// address with the standard stream path -> discovered again.
+static void start_ws_connection() {
+    if (plan_attempts >= PLAN_MAX_FAILURES) {
+        if (conn_plan.discovered && !conn_plan.from_cache) {
+            DIAG_W("discovered stream endpoint failed %u times, using the defaults", (unsigned)plan_attempts);
+            sk_plan_default(server_ip_str, server_port_num, &conn_plan);
+        } else {
+            DIAG_W("%s connection plan failed %u times, rediscovering",
+                   conn_plan.from_cache ? "cached" : "default", (unsigned)plan_attempts);
+            if (conn_plan.from_cache) sk_plan_invalidate();
+            sk_plan_discover(server_ip_str, server_port_num, &conn_plan);
+        }
+        plan_attempts = 0;
+    }
+    failed_attempts++;
+    plan_attempts++;
+    String auth = sk_auth_header();
+    attempt_used_token = auth.length() > 0;
+    ws_client.begin(conn_plan.host.c_str(), conn_plan.port, conn_plan.ws_path.c_str());
+    ws_client.setAuthorization(auth.c_str());
+    ws_client.onEvent(wsEvent);
+    last_auth_generation = sk_auth_generation();
+    attempt_started_ms = millis();
+    awaiting_first_delta = false;
+    conn_stats.attempts++;
+}
+
+static unsigned int rest_period_ms(uint8_t cls) {
+    if (cls == SK_SUB_VISIBLE) return REST_VISIBLE_PERIOD_MS;
+    if (cls == SK_SUB_ALARM) return SUB_ALARM_PERIOD_MS;
+    return SUB_BACKGROUND_PERIOD_MS;
+}
+
+static void rest_value_cb(const char *path, size_t path_len, float value, const SkDeltaMeta *meta, void *ctx) {
+    (void)ctx;
+    if (!xSemaphoreTake(path_index_mutex, pdMS_TO_TICKS(20))) return;
+    frame_rx_us = micros();
+    sk_ingest_value(&ingest, path, path_len, value, meta);
+    xSemaphoreGive(path_index_mutex);
+}
+
+// Poll the paths that are due (plus those due shortly, so they share the
+// request). Runs in signalk_task while rest_active.
+static void rest_poll_due(uint32_t now) {
+    uint32_t visible = demand_visible_mask;
+    uint32_t alarm = demand_alarm_mask;
+    // New paths or a screen switch may make something due before the timer
+    bool changed = rest_index_generation != path_index_generation ||
+                   visible != rest_visible_mask || alarm != rest_alarm_mask;
+    if (!changed && (int32_t)(now - rest_next_wake) < 0) return;
+    if (path_index_mutex == NULL || !xSemaphoreTake(path_index_mutex, pdMS_TO_TICKS(20))) return;
+    rest_visible_mask = visible;
+    rest_alarm_mask = alarm;
+
+    if (rest_index_generation != path_index_generation) {
+        // New path set: everything is due now
+        rest_index_generation = path_index_generation;
+        for (uint8_t id = 0; id < path_index.count; id++) {
+            rest_next_due[id] = now;
+            rest_class[id] = SK_SUB_NONE;
+        }
+    }
+
+    static char due_paths[SK_PATH_INDEX_CAPACITY][SK_PATH_MAX_LEN];
+    const char *due[SK_PATH_INDEX_CAPACITY];
+    int n = 0;
+    uint32_t wake = now + SUB_BACKGROUND_PERIOD_MS;
+    for (uint8_t id = 0; id < path_index.count; id++) {
+        uint8_t cls = classify_entry(path_index.entries[id], visible, alarm);
+        // A path that just became more important is polled right away
+        if (cls > rest_class[id]) rest_next_due[id] = now;
+        rest_class[id] = cls;
+        if ((int32_t)(now + REST_BATCH_WINDOW_MS - rest_next_due[id]) >= 0) {
+            memcpy(due_paths[n], path_index.entries[id].path, path_index.entries[id].len + 1);
+            due[n] = due_paths[n];
+            n++;
+            rest_next_due[id] = now + rest_period_ms(cls);
+        }
+        if ((int32_t)(rest_next_due[id] - wake) < 0) wake = rest_next_due[id];
+    }
+    xSemaphoreGive(path_index_mutex);
+    rest_next_wake = wake;
+
+    if (n == 0) return;
+    sk_rest_poll(server_ip_str, server_port_num, sk_auth_header(), due, n, rest_value_cb, NULL);
+}
+
+static void rest_stop(const char *why) {
+    if (!rest_active) return;
+    rest_active = false;
+    sk_rest_end();
+    DIAG_I("REST polling stopped (%s)", why);
+}
+
+// Earliest time signalk_task has to run again on its own
+static uint32_t pump_next_deadline_ms(uint32_t now) {
+    uint32_t wait_ms = PUMP_MAX_WAIT_MS;
+    auto until = [&](uint32_t at) {
+        int32_t d = (int32_t)(at - now);
+        if (d < 0) d = 0;
+        if ((uint32_t)d < wait_ms) wait_ms = (uint32_t)d;
+    };
+    if (ws_client.isConnected()) {
+        uint32_t ping_at = (last_message_time > last_ping_ms ? last_message_time : last_ping_ms) + PING_INTERVAL_MS;
+        until(ping_at);
+        until(last_message_time + MESSAGE_TIMEOUT_MS);
+    } else {
+        until(next_reconnect_at);
+        if (rest_active) until(rest_next_wake);
+    }
+    return wait_ms;
+}
+
+// Sleep until the WebSocket is readable, signalk_wake() is called or the next
+// deadline is due. Replaces the fixed 10 ms poll.
+static void pump_wait(uint32_t now) {
+    uint32_t wait_ms = pump_next_deadline_ms(now);
+    // Frames already buffered by the client are invisible to select(); run
+    // again right away while the client is still consuming them
+    static int last_pending = 0;
+    int pending = ws_client.getPendingBytes();
+    if (pending > 0) {
+        wait_ms = (pending != last_pending) ? 0 : 1;
+        pump_stats.buffered_passes++;
+    }
+    last_pending = pending;
+
+    int sock = ws_client.getSocketFd();
+    int maxfd = sock > wake_fd ? sock : wake_fd;
+    int64_t t0 = esp_timer_get_time();
+    if (maxfd < 0) {
+        // No socket and no eventfd: plain sleep, bounded so wakes stay timely
+        vTaskDelay(pdMS_TO_TICKS(wait_ms < 10 ? 10 : (wait_ms > 100 ? 100 : wait_ms)));
+        pump_stats.idle_us += esp_timer_get_time() - t0;
+        pump_stats.wakeups++;
+        pump_stats.timer_wakeups++;
+        return;
+    }
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    if (sock >= 0) FD_SET(sock, &rfds);
+    if (wake_fd >= 0) FD_SET(wake_fd, &rfds);
+    struct timeval tv = { (time_t)(wait_ms / 1000), (suseconds_t)((wait_ms % 1000) * 1000) };
+    int r = select(maxfd + 1, &rfds, NULL, NULL, &tv);
+    pump_stats.idle_us += esp_timer_get_time() - t0;
+    pump_stats.wakeups++;
+    if (r > 0) {
+        if (sock >= 0 && FD_ISSET(sock, &rfds)) pump_stats.socket_wakeups++;
+        if (wake_fd >= 0 && FD_ISSET(wake_fd, &rfds)) {
+            uint64_t v;
+            read(wake_fd, &v, sizeof(v));
+            pump_stats.notify_wakeups++;
+        }
+    } else if (r == 0) {
+        pump_stats.timer_wakeups++;
+    } else {
+        // The socket was closed under us (disconnect); don't spin on it
+        pump_stats.select_errors++;
+        vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
 
@@ -234,18 +573,30 @@ static void signalk_task(void *parameter) {
 
         unsigned long now = millis();
 
+        // Push subscription changes (config reload or visible screen change)
+        if (ws_client.isConnected()) {
+            if (full_resubscribe_pending) {
+                full_resubscribe_pending = false;
+                queue_subscription(true, "paths changed");
+            } else {
+                apply_subscription_policy();
+            }
+            if (outbox.count > 0) flush_outgoing();
+        }
+
         // send periodic ping if connected
         if (ws_client.isConnected()) {
-            if (now - last_message_time >= PING_INTERVAL_MS) {
+            if (now - last_message_time >= PING_INTERVAL_MS && now - last_ping_ms >= PING_INTERVAL_MS) {
                 ws_client.sendPing();
-                Serial.println("Signal K: sent PING");
+                last_ping_ms = now;
+                DIAG_D("sent PING");
             }
         }
 
         // detect silent drop: no messages/pongs for MESSAGE_TIMEOUT_MS
         if (ws_client.isConnected()) {
             if (now - last_message_time >= MESSAGE_TIMEOUT_MS) {
-                Serial.println("Signal K: connection idle timeout, forcing disconnect");
+                DIAG_W("connection idle timeout, forcing disconnect");
                 ws_client.disconnect();
                 // schedule reconnect with current_backoff_ms + jitter
                 unsigned int jitter = (esp_random() & 0x7FF) % 1000; // up to 1s jitter
@@ -260,16 +611,23 @@ static void signalk_task(void *parameter) {
                 // first time; schedule immediate try
                 next_reconnect_at = now + current_backoff_ms;
             }
+            // A fresh token (e.g. after a 401) makes an immediate retry worthwhile
+            if (sk_auth_generation() != last_auth_generation && !sk_auth_busy()) {
+                next_reconnect_at = now;
+                current_backoff_ms = RECONNECT_BASE_MS;
+            }
             if (now >= next_reconnect_at) {
-                if (WiFi.status() != WL_CONNECTED) {
-                    Serial.println("Signal K: WiFi not connected, skipping reconnect");
+                if (sk_auth_busy()) {
+                    // Login in flight on the auth task; retry with its token
+                    next_reconnect_at = now + 100;
+                } else if (WiFi.status() != WL_CONNECTED) {
+                    DIAG_W("WiFi not connected, skipping reconnect");
                     next_reconnect_at = now + 5000;
              } else {
-                    Serial.println("Signal K: attempting reconnect...");
+                    DIAG_I("attempting reconnect...");
                     ws_client.disconnect();
                     vTaskDelay(pdMS_TO_TICKS(200));
-                    fetch_signalk_token();
-                    { ws_client.setAuthorization((String("Bearer ") + sk_token).c_str()); ws_client.begin(server_ip_str.c_str(), server_port_num, "/signalk/v1/stream"); }                    ws_client.onEvent(wsEvent);
+                    start_ws_connection();
                     last_reconnect_attempt = now;
                     unsigned int jitter = (esp_random() & 0x7FF) % 1000;
                     next_reconnect_at = now + current_backoff_ms + jitter;
@@ -278,7 +636,20 @@ static void signalk_task(void *parameter) {
             }
         }
 
-        vTaskDelay(pdMS_TO_TICKS(10));
+        // Stream unavailable: keep the gauges fed over REST meanwhile. The
+        // reconnect schedule above keeps trying the WebSocket; the first
+        // successful connect stops the polling.
+        if (!ws_client.isConnected() && WiFi.status() == WL_CONNECTED) {
+            if (!rest_active && failed_attempts >= REST_FALLBACK_AFTER_ATTEMPTS && !sk_auth_busy()) {
+                rest_active = true;
+                rest_index_generation = 0;
+                rest_next_wake = now;
+                DIAG_W("stream unavailable after %u attempts, polling over REST", (unsigned)failed_attempts);
+            }
+            if (rest_active) rest_poll_due(now);
+        }
+
+        pump_wait(millis());
     }
 
     Serial.println("Signal K WebSocket task ended");
@@ -303,12 +674,12 @@ void enable_signalk(const char* ssid, const char* password, const char* server_i
     }
     
     Serial.println("=== Signal K paths loaded from configuration ===");
+    rebuild_path_index();
     
-    // Initialize mutex first
-    init_sensor_mutex();
     // create ws queue mutex
     if (ws_queue_mutex == NULL) {
         ws_queue_mutex = xSemaphoreCreateMutex();
+        sk_outbox_init(&outbox);
     }
     
     // WiFi should already be connected from setup_network()
@@ -318,23 +689,41 @@ void enable_signalk(const char* ssid, const char* password, const char* server_i
         return;
     }
     Serial.println("Signal K: Starting WebSocket client...");
-    fetch_signalk_token();
-    // Test basic TCP connectivity
-    {
-        HTTPClient test_http;
-        String test_url = String("http://") + server_ip_str + ":" + server_port_num + "/signalk";
-        test_http.begin(test_url);
-        int test_code = test_http.GET();
-        Serial.printf("Signal K: HTTP connectivity test code: %d\n", test_code);
-        test_http.end();
+    // Connection plan: cached from a previous boot, else from the server's
+    // discovery document (falls back to the standard stream path)
+    if (sk_plan_load(server_ip_str, server_port_num, &conn_plan)) {
+        Serial.printf("Signal K: using cached plan %s:%u%s (auth %s)\n", conn_plan.host.c_str(),
+                      (unsigned)conn_plan.port, conn_plan.ws_path.c_str(), conn_plan.auth_required ? "yes" : "no");
+    } else {
+        sk_plan_discover(server_ip_str, server_port_num, &conn_plan);
     }
+    failed_attempts = 0;
+    plan_attempts = 0;
+
+    // Cached token from NVS if there is one; otherwise, when the server
+    // needs one, a login starts in the background and the first connect
+    // waits for it in signalk_task.
+    sk_auth_begin(conn_plan.host, conn_plan.port, conn_plan.auth_required);
 
     // Initialize websocket client
-    { ws_client.setAuthorization((String("Bearer ") + sk_token).c_str()); ws_client.begin(server_ip_str.c_str(), server_port_num, "/signalk/v1/stream"); }
-    ws_client.onEvent(wsEvent);
+    if (!sk_auth_busy()) {
+        start_ws_connection();
+    } else {
+        next_reconnect_at = millis();
+    }
     // We'll manage reconnection with backoff ourselves
     ws_client.setReconnectInterval(0);
 
+    // Wake channel for the event-driven pump (falls back to short sleeps)
+    if (wake_fd < 0) {
+        esp_vfs_eventfd_config_t efd_cfg = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+        esp_err_t err = esp_vfs_eventfd_register(&efd_cfg);
+        if (err == ESP_OK || err == ESP_ERR_INVALID_STATE) wake_fd = eventfd(0, 0);
+        if (wake_fd < 0) DIAG_W("no eventfd for the WS task, falling back to timed waits");
+    }
+    pump_started_us = esp_timer_get_time();
+    memset(&pump_stats, 0, sizeof(pump_stats));
+
     // Create task to pump ws loop
     xTaskCreatePinnedToCore(
         signalk_task,
@@ -358,45 +747,54 @@ void disable_signalk() {
         signalk_task_handle = NULL;
     }
     ws_client.disconnect();
+    rest_stop("disabled");
+    sk_auth_end();
     Serial.println("Signal K disabled (WebSocket disconnected)");
 }
 
-// Rebuild the subscription list from current configuration and (re)send it
-// over the active WebSocket connection if connected. If the WS is not
-// connected, the updated paths will be used when connection is (re)established.
+// Rebuild the subscription list from current configuration and have the WS
+// task (re)send it if connected. If the WS is not connected, the updated
+// paths will be used when connection is (re)established.
 void refresh_signalk_subscriptions() {
     // Reload signalk_paths from configuration
     for (int i = 0; i < TOTAL_PARAMS; i++) {
         signalk_paths[i] = get_signalk_path_by_index(i);
         Serial.printf("[SignalK] refreshed path[%d] = '%s'\n", i, signalk_paths[i].c_str());
     }
+    rebuild_path_index();
+    staleness_init();
 
-    // Build subscription JSON (we build regardless so we can queue it if needed)
-    DynamicJsonDocument subdoc(1024);
-    subdoc["context"] = "vessels.self";
-    JsonArray subs = subdoc.createNestedArray("subscribe");
-    for (int i = 0; i < TOTAL_PARAMS; i++) {
-        if (signalk_paths[i].length() > 0) {
-            JsonObject s = subs.createNestedObject();
-            s["path"] = signalk_paths[i];
-            s["period"] = 0;
-        }
-    }
-    String out;
-    serializeJson(subdoc, out);
+    // The WS task sends the new set (after an unsubscribe-all) on its next
+    // pass, or as part of the normal subscribe when it (re)connects.
+    full_resubscribe_pending = true;
+    signalk_wake();
+}
 
-    // If connected, send; otherwise queue for later flush
-    if (ws_client.isConnected()) {
-        ws_client.sendTXT(out);
-        Serial.println("[SignalK] Sent refreshed subscription payload");
-    } else {
-        if (enqueue_outgoing(out)) {
-            Serial.println("[SignalK] WS not connected - subscription payload queued");
-        } else {
-            Serial.println("[SignalK] WS not connected - failed to queue subscription payload");
-        }
+void signalk_get_stats(SignalKStats *out) {
+    memset(out, 0, sizeof(*out));
+    out->connected = ws_client.isConnected();
+    out->delta_messages = delta_stats.messages;
+    out->delta_values = delta_stats.values;
+    out->delta_errors = delta_stats.errors;
+    out->delta_bytes = delta_stats.bytes;
+    out->delta_unmatched = ingest.unmatched;
+    out->delta_dropped_busy = delta_stats.frames_dropped_busy;
+    out->unique_paths = path_index.count;
+    out->conn = conn_stats;
+    out->plan_cached = conn_plan.from_cache;
+    out->plan_auth_required = conn_plan.auth_required;
+    out->rest_active = rest_active;
+    sk_rest_get_stats(&out->rest);
+    out->pump = pump_stats;
+    if (pump_started_us != 0) {
+        int64_t elapsed = esp_timer_get_time() - pump_started_us;
+        int64_t awake = elapsed - (int64_t)pump_stats.idle_us;
+        if (elapsed > 0 && awake > 0) out->pump_awake_permille = (uint16_t)(awake * 1000 / elapsed);
+    }
+    sk_auth_get_stats(&out->auth);
+    if (ws_queue_mutex != NULL && xSemaphoreTake(ws_queue_mutex, pdMS_TO_TICKS(50))) {
+        out->outbox = outbox.stats;
+        out->outbox_queued = outbox.count;
+        xSemaphoreGive(ws_queue_mutex);
     }
 }
-
-
-
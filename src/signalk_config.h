@@ -6,16 +6,15 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
+#include "signalk_outbox.h"
+#include "signalk_auth.h"
+#include "signalk_rest.h"
 
 // Number of screens and parameters
 #define NUM_SCREENS 5
 #define PARAMS_PER_SCREEN 2
 #define TOTAL_PARAMS (NUM_SCREENS * PARAMS_PER_SCREEN)  // 10 total
 
-// Global array to hold all sensor values (10 parameters)
-extern float g_sensor_values[TOTAL_PARAMS];
-extern SemaphoreHandle_t sensor_mutex;
-
 // Parameter indices for each screen
 enum ParamIndex {
     // Screen 1: RPM + Coolant Temp
@@ -39,7 +38,7 @@ enum ParamIndex {
     SCREEN5_COOLANT_TEMP = 9
 };
 
-// Sensor value getters/setters (thread-safe)
+// Sensor value getters/setters (lock-free, implemented in sensor_store.cpp)
 float get_sensor_value(int index);
 void set_sensor_value(int index, float value);
 
@@ -49,17 +48,64 @@ inline float get_temperature_k() { return get_sensor_value(SCREEN1_COOLANT_TEMP)
 inline void set_frequency_hz(float hz) { set_sensor_value(SCREEN1_RPM, hz); }
 inline void set_temperature_k(float temp) { set_sensor_value(SCREEN1_COOLANT_TEMP, temp); }
 
-// Mutex initialization
-void init_sensor_mutex();
-
 // Signal K control functions
 void enable_signalk(const char* ssid, const char* password, const char* server_ip, uint16_t server_port);
 void disable_signalk();
 // Rebuild and (re)send Signal K subscription list from current configuration
 void refresh_signalk_subscriptions();
 
-// Enqueue an outgoing message to be sent when WS is connected
+// Report which slots are drawn on the visible screen and which feed buzzer
+// alarms; the WS task adjusts per-path subscription rates to match.
+void signalk_set_slot_demand(uint32_t visible_mask, uint32_t alarm_mask);
+
+// Enqueue an outgoing message to be sent when WS is connected. Kind and key
+// are inferred from the JSON; a newer message with the same kind and key
+// replaces the queued one.
 void enqueue_signalk_message(const String &msg);
+
+// Connection timing; ttfd = reconnect attempt -> first delta value applied
+struct SignalKConnStats {
+    uint32_t attempts;
+    uint32_t connects;
+    uint32_t connect_last_ms;
+    uint32_t ttfd_last_ms;
+    uint32_t ttfd_min_ms;
+    uint32_t ttfd_max_ms;
+};
+
+// WS task wakeups: socket readable, woken by another task, deadline
+struct SignalKPumpStats {
+    uint32_t wakeups;
+    uint32_t socket_wakeups;
+    uint32_t notify_wakeups;
+    uint32_t timer_wakeups;
+    uint32_t buffered_passes;   // ran again for data the client had buffered
+    uint32_t select_errors;
+    uint64_t idle_us;           // time spent blocked
+};
+
+// Counters for the /metrics page
+struct SignalKStats {
+    bool connected;
+    uint32_t delta_messages;
+    uint32_t delta_values;
+    uint32_t delta_errors;
+    uint32_t delta_bytes;
+    uint32_t delta_unmatched;  // values for paths no slot uses
+    uint32_t delta_dropped_busy;  // frames dropped while the path index was rebuilt
+    uint8_t unique_paths;
+    uint8_t outbox_queued;
+    SkOutboxStats outbox;
+    SignalKConnStats conn;
+    bool plan_cached;
+    bool plan_auth_required;
+    SkAuthStats auth;
+    bool rest_active;          // polling over REST while the stream is down
+    SkRestStats rest;
+    SignalKPumpStats pump;
+    uint16_t pump_awake_permille;  // share of time the WS task was not blocked
+};
+void signalk_get_stats(SignalKStats *out);
 // Convert value to angle based on parameter type and position
 int16_t value_to_angle_for_param(float value, int param_type, int position);
 
@@ -0,0 +1,305 @@
+#include "signalk_delta_parser.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+enum FrameKind : uint8_t { FRAME_OBJECT, FRAME_ARRAY };
+
+struct Frame {
+    uint8_t kind;
+    bool values_array;   // array reached through a "values" key
+    bool candidate;      // object directly inside a values array
+    bool updates_array;  // array reached through an "updates" key
+    bool update_obj;     // object directly inside an updates array
+    bool has_value;
+    const char *path;
+    size_t path_len;
+    float value;
+    SkDeltaMeta meta;    // update_obj only
+    int pending_start;   // update_obj only: first pending value it owns
+};
+
+struct Pending {
+    const char *path;
+    size_t path_len;
+    float value;
+};
+
+struct Cursor {
+    const char *buf;
+    size_t len;
+    size_t pos;
+};
+
+inline bool is_ws(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline void skip_ws(Cursor &c) {
+    while (c.pos < c.len && is_ws(c.buf[c.pos])) c.pos++;
+}
+
+inline bool key_is(const char *key, size_t key_len, const char *lit, size_t lit_len) {
+    return key_len == lit_len && memcmp(key, lit, lit_len) == 0;
+}
+
+// Scan a string starting at the opening quote. On success `out`/`out_len`
+// cover the raw (still escaped) contents and the cursor sits past the
+// closing quote.
+bool scan_string(Cursor &c, const char **out, size_t *out_len) {
+    c.pos++; // opening quote
+    size_t start = c.pos;
+    while (c.pos < c.len) {
+        char ch = c.buf[c.pos];
+        if (ch == '\\') {
+            c.pos += 2;
+            continue;
+        }
+        if (ch == '"') {
+            *out = c.buf + start;
+            *out_len = c.pos - start;
+            c.pos++;
+            return true;
+        }
+        c.pos++;
+    }
+    return false;
+}
+
+// Scan a bare literal (number, true, false, null). Sets `is_number` and,
+// for numbers, `number`.
+bool scan_literal(Cursor &c, bool *is_number, float *number) {
+    size_t start = c.pos;
+    while (c.pos < c.len) {
+        char ch = c.buf[c.pos];
+        if (ch == ',' || ch == '}' || ch == ']' || is_ws(ch)) break;
+        c.pos++;
+    }
+    size_t n = c.pos - start;
+    if (n == 0) return false;
+    char first = c.buf[start];
+    if (first == '-' || (first >= '0' && first <= '9')) {
+        // Copy into a small stack buffer: the payload is not guaranteed to
+        // be NUL-terminated right after the token.
+        char tmp[32];
+        if (n >= sizeof(tmp)) return false;
+        memcpy(tmp, c.buf + start, n);
+        tmp[n] = '\0';
+        char *end = nullptr;
+        float v = strtof(tmp, &end);
+        if (end != tmp + n) return false;
+        *is_number = true;
+        *number = v;
+        return true;
+    }
+    *is_number = false;
+    return key_is(c.buf + start, n, "true", 4) ||
+           key_is(c.buf + start, n, "false", 5) ||
+           key_is(c.buf + start, n, "null", 4);
+}
+
+inline int find_update(Frame *stack, int depth) {
+    for (int i = depth - 1; i >= 0; i--) {
+        if (stack[i].update_obj) return i;
+    }
+    return -1;
+}
+
+} // namespace
+
+int sk_parse_delta(const char *buf, size_t len, sk_delta_value_cb cb, void *ctx,
+                   SkDeltaParseStats *stats) {
+    Frame stack[SK_DELTA_MAX_DEPTH];
+    int depth = 0;
+    int reported = 0;
+    Pending pending[SK_DELTA_MAX_PENDING];
+    int pending_count = 0;
+    Cursor c = { buf, len, 0 };
+
+    // Key of the object member whose value is about to be parsed.
+    const char *key = nullptr;
+    size_t key_len = 0;
+    // True when the next token must be an object key (or '}').
+    bool expect_key = false;
+    bool ok = false;
+
+    if (stats) {
+        stats->messages++;
+        stats->bytes += (uint32_t)len;
+    }
+
+    for (;;) {
+        skip_ws(c);
+        if (c.pos >= c.len) break;
+        char ch = c.buf[c.pos];
+
+        if (expect_key) {
+            if (ch == '}') {
+                // Empty object: fall through to the close handling below.
+            } else {
+                if (ch != '"') break;
+                if (!scan_string(c, &key, &key_len)) break;
+                skip_ws(c);
+                if (c.pos >= c.len || c.buf[c.pos] != ':') break;
+                c.pos++;
+                expect_key = false;
+                continue;
+            }
+        }
+
+        Frame *parent = depth > 0 ? &stack[depth - 1] : nullptr;
+
+        if (ch == '{' || ch == '[') {
+            if (depth >= SK_DELTA_MAX_DEPTH) break;
+            Frame &f = stack[depth++];
+            f.kind = (ch == '{') ? FRAME_OBJECT : FRAME_ARRAY;
+            f.values_array = f.kind == FRAME_ARRAY && parent && parent->kind == FRAME_OBJECT &&
+                             key_is(key, key_len, "values", 6);
+            f.candidate = f.kind == FRAME_OBJECT && parent && parent->kind == FRAME_ARRAY &&
+                          parent->values_array;
+            f.updates_array = f.kind == FRAME_ARRAY && parent && parent->kind == FRAME_OBJECT &&
+                              key_is(key, key_len, "updates", 7);
+            f.update_obj = f.kind == FRAME_OBJECT && parent && parent->kind == FRAME_ARRAY &&
+                           parent->updates_array;
+            f.meta = SkDeltaMeta{ nullptr, 0, nullptr, 0 };
+            f.pending_start = pending_count;
+            f.has_value = false;
+            f.path = nullptr;
+            f.path_len = 0;
+            f.value = 0.0f;
+            c.pos++;
+            expect_key = (f.kind == FRAME_OBJECT);
+            continue;
+        } else if (ch == '}' || ch == ']') {
+            if (!parent) break;
+            if ((ch == '}') != (parent->kind == FRAME_OBJECT)) break;
+            c.pos++;
+            if (parent->candidate && parent->path && parent->has_value) {
+                int u = find_update(stack, depth - 1);
+                if (u >= 0 && pending_count < SK_DELTA_MAX_PENDING) {
+                    pending[pending_count++] = Pending{ parent->path, parent->path_len, parent->value };
+                } else {
+                    if (cb) cb(parent->path, parent->path_len, parent->value, u >= 0 ? &stack[u].meta : nullptr, ctx);
+                    reported++;
+                }
+            }
+            if (parent->update_obj) {
+                for (int i = parent->pending_start; i < pending_count; i++) {
+                    if (cb) cb(pending[i].path, pending[i].path_len, pending[i].value, &parent->meta, ctx);
+                    reported++;
+                }
+                pending_count = parent->pending_start;
+            }
+            depth--;
+            expect_key = false;
+            if (depth == 0) {
+                ok = true;
+                break;
+            }
+        } else if (ch == '"') {
+            const char *s;
+            size_t s_len;
+            if (!scan_string(c, &s, &s_len)) break;
+            if (parent && parent->candidate && key_is(key, key_len, "path", 4)) {
+                parent->path = s;
+                parent->path_len = s_len;
+            } else if (parent && parent->update_obj) {
+                if (key_is(key, key_len, "timestamp", 9)) {
+                    parent->meta.timestamp = s;
+                    parent->meta.timestamp_len = s_len;
+                } else if (key_is(key, key_len, "$source", 7)) {
+                    parent->meta.source = s;
+                    parent->meta.source_len = s_len;
+                }
+            }
+        } else {
+            bool is_number = false;
+            float number = 0.0f;
+            if (!scan_literal(c, &is_number, &number)) break;
+            if (parent && parent->candidate && is_number && key_is(key, key_len, "value", 5)) {
+                parent->has_value = true;
+                parent->value = number;
+            }
+        }
+
+        if (depth == 0) break; // scalar at top level: not a delta
+        skip_ws(c);
+        if (c.pos >= c.len) break;
+        ch = c.buf[c.pos];
+        if (ch == ',') {
+            c.pos++;
+            expect_key = (stack[depth - 1].kind == FRAME_OBJECT);
+        }
+        // '}' / ']' are consumed on the next iteration.
+    }
+
+    // Malformed frame: still hand out what was collected, with whatever
+    // metadata was seen before the error.
+    for (int i = 0; i < pending_count; i++) {
+        int u = find_update(stack, depth);
+        if (cb) cb(pending[i].path, pending[i].path_len, pending[i].value, u >= 0 ? &stack[u].meta : nullptr, ctx);
+        reported++;
+    }
+
+    if (stats) {
+        stats->values += (uint32_t)reported;
+        if (!ok) stats->errors++;
+    }
+    return ok ? reported : -1;
+}
+
+static bool read_digits(const char *s, size_t len, size_t pos, int n, int *out) {
+    if (pos + n > len) return false;
+    int v = 0;
+    for (int i = 0; i < n; i++) {
+        char c = s[pos + i];
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + (c - '0');
+    }
+    *out = v;
+    return true;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date.
+static int64_t days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+bool sk_parse_timestamp_ms(const char *s, size_t len, int64_t *out_ms) {
+    int y, mo, d, h, mi, sec;
+    if (!read_digits(s, len, 0, 4, &y) || len < 19 || s[4] != '-' ||
+        !read_digits(s, len, 5, 2, &mo) || s[7] != '-' ||
+        !read_digits(s, len, 8, 2, &d) || (s[10] != 'T' && s[10] != ' ') ||
+        !read_digits(s, len, 11, 2, &h) || s[13] != ':' ||
+        !read_digits(s, len, 14, 2, &mi) || s[16] != ':' ||
+        !read_digits(s, len, 17, 2, &sec)) {
+        return false;
+    }
+    if (mo < 1 || mo > 12 || d < 1 || d > 31 || h > 23 || mi > 59 || sec > 60) return false;
+    size_t pos = 19;
+    int ms = 0;
+    if (pos < len && s[pos] == '.') {
+        pos++;
+        int scale = 100;
+        while (pos < len && s[pos] >= '0' && s[pos] <= '9') {
+            ms += (s[pos] - '0') * scale;
+            scale /= 10;
+            pos++;
+        }
+    }
+    int64_t offset_s = 0;
+    if (pos < len && (s[pos] == '+' || s[pos] == '-')) {
+        int oh, om;
+        if (!read_digits(s, len, pos + 1, 2, &oh) || !read_digits(s, len, pos + 4, 2, &om)) return false;
+        offset_s = (int64_t)(oh * 3600 + om * 60) * (s[pos] == '+' ? 1 : -1);
+    }
+    int64_t secs = days_from_civil(y, mo, d) * 86400 + h * 3600 + mi * 60 + sec - offset_s;
+    *out_ms = secs * 1000 + ms;
+    return true;
+}
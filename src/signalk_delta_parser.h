@@ -0,0 +1,57 @@
+#ifndef SIGNALK_DELTA_PARSER_H
+#define SIGNALK_DELTA_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Streaming, zero-copy parser for Signal K delta frames.
+//
+// Walks the raw WebSocket payload in place and reports every
+// `updates[].values[]` entry whose "value" is numeric, together with the
+// update's "timestamp" and "$source". Everything else
+// (context, source objects, meta, non-numeric values) is skipped without
+// being materialised. Nothing is allocated; the path handed to the callback
+// points into the caller's buffer and is only valid during the callback.
+//
+// Plain C++ with no Arduino dependencies so it can also be built on a host.
+
+// Maximum JSON nesting depth tracked by the parser. Signal K deltas nest
+// 5-6 levels deep (root/updates/update/values/value/object).
+#define SK_DELTA_MAX_DEPTH 16
+
+// Values kept back until their update's timestamp/$source are known (these
+// may follow "values" in the update object).
+#define SK_DELTA_MAX_PENDING 32
+
+// Per-update metadata handed along with each value. Pointers refer into the
+// caller's buffer (raw, still escaped) and are NULL when absent.
+struct SkDeltaMeta {
+    const char *timestamp;
+    size_t timestamp_len;
+    const char *source;      // "$source"
+    size_t source_len;
+};
+
+// Called once per numeric path/value pair found in a delta.
+typedef void (*sk_delta_value_cb)(const char *path, size_t path_len, float value,
+                                  const SkDeltaMeta *meta, void *ctx);
+
+// Running counters, updated by sk_parse_delta() when a stats pointer is given.
+struct SkDeltaParseStats {
+    uint32_t messages;   // frames handed to the parser
+    uint32_t values;     // path/value pairs reported
+    uint32_t errors;     // malformed or too deeply nested frames
+    uint32_t bytes;      // payload bytes scanned
+    uint32_t frames_dropped_busy;   // not parsed: the caller's path index was busy (caller counts)
+};
+
+// Parse one delta frame. Returns the number of values reported, or -1 if the
+// frame is not valid JSON (values found before the error are still reported).
+int sk_parse_delta(const char *buf, size_t len, sk_delta_value_cb cb, void *ctx,
+                   SkDeltaParseStats *stats = nullptr);
+
+// Parse an ISO 8601 UTC timestamp ("2024-05-01T12:34:56.789Z") into
+// milliseconds since the Unix epoch. Returns false if it is malformed.
+bool sk_parse_timestamp_ms(const char *s, size_t len, int64_t *out_ms);
+
+#endif // SIGNALK_DELTA_PARSER_H
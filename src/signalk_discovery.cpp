@@ -0,0 +1,139 @@
+#include "signalk_discovery.h"
+#include <HTTPClient.h>
+#include <ArduinoJson.h>
+#include <Preferences.h>
+#define DIAG_TAG "SKDisc"
+#define DIAG_MODULE_LEVEL DIAG_LEVEL_SIGNALK
+#include "diag_log.h"
+
+static const char *DEFAULT_WS_PATH = "/signalk/v1/stream";
+static const uint8_t PLAN_VERSION = 2;   // 2: host is always the configured one
+
+void sk_plan_default(const String &host, uint16_t port, SkConnPlan *out) {
+    out->host = host;
+    out->port = port;
+    out->ws_path = DEFAULT_WS_PATH;
+    out->auth_required = true;      // unknown: assume a token is needed
+    out->server_id = "";
+    out->server_version = "";
+    out->api_version = "";
+    out->from_cache = false;
+    out->discovered = false;
+}
+
+static String server_key(const String &host, uint16_t port) {
+    return host + ":" + String(port);
+}
+
+bool sk_plan_load(const String &host, uint16_t port, SkConnPlan *out) {
+    Preferences prefs;
+    if (!prefs.begin("skplan", true)) return false;
+    bool ok = prefs.getUChar("ver", 0) == PLAN_VERSION &&
+              prefs.getString("server", "") == server_key(host, port);
+    if (ok) {
+        out->host = prefs.getString("host", host);
+        out->port = prefs.getUShort("port", port);
+        out->ws_path = prefs.getString("path", DEFAULT_WS_PATH);
+        out->auth_required = prefs.getBool("auth", true);
+        out->server_id = prefs.getString("id", "");
+        out->server_version = prefs.getString("sver", "");
+        out->api_version = prefs.getString("aver", "");
+        out->from_cache = true;
+        out->discovered = true;
+    }
+    prefs.end();
+    return ok;
+}
+
+void sk_plan_save(const String &host, uint16_t port, const SkConnPlan &plan) {
+    Preferences prefs;
+    if (!prefs.begin("skplan", false)) return;
+    prefs.putString("server", server_key(host, port));
+    prefs.putString("host", plan.host);
+    prefs.putUShort("port", plan.port);
+    prefs.putString("path", plan.ws_path);
+    prefs.putBool("auth", plan.auth_required);
+    prefs.putString("id", plan.server_id);
+    prefs.putString("sver", plan.server_version);
+    prefs.putString("aver", plan.api_version);
+    prefs.putUChar("ver", PLAN_VERSION);
+    prefs.end();
+}
+
+void sk_plan_invalidate() {
+    Preferences prefs;
+    if (!prefs.begin("skplan", false)) return;
+    prefs.clear();
+    prefs.end();
+}
+
+// Split "ws://host:port/path" into its parts. Only plain ws:// is usable:
+// the client is built without TLS.
+static bool parse_ws_url(const String &url, String *host, uint16_t *port, String *path) {
+    if (!url.startsWith("ws://")) return false;
+    int start = 5;
+    int slash = url.indexOf('/', start);
+    String authority = slash < 0 ? url.substring(start) : url.substring(start, slash);
+    *path = slash < 0 ? String("/") : url.substring(slash);
+    int colon = authority.lastIndexOf(':');
+    if (colon >= 0) {
+        *host = authority.substring(0, colon);
+        *port = (uint16_t)authority.substring(colon + 1).toInt();
+    } else {
+        *host = authority;
+        *port = 80;
+    }
+    return host->length() > 0 && *port != 0;
+}
+
+bool sk_plan_discover(const String &host, uint16_t port, SkConnPlan *out) {
+    sk_plan_default(host, port, out);
+
+    HTTPClient http;
+    http.setTimeout(3000);
+    http.begin(String("http://") + server_key(host, port) + "/signalk");
+    int code = http.GET();
+    if (code != 200) {
+        DIAG_W("discovery GET /signalk failed HTTP %d, using defaults", code);
+        http.end();
+        return false;
+    }
+    String body = http.getString();
+    http.end();
+
+    // Only keep the members we use
+    StaticJsonDocument<128> filter;
+    filter["endpoints"]["v1"]["version"] = true;
+    filter["endpoints"]["v1"]["signalk-ws"] = true;
+    filter["server"]["id"] = true;
+    filter["server"]["version"] = true;
+    DynamicJsonDocument doc(768);
+    if (deserializeJson(doc, body, DeserializationOption::Filter(filter))) {
+        DIAG_W("discovery document not parseable, using defaults");
+        return false;
+    }
+
+    out->server_id = doc["server"]["id"] | "";
+    out->server_version = doc["server"]["version"] | "";
+    out->api_version = doc["endpoints"]["v1"]["version"] | "";
+    String ws_url = doc["endpoints"]["v1"]["signalk-ws"] | "";
+    String ws_host;
+    uint16_t ws_port = 0;
+    String ws_path;
+    if (parse_ws_url(ws_url, &ws_host, &ws_port, &ws_path)) {
+        // Keep the address we reached the server on. What it advertises is
+        // often its loopback name, a hostname or .local name the display
+        // cannot resolve, or an address on another interface or container
+        // network; only the port and path are taken from it.
+        if (ws_host != host) DIAG_D("server advertises stream host %s, keeping %s", ws_host.c_str(), host.c_str());
+        out->port = ws_port;
+        out->ws_path = ws_path;
+    } else if (ws_url.length() > 0) {
+        DIAG_W("unsupported stream endpoint '%s', using default path", ws_url.c_str());
+    }
+    out->discovered = true;
+    DIAG_I("discovered %s %s (API %s), stream %s:%u%s", out->server_id.c_str(),
+           out->server_version.c_str(), out->api_version.c_str(),
+           out->host.c_str(), (unsigned)out->port, out->ws_path.c_str());
+    return true;
+}
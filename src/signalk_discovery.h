@@ -0,0 +1,41 @@
+#ifndef SIGNALK_DISCOVERY_H
+#define SIGNALK_DISCOVERY_H
+
+#include <Arduino.h>
+
+// Signal K connection plan: where the delta stream lives and whether it
+// needs a token. Built from the server's discovery document (GET /signalk)
+// once, then cached in NVS keyed by the configured host:port so later boots
+// open the WebSocket straight away. The cache is dropped when connecting
+// with it keeps failing. The host is always the configured one; discovery
+// only supplies the stream's port and path.
+
+struct SkConnPlan {
+    String host;
+    uint16_t port;
+    String ws_path;             // e.g. "/signalk/v1/stream"
+    bool auth_required;         // learnt: 401 seen / connected without token
+    String server_id;           // discovery "server.id"
+    String server_version;      // discovery "server.version"
+    String api_version;         // discovery "endpoints.v1.version"
+    bool from_cache;            // loaded from NVS rather than discovered
+    bool discovered;            // false => built-in defaults
+};
+
+// Defaults used when discovery is not possible.
+void sk_plan_default(const String &host, uint16_t port, SkConnPlan *out);
+
+// Load the cached plan for the configured server. Returns false if none.
+bool sk_plan_load(const String &host, uint16_t port, SkConnPlan *out);
+
+// Fetch and parse the discovery document (blocking HTTP, short timeout).
+// Falls back to the defaults and returns false when it cannot be read.
+bool sk_plan_discover(const String &host, uint16_t port, SkConnPlan *out);
+
+// Cache `plan` for the configured server `host:port`.
+void sk_plan_save(const String &host, uint16_t port, const SkConnPlan &plan);
+
+// Forget the cached plan.
+void sk_plan_invalidate();
+
+#endif // SIGNALK_DISCOVERY_H
@@ -0,0 +1,31 @@
+#include "signalk_ingest.h"
+
+void sk_ingest_value(SkIngest *in, const char *path, size_t path_len, float value, const SkDeltaMeta *meta) {
+    const SkPathEntry *e = sk_path_index_find(in->index, path, path_len);
+    if (e == NULL) {
+        in->unmatched++;
+        return;
+    }
+    int64_t sk_time_ms = 0;
+    const char *source = NULL;
+    size_t source_len = 0;
+    if (meta != NULL) {
+        if (meta->timestamp != NULL) sk_parse_timestamp_ms(meta->timestamp, meta->timestamp_len, &sk_time_ms);
+        source = meta->source;
+        source_len = meta->source_len;
+    }
+    uint32_t mask = e->slot_mask;
+    while (mask) {
+        int i = __builtin_ctz(mask);
+        mask &= mask - 1;
+        in->sink(i, value, sk_time_ms, source, source_len, in->sink_ctx);
+    }
+}
+
+static void ingest_value_cb(const char *path, size_t path_len, float value, const SkDeltaMeta *meta, void *ctx) {
+    sk_ingest_value((SkIngest *)ctx, path, path_len, value, meta);
+}
+
+int sk_ingest_frame(SkIngest *in, const char *buf, size_t len, SkDeltaParseStats *stats) {
+    return sk_parse_delta(buf, len, ingest_value_cb, in, stats);
+}
@@ -0,0 +1,34 @@
+#ifndef SIGNALK_INGEST_H
+#define SIGNALK_INGEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "signalk_delta_parser.h"
+#include "signalk_path_index.h"
+
+// Delta frame -> sensor slot routing, the part of the WebSocket handler that
+// does the work: parse the frame, look each path up in the index, decode the
+// update timestamp and hand the value to every slot fed by that path.
+//
+// The slot store is reached through a sink so the same code runs in the
+// firmware (sink = set_sensor_sample) and in the host replayer
+// (scripts/sk_replay.cpp). Plain C++ with no Arduino dependencies.
+
+typedef void (*sk_slot_sink)(int slot, float value, int64_t sk_time_ms,
+                             const char *source, size_t source_len, void *ctx);
+
+struct SkIngest {
+    const SkPathIndex *index;
+    sk_slot_sink sink;
+    void *sink_ctx;
+    uint32_t unmatched;      // values for paths no slot is fed by
+};
+
+// Route one value (e.g. from the REST poller). The caller holds whatever
+// lock protects `index`.
+void sk_ingest_value(SkIngest *in, const char *path, size_t path_len, float value, const SkDeltaMeta *meta);
+
+// Parse and route one delta frame. Returns what sk_parse_delta() returns.
+int sk_ingest_frame(SkIngest *in, const char *buf, size_t len, SkDeltaParseStats *stats);
+
+#endif // SIGNALK_INGEST_H
@@ -0,0 +1,142 @@
+#include "signalk_outbox.h"
+#include <string.h>
+
+void sk_outbox_init(SkOutbox *box) {
+    for (int i = 0; i < SK_OUTBOX_SLOTS; i++) box->slots[i].used = false;
+    box->count = 0;
+    box->next_seq = 0;
+    memset(&box->stats, 0, sizeof(box->stats));
+}
+
+static int find_oldest(const SkOutbox *box, bool keyless_only) {
+    int best = -1;
+    for (int i = 0; i < SK_OUTBOX_SLOTS; i++) {
+        const SkOutMsg &m = box->slots[i];
+        if (!m.used) continue;
+        if (keyless_only && m.key[0] != '\0') continue;
+        if (best < 0 || (int32_t)(m.seq - box->slots[best].seq) < 0) best = i;
+    }
+    return best;
+}
+
+bool sk_outbox_push(SkOutbox *box, SkOutKind kind, const char *key, const char *body, size_t len) {
+    if (len >= SK_OUTBOX_MSG_MAX) {
+        box->stats.oversize++;
+        return false;
+    }
+    if (key == NULL) key = "";
+    size_t key_len = strnlen(key, SK_OUTBOX_KEY_MAX - 1);
+
+    int target = -1;
+    if (key_len > 0) {
+        for (int i = 0; i < SK_OUTBOX_SLOTS; i++) {
+            const SkOutMsg &m = box->slots[i];
+            if (m.used && m.kind == kind && strncmp(m.key, key, SK_OUTBOX_KEY_MAX) == 0) {
+                target = i;
+                box->stats.coalesced++;
+                break;
+            }
+        }
+    }
+    if (target < 0) {
+        if (box->count >= SK_OUTBOX_SLOTS) {
+            target = find_oldest(box, true);
+            if (target < 0) target = find_oldest(box, false);
+            box->stats.dropped++;
+        } else {
+            for (int i = 0; i < SK_OUTBOX_SLOTS; i++) {
+                if (!box->slots[i].used) { target = i; break; }
+            }
+            box->count++;
+        }
+    }
+
+    SkOutMsg &m = box->slots[target];
+    m.used = true;
+    m.kind = kind;
+    m.len = (uint16_t)len;
+    m.seq = box->next_seq++;   // a coalesced message moves to the back
+    memcpy(m.key, key, key_len);
+    m.key[key_len] = '\0';
+    memcpy(m.body, body, len);
+    m.body[len] = '\0';
+    box->stats.enqueued++;
+    return true;
+}
+
+// Copy the string value following `"name":` into `out`. Returns false when
+// the member is not present or not a string.
+static bool json_string_member(const char *body, size_t len, const char *name, char *out, size_t cap) {
+    size_t name_len = strlen(name);
+    const char *end = body + len;
+    for (const char *p = body; p + name_len + 2 < end; p++) {
+        if (*p != '"' || memcmp(p + 1, name, name_len) != 0 || p[name_len + 1] != '"') continue;
+        const char *q = p + name_len + 2;
+        while (q < end && (*q == ' ' || *q == ':' || *q == '\t')) q++;
+        if (q >= end || *q != '"') return false;
+        q++;
+        size_t n = 0;
+        while (q < end && *q != '"' && n + 1 < cap) out[n++] = *q++;
+        out[n] = '\0';
+        return true;
+    }
+    return false;
+}
+
+static bool has_member(const char *body, size_t len, const char *quoted) {
+    size_t n = strlen(quoted);
+    for (size_t i = 0; i + n <= len; i++) {
+        if (memcmp(body + i, quoted, n) == 0) return true;
+    }
+    return false;
+}
+
+SkOutKind sk_outbox_classify(const char *body, size_t len, char *key, size_t key_cap) {
+    if (key_cap == 0) return SK_OUT_OTHER;
+    key[0] = '\0';
+    bool unsubscribe = has_member(body, len, "\"unsubscribe\"");
+    if (unsubscribe || has_member(body, len, "\"subscribe\"")) {
+        if (!json_string_member(body, len, "context", key, key_cap)) {
+            strncpy(key, "vessels.self", key_cap - 1);
+            key[key_cap - 1] = '\0';
+        }
+        return unsubscribe ? SK_OUT_UNSUBSCRIBE : SK_OUT_SUBSCRIBE;
+    }
+    if (has_member(body, len, "\"put\"")) {
+        if (!json_string_member(body, len, "path", key, key_cap)) key[0] = '\0';
+        return key[0] ? SK_OUT_PUT : SK_OUT_OTHER;
+    }
+    if (has_member(body, len, "\"notifications.")) {
+        if (!json_string_member(body, len, "path", key, key_cap)) key[0] = '\0';
+        return key[0] ? SK_OUT_NOTIFICATION : SK_OUT_OTHER;
+    }
+    return SK_OUT_OTHER;
+}
+
+int sk_outbox_discard_kind(SkOutbox *box, SkOutKind kind) {
+    int n = 0;
+    for (int i = 0; i < SK_OUTBOX_SLOTS; i++) {
+        SkOutMsg &m = box->slots[i];
+        if (m.used && m.kind == kind) {
+            m.used = false;
+            box->count--;
+            n++;
+        }
+    }
+    box->stats.coalesced += n;
+    return n;
+}
+
+int sk_outbox_drain(SkOutbox *box, sk_outbox_send_fn send, void *ctx) {
+    int sent = 0;
+    while (box->count > 0) {
+        int i = find_oldest(box, false);
+        SkOutMsg &m = box->slots[i];
+        if (!send((SkOutKind)m.kind, m.body, m.len, ctx)) break;
+        m.used = false;
+        box->count--;
+        box->stats.sent++;
+        sent++;
+    }
+    return sent;
+}
@@ -0,0 +1,81 @@
+#ifndef SIGNALK_OUTBOX_H
+#define SIGNALK_OUTBOX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Typed, coalescing queue for messages waiting to go out over the Signal K
+// WebSocket.
+//
+// All buffers are preallocated. A message is queued under a kind and a key
+// (subscription context, PUT/notification path); queuing another message
+// with the same kind and key replaces the queued copy instead of adding a
+// second one, so a reconnect sends only the newest version of each. Keyless
+// messages are never coalesced. When full, the oldest keyless message is
+// dropped first, then the oldest message of any kind.
+//
+// Not thread-safe on its own; the caller serialises access.
+// Plain C++ with no Arduino dependencies so it can also be built on a host.
+
+#ifndef SK_OUTBOX_SLOTS
+#define SK_OUTBOX_SLOTS 8
+#endif
+#ifndef SK_OUTBOX_MSG_MAX
+#define SK_OUTBOX_MSG_MAX 1536      // longest message body (incl. terminator)
+#endif
+#define SK_OUTBOX_KEY_MAX 96
+
+enum SkOutKind : uint8_t {
+    SK_OUT_OTHER = 0,        // never coalesced
+    SK_OUT_SUBSCRIBE,        // keyed by context
+    SK_OUT_UNSUBSCRIBE,      // keyed by context; never replaces a subscribe
+    SK_OUT_NOTIFICATION,     // keyed by notification path
+    SK_OUT_PUT,              // keyed by target path
+};
+
+struct SkOutboxStats {
+    uint32_t enqueued;       // messages accepted
+    uint32_t coalesced;      // queued copies replaced by a newer one
+    uint32_t dropped;        // evicted because the queue was full
+    uint32_t oversize;       // rejected, longer than SK_OUTBOX_MSG_MAX
+    uint32_t sent;           // handed to the transport
+};
+
+struct SkOutMsg {
+    uint8_t kind;
+    bool used;
+    uint16_t len;
+    uint32_t seq;            // enqueue order; lower is older
+    char key[SK_OUTBOX_KEY_MAX];
+    char body[SK_OUTBOX_MSG_MAX];
+};
+
+struct SkOutbox {
+    SkOutMsg slots[SK_OUTBOX_SLOTS];
+    uint8_t count;
+    uint32_t next_seq;
+    SkOutboxStats stats;
+};
+
+// Empty the queue and reset the counters.
+void sk_outbox_init(SkOutbox *box);
+
+// Queue `body` under `kind`/`key` (key may be NULL or empty for keyless).
+// Returns false only when the message is too long to be queued.
+bool sk_outbox_push(SkOutbox *box, SkOutKind kind, const char *key, const char *body, size_t len);
+
+// Guess kind and key from a Signal K JSON message (subscribe or unsubscribe
+// context, PUT path, notifications.* path). `key` receives at most
+// `key_cap` - 1 characters and is empty for keyless messages.
+SkOutKind sk_outbox_classify(const char *body, size_t len, char *key, size_t key_cap);
+
+// Discard every queued message of `kind` (counted as coalesced): used when a
+// fresher copy is about to be sent directly.
+int sk_outbox_discard_kind(SkOutbox *box, SkOutKind kind);
+
+// Send queued messages oldest first. `send` returns false to stop (e.g. the
+// connection dropped); that message stays queued. Returns the number sent.
+typedef bool (*sk_outbox_send_fn)(SkOutKind kind, const char *body, size_t len, void *ctx);
+int sk_outbox_drain(SkOutbox *box, sk_outbox_send_fn send, void *ctx);
+
+#endif // SIGNALK_OUTBOX_H
@@ -0,0 +1,67 @@
+#include "signalk_path_index.h"
+#include <string.h>
+
+static_assert((SK_PATH_INDEX_BUCKETS & (SK_PATH_INDEX_BUCKETS - 1)) == 0,
+              "SK_PATH_INDEX_BUCKETS must be a power of two");
+static_assert(SK_PATH_INDEX_BUCKETS > SK_PATH_INDEX_CAPACITY,
+              "index needs at least one free bucket to terminate probes");
+static_assert(SK_PATH_INDEX_CAPACITY <= 127, "entry ids are stored as int8_t");
+
+uint32_t sk_path_hash(const char *path, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)path[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void sk_path_index_clear(SkPathIndex *idx) {
+    memset(idx->buckets, -1, sizeof(idx->buckets));
+    idx->count = 0;
+}
+
+// Returns the bucket holding `path`, or the empty bucket where it would go.
+static int probe(const SkPathIndex *idx, const char *path, size_t len, uint32_t hash) {
+    uint32_t b = hash & (SK_PATH_INDEX_BUCKETS - 1);
+    for (;;) {
+        int8_t id = idx->buckets[b];
+        if (id < 0) return (int)b;
+        const SkPathEntry &e = idx->entries[id];
+        if (e.hash == hash && e.len == len && memcmp(e.path, path, len) == 0) return (int)b;
+        b = (b + 1) & (SK_PATH_INDEX_BUCKETS - 1);
+    }
+}
+
+int sk_path_index_add(SkPathIndex *idx, const char *path, size_t len, int slot) {
+    if (len == 0 || len >= SK_PATH_MAX_LEN) return -1;
+    if (slot < 0 || slot >= SK_PATH_INDEX_MAX_SLOTS) return -1;
+    uint32_t hash = sk_path_hash(path, len);
+    int b = probe(idx, path, len, hash);
+    int8_t id = idx->buckets[b];
+    if (id < 0) {
+        if (idx->count >= SK_PATH_INDEX_CAPACITY) return -1;
+        id = (int8_t)idx->count++;
+        SkPathEntry &e = idx->entries[id];
+        e.hash = hash;
+        e.len = (uint16_t)len;
+        memcpy(e.path, path, len);
+        e.path[len] = '\0';
+        e.slot_mask = 0;
+        e.refcount = 0;
+        idx->buckets[b] = id;
+    }
+    SkPathEntry &e = idx->entries[id];
+    uint32_t bit = 1u << slot;
+    if ((e.slot_mask & bit) == 0) {
+        e.slot_mask |= bit;
+        e.refcount++;
+    }
+    return id;
+}
+
+const SkPathEntry *sk_path_index_find(const SkPathIndex *idx, const char *path, size_t len) {
+    if (len == 0 || len >= SK_PATH_MAX_LEN || idx->count == 0) return NULL;
+    int8_t id = idx->buckets[probe(idx, path, len, sk_path_hash(path, len))];
+    return id < 0 ? NULL : &idx->entries[id];
+}
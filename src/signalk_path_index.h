@@ -0,0 +1,57 @@
+#ifndef SIGNALK_PATH_INDEX_H
+#define SIGNALK_PATH_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Hashed Signal K path -> slot index.
+//
+// Built once whenever the configured paths change; afterwards each incoming
+// delta value is routed with one hash + one probe instead of comparing the
+// path against every slot. A path shared by several gauges is stored once
+// and fans out to all of its slots through `slot_mask`. The entries array is
+// also the canonical subscription set: one entry per unique path, in the
+// order the paths were first seen.
+//
+// Plain C++ with no Arduino dependencies so it can also be built on a host.
+
+#ifndef SK_PATH_MAX_LEN
+#define SK_PATH_MAX_LEN 96          // longest path kept (incl. terminator)
+#endif
+#ifndef SK_PATH_INDEX_CAPACITY
+#define SK_PATH_INDEX_CAPACITY 32   // unique paths
+#endif
+#ifndef SK_PATH_INDEX_BUCKETS
+#define SK_PATH_INDEX_BUCKETS 64    // open-addressing table, power of two
+#endif
+#define SK_PATH_INDEX_MAX_SLOTS 32  // slot_mask width
+
+struct SkPathEntry {
+    uint32_t hash;
+    uint16_t len;
+    char path[SK_PATH_MAX_LEN];
+    uint32_t slot_mask;             // bit i set => feeds sensor slot i
+    uint8_t refcount;               // number of slots consuming this path
+};
+
+struct SkPathIndex {
+    SkPathEntry entries[SK_PATH_INDEX_CAPACITY];
+    int8_t buckets[SK_PATH_INDEX_BUCKETS];   // entry id or -1
+    uint8_t count;
+};
+
+// FNV-1a over `len` bytes.
+uint32_t sk_path_hash(const char *path, size_t len);
+
+// Remove all entries.
+void sk_path_index_clear(SkPathIndex *idx);
+
+// Register `slot` as a consumer of `path`. Empty paths are ignored.
+// Returns the entry id, or -1 when the path is too long, the slot is out of
+// range or the index is full.
+int sk_path_index_add(SkPathIndex *idx, const char *path, size_t len, int slot);
+
+// Look up a path. Returns NULL when no slot is subscribed to it.
+const SkPathEntry *sk_path_index_find(const SkPathIndex *idx, const char *path, size_t len);
+
+#endif // SIGNALK_PATH_INDEX_H
@@ -0,0 +1,84 @@
+#ifndef SIGNALK_RECORD_FORMAT_H
+#define SIGNALK_RECORD_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// On-disk format of Signal K stream recordings (.skr).
+//
+//   header   "SKR1", u16 version, u16 flags, u32 start_ms (millis() at the
+//            first frame), u32 reserved; little endian, 16 bytes
+//   record   varint dt_ms (since the previous record), varint len,
+//            len bytes of the raw WebSocket text frame
+//   gap      varint dt_ms, varint 0, varint n: n frames were not recorded
+//            because the writer fell behind
+//
+// Shared by the firmware recorder and the host replayer (scripts/sk_replay.cpp),
+// so it is plain C++ with inline helpers only.
+
+#define SKR_MAGIC "SKR1"
+#define SKR_VERSION 1
+#define SKR_HEADER_SIZE 16
+#define SKR_MAX_VARINT 5
+
+struct SkrHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t flags;
+    uint32_t start_ms;
+    uint32_t reserved;
+};
+
+static inline void skr_put_u16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void skr_put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+static inline uint16_t skr_get_u16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t skr_get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void skr_encode_header(uint8_t out[SKR_HEADER_SIZE], uint32_t start_ms) {
+    memcpy(out, SKR_MAGIC, 4);
+    skr_put_u16(out + 4, SKR_VERSION);
+    skr_put_u16(out + 6, 0);
+    skr_put_u32(out + 8, start_ms);
+    skr_put_u32(out + 12, 0);
+}
+
+// Returns false if the magic or version does not match.
+static inline bool skr_decode_header(const uint8_t in[SKR_HEADER_SIZE], SkrHeader *h) {
+    memcpy(h->magic, in, 4);
+    h->version = skr_get_u16(in + 4);
+    h->flags = skr_get_u16(in + 6);
+    h->start_ms = skr_get_u32(in + 8);
+    h->reserved = skr_get_u32(in + 12);
+    return memcmp(h->magic, SKR_MAGIC, 4) == 0 && h->version == SKR_VERSION;
+}
+
+// LEB128 unsigned varint. Returns the number of bytes written (<= 5).
+static inline size_t skr_put_varint(uint8_t *out, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+// Returns the number of bytes consumed, 0 if truncated or malformed.
+static inline size_t skr_get_varint(const uint8_t *in, size_t avail, uint32_t *v) {
+    uint32_t r = 0;
+    for (size_t i = 0; i < avail && i < SKR_MAX_VARINT; i++) {
+        r |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+        if ((in[i] & 0x80) == 0) {
+            *v = r;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+#endif // SIGNALK_RECORD_FORMAT_H
@@ -0,0 +1,176 @@
+#include "signalk_recorder.h"
+#include "signalk_record_format.h"
+#define DIAG_TAG "SKRec"
+#define DIAG_MODULE_LEVEL DIAG_LEVEL_SIGNALK
+#include "diag_log.h"
+#include <FS.h>
+#include <SD_MMC.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static const uint32_t RING_SIZE = 256 * 1024;                  // power of two
+static const uint32_t WRITE_CHUNK = 4096;
+static const uint32_t MAX_FILE_BYTES = 64UL * 1024 * 1024;     // then stop
+static const uint32_t FLUSH_INTERVAL_MS = 1000;
+static const char *REC_DIR = "/recordings";
+
+static_assert((RING_SIZE & (RING_SIZE - 1)) == 0, "RING_SIZE must be a power of two");
+
+static uint8_t *ring = NULL;
+static volatile uint32_t ring_head = 0;   // written by the WS task
+static volatile uint32_t ring_tail = 0;   // written by the writer task
+static volatile bool recording = false;
+static volatile bool stop_requested = false;
+static TaskHandle_t writer_task_handle = NULL;
+static File rec_file;
+
+// Producer state (WS task only)
+static uint32_t last_rx_ms = 0;
+static uint32_t pending_gap = 0;
+
+static SkRecStats stats = {};
+
+static void ring_put(uint32_t at, const uint8_t *src, size_t n) {
+    uint32_t off = at & (RING_SIZE - 1);
+    size_t first = RING_SIZE - off;
+    if (first > n) first = n;
+    memcpy(ring + off, src, first);
+    if (n > first) memcpy(ring, src + first, n - first);
+}
+
+void sk_rec_frame(const uint8_t *payload, size_t len, uint32_t rx_ms) {
+    if (!recording) return;
+    uint8_t hdr[3 * SKR_MAX_VARINT];
+    size_t hdr_len = 0;
+    uint32_t dt = rx_ms - last_rx_ms;
+    if (pending_gap) {
+        // Mark the frames lost since the last record, then this one at dt 0
+        hdr_len += skr_put_varint(hdr + hdr_len, dt);
+        hdr_len += skr_put_varint(hdr + hdr_len, 0);
+        hdr_len += skr_put_varint(hdr + hdr_len, pending_gap);
+        dt = 0;
+    }
+    uint8_t rec[2 * SKR_MAX_VARINT];
+    size_t rec_len = skr_put_varint(rec, dt);
+    rec_len += skr_put_varint(rec + rec_len, (uint32_t)len);
+
+    uint32_t head = ring_head;
+    uint32_t used = head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+    size_t need = hdr_len + rec_len + len;
+    if (len == 0 || need > RING_SIZE - used) {
+        pending_gap++;
+        stats.dropped++;
+        return;
+    }
+    ring_put(head, hdr, hdr_len);
+    ring_put(head + hdr_len, rec, rec_len);
+    ring_put(head + hdr_len + rec_len, payload, len);
+    __atomic_store_n(&ring_head, head + (uint32_t)need, __ATOMIC_RELEASE);
+    last_rx_ms = rx_ms;
+    pending_gap = 0;
+    stats.frames++;
+}
+
+static void writer_task(void *param) {
+    (void)param;
+    uint32_t last_flush = millis();
+    for (;;) {
+        uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+        uint32_t tail = ring_tail;
+        if (head == tail) {
+            if (stop_requested) break;
+            vTaskDelay(pdMS_TO_TICKS(50));
+            continue;
+        }
+        uint32_t off = tail & (RING_SIZE - 1);
+        uint32_t chunk = head - tail;
+        if (chunk > RING_SIZE - off) chunk = RING_SIZE - off;
+        if (chunk > WRITE_CHUNK) chunk = WRITE_CHUNK;
+        size_t written = rec_file.write(ring + off, chunk);
+        __atomic_store_n(&ring_tail, tail + chunk, __ATOMIC_RELEASE);
+        stats.bytes += written;
+        if (written != chunk) {
+            DIAG_E("SD write failed, recording stopped");
+            recording = false;
+            stop_requested = true;
+        }
+        if (stats.bytes >= MAX_FILE_BYTES && recording) {
+            DIAG_W("recording reached %lu bytes, stopping", (unsigned long)MAX_FILE_BYTES);
+            recording = false;
+            stop_requested = true;
+        }
+        if (millis() - last_flush >= FLUSH_INTERVAL_MS) {
+            rec_file.flush();
+            last_flush = millis();
+        }
+    }
+    rec_file.close();
+    DIAG_I("recording %s closed: %lu frames, %lu bytes, %lu dropped", stats.file,
+           (unsigned long)stats.frames, (unsigned long)stats.bytes, (unsigned long)stats.dropped);
+    recording = false;
+    stats.recording = false;
+    writer_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+bool sk_rec_start() {
+    if (recording || writer_task_handle != NULL) return false;
+    if (SD_MMC.cardType() == CARD_NONE) {
+        DIAG_W("no SD card, cannot record");
+        return false;
+    }
+    if (ring == NULL) {
+        ring = (uint8_t *)heap_caps_malloc(RING_SIZE, MALLOC_CAP_SPIRAM);
+        if (ring == NULL) {
+            DIAG_E("PSRAM ring allocation failed, cannot record");
+            return false;
+        }
+    }
+    if (!SD_MMC.exists(REC_DIR)) SD_MMC.mkdir(REC_DIR);
+    char path[32];
+    int n = 1;
+    for (; n <= 9999; n++) {
+        snprintf(path, sizeof(path), "%s/sk_%04d.skr", REC_DIR, n);
+        if (!SD_MMC.exists(path)) break;
+    }
+    if (n > 9999) {
+        DIAG_W("no free recording file name");
+        return false;
+    }
+    rec_file = SD_MMC.open(path, FILE_WRITE);
+    if (!rec_file) {
+        DIAG_E("cannot create %s", path);
+        return false;
+    }
+
+    uint32_t start_ms = millis();
+    uint8_t header[SKR_HEADER_SIZE];
+    skr_encode_header(header, start_ms);
+    rec_file.write(header, sizeof(header));
+
+    memset(&stats, 0, sizeof(stats));
+    strncpy(stats.file, path, sizeof(stats.file) - 1);
+    stats.bytes = sizeof(header);
+    stats.recording = true;
+    ring_head = 0;
+    ring_tail = 0;
+    last_rx_ms = start_ms;
+    pending_gap = 0;
+    stop_requested = false;
+    xTaskCreatePinnedToCore(writer_task, "sk_rec", 4096, NULL, 1, &writer_task_handle, 0);
+    recording = true;
+    DIAG_I("recording Signal K frames to %s", path);
+    return true;
+}
+
+void sk_rec_stop() {
+    if (!recording) return;
+    // The producer stops first; the writer drains the ring and closes the file
+    recording = false;
+    stop_requested = true;
+}
+
+void sk_rec_get_stats(SkRecStats *out) {
+    *out = stats;
+}
@@ -0,0 +1,32 @@
+#ifndef SIGNALK_RECORDER_H
+#define SIGNALK_RECORDER_H
+
+#include <Arduino.h>
+
+// Records the raw Signal K WebSocket frames with their receive time to SD
+// (/recordings/sk_NNNN.skr, format in signalk_record_format.h), for replay on
+// a host with scripts/sk_replay.cpp.
+//
+// The WS task only copies each frame into a PSRAM ring; a low-priority task
+// writes the ring to the card, so a slow card never stalls ingest. Frames
+// that do not fit in the ring are counted and marked as a gap in the file.
+
+struct SkRecStats {
+    bool recording;
+    uint32_t frames;          // frames written to the current/last file
+    uint32_t bytes;           // file size so far
+    uint32_t dropped;         // frames lost to a full ring
+    char file[32];
+};
+
+// Start a new recording. Returns false if the SD card or the ring is not
+// available, or a recording is already running.
+bool sk_rec_start();
+void sk_rec_stop();
+
+// Called by the WS task for every text frame. Cheap when not recording.
+void sk_rec_frame(const uint8_t *payload, size_t len, uint32_t rx_ms);
+
+void sk_rec_get_stats(SkRecStats *out);
+
+#endif // SIGNALK_RECORDER_H
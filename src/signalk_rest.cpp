@@ -0,0 +1,157 @@
+#include "signalk_rest.h"
+#include "signalk_auth.h"
+#define DIAG_TAG "SignalK"
+#define DIAG_MODULE_LEVEL DIAG_LEVEL_SIGNALK
+#include "diag_log.h"
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <ArduinoJson.h>
+
+static const uint16_t REST_TIMEOUT_MS = 2000;
+static const char *VESSELS_SELF_URI = "/signalk/v1/api/vessels/self";
+static const int MAX_SEGS = 12;          // path depth handled
+
+static WiFiClient rest_client;
+static HTTPClient rest_http;
+static SkRestStats stats = {};
+
+String build_signalk_url(const String &path) {
+    String cleaned = path;
+    cleaned.trim();
+    cleaned.replace(".", "/");
+    return String(VESSELS_SELF_URI) + "/" + cleaned;
+}
+
+// Split a dotted path into NUL-terminated segments inside `buf`.
+// Returns the number of segments, 0 if the path does not fit.
+static int split_path(const char *path, char *buf, size_t buf_len, const char **segs, int max_segs) {
+    size_t len = strlen(path);
+    if (len == 0 || len >= buf_len) return 0;
+    memcpy(buf, path, len + 1);
+    int n = 0;
+    char *start = buf;
+    for (char *p = buf; ; p++) {
+        if (*p == '.' || *p == '\0') {
+            bool end = *p == '\0';
+            *p = '\0';
+            if (*start != '\0') {
+                if (n == max_segs) return 0;
+                segs[n++] = start;
+            }
+            if (end) break;
+            start = p + 1;
+        }
+    }
+    return n;
+}
+
+static void add_leaf_filter(JsonVariant node) {
+    node["value"] = true;
+    node["timestamp"] = true;
+    node["$source"] = true;
+}
+
+static void deliver_leaf(JsonVariantConst leaf, const char *path, sk_rest_value_cb cb, void *ctx, int *delivered) {
+    JsonVariantConst v = leaf["value"];
+    if (!v.is<float>()) return;
+    const char *ts = leaf["timestamp"] | (const char *)NULL;
+    const char *src = leaf["$source"] | (const char *)NULL;
+    SkDeltaMeta meta = { ts, ts ? strlen(ts) : 0, src, src ? strlen(src) : 0 };
+    cb(path, strlen(path), v.as<float>(), &meta, ctx);
+    (*delivered)++;
+}
+
+int sk_rest_poll(const String &host, uint16_t port, const String &auth,
+                 const char *const *paths, int count, sk_rest_value_cb cb, void *ctx) {
+    if (count <= 0) return 0;
+    if (WiFi.status() != WL_CONNECTED) return -1;
+
+    bool batch = count > 1;
+    String uri = batch ? String(VESSELS_SELF_URI) : build_signalk_url(paths[0]);
+
+    // Keep only the requested leaves of the (possibly large) response
+    DynamicJsonDocument filter(1024);
+    char seg_buf[128];
+    const char *segs[MAX_SEGS];
+    JsonObject filter_root = filter.to<JsonObject>();
+    if (batch) {
+        for (int i = 0; i < count; i++) {
+            int n = split_path(paths[i], seg_buf, sizeof(seg_buf), segs, MAX_SEGS);
+            if (n == 0) continue;
+            JsonVariant node = filter_root;
+            for (int s = 0; s < n; s++) {
+                JsonVariant next = node[segs[s]];
+                if (next.isNull()) next = node[segs[s]].to<JsonObject>();
+                node = next;
+            }
+            add_leaf_filter(node);
+        }
+    } else {
+        add_leaf_filter(filter_root);
+    }
+
+    uint32_t t0 = millis();
+    if (rest_client.connected()) stats.reused++;
+    rest_http.setReuse(true);
+    rest_http.setTimeout(REST_TIMEOUT_MS);
+    rest_http.setConnectTimeout(REST_TIMEOUT_MS);
+    if (!rest_http.begin(rest_client, host, port, uri)) {
+        stats.errors++;
+        return -1;
+    }
+    if (auth.length() > 0) rest_http.addHeader("Authorization", auth);
+    int code = rest_http.GET();
+    stats.requests++;
+    if (batch) stats.batched++;
+    stats.last_http_code = (int16_t)code;
+    if (code != 200) {
+        stats.errors++;
+        rest_http.end();
+        if (code == 401) sk_auth_on_unauthorized();
+        else if (code < 0) rest_client.stop();
+        DIAG_W("REST GET %s failed HTTP %d", uri.c_str(), code);
+        return -1;
+    }
+
+    DynamicJsonDocument doc(2048);
+    DeserializationError err;
+    if (rest_http.getSize() >= 0) {
+        // Stream straight from the socket through the filter
+        err = deserializeJson(doc, rest_client, DeserializationOption::Filter(filter));
+    } else {
+        // Chunked body: let HTTPClient de-chunk it
+        err = deserializeJson(doc, rest_http.getString(), DeserializationOption::Filter(filter));
+    }
+    rest_http.end();   // keeps the connection open when the server allows it
+    stats.last_ms = millis() - t0;
+    if (err) {
+        stats.errors++;
+        rest_client.stop();
+        DIAG_W("REST response for %s not parseable: %s", uri.c_str(), err.c_str());
+        return -1;
+    }
+
+    int delivered = 0;
+    if (batch) {
+        for (int i = 0; i < count; i++) {
+            int n = split_path(paths[i], seg_buf, sizeof(seg_buf), segs, MAX_SEGS);
+            if (n == 0) continue;
+            JsonVariantConst node = doc.as<JsonVariantConst>();
+            for (int s = 0; s < n && !node.isNull(); s++) node = node[segs[s]];
+            if (!node.isNull()) deliver_leaf(node, paths[i], cb, ctx, &delivered);
+        }
+    } else {
+        deliver_leaf(doc.as<JsonVariantConst>(), paths[0], cb, ctx, &delivered);
+    }
+    stats.values += delivered;
+    return delivered;
+}
+
+void sk_rest_end() {
+    rest_http.end();
+    rest_client.stop();
+}
+
+void sk_rest_get_stats(SkRestStats *out) {
+    *out = stats;
+}
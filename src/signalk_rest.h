@@ -0,0 +1,44 @@
+#ifndef SIGNALK_REST_H
+#define SIGNALK_REST_H
+
+#include <Arduino.h>
+#include "signalk_delta_parser.h"   // SkDeltaMeta
+
+// Signal K REST polling, the fallback when the WebSocket stream cannot be
+// established (proxies that drop upgrades, old servers).
+//
+// Requests go over one keep-alive HTTP connection. Several paths are fetched
+// with a single GET of /signalk/v1/api/vessels/self, parsed through an
+// ArduinoJson filter so only the requested leaves are kept in memory; a
+// lone path is fetched from its own URL. Scheduling (which paths are due)
+// is left to the caller.
+
+struct SkRestStats {
+    uint32_t requests;       // HTTP requests sent
+    uint32_t batched;        // of which /vessels/self batch requests
+    uint32_t reused;         // requests sent on an already open connection
+    uint32_t values;         // values delivered
+    uint32_t errors;         // transport/HTTP/parse failures
+    uint32_t last_ms;        // duration of the last request
+    int16_t last_http_code;
+};
+
+// Called for every requested path that had a numeric value.
+typedef void (*sk_rest_value_cb)(const char *path, size_t path_len, float value,
+                                 const SkDeltaMeta *meta, void *ctx);
+
+// "propulsion.port.revolutions" -> "/signalk/v1/api/vessels/self/propulsion/port/revolutions"
+String build_signalk_url(const String &path);
+
+// Fetch `count` dotted paths from host:port. `auth` is a full Authorization
+// header value or empty. Returns the number of values delivered, or -1 on
+// failure (a 401 is reported to the auth module).
+int sk_rest_poll(const String &host, uint16_t port, const String &auth,
+                 const char *const *paths, int count, sk_rest_value_cb cb, void *ctx);
+
+// Close the keep-alive connection.
+void sk_rest_end();
+
+void sk_rest_get_stats(SkRestStats *out);
+
+#endif // SIGNALK_REST_H
@@ -11,6 +11,9 @@
 #include <strings.h>
 #include <math.h>
 #include "esp_log.h"
+#define DIAG_TAG "ui_helpers"
+#define DIAG_MODULE_LEVEL DIAG_LEVEL_UI
+#include "diag_log.h"
 
 static const char *TAG_UI_HELPERS = "ui_helpers";
 
@@ -287,14 +290,14 @@ void _ui_apply_icon_style(lv_obj_t *img, int screen, int gauge)
    if (gauge < 0 || gauge > 1) return;
 
    const char *icon_path = screen_configs[screen].icon_paths[gauge];
-   ESP_LOGW(TAG_UI_HELPERS, "[ICON INIT] screen=%d gauge=%d path='%s'", screen, gauge, (icon_path ? icon_path : "NULL"));
+   DIAG_D("[ICON INIT] screen=%d gauge=%d path='%s'", screen, gauge, (icon_path ? icon_path : "NULL"));
 
    // If no icon path is configured, clear any stale image source and keep hidden.
    if (!icon_path || icon_path[0] == '\0') {
       lv_img_set_src(img, NULL);
       lv_obj_set_style_img_opa(img, LV_OPA_TRANSP, LV_PART_MAIN);
       lv_obj_add_flag(img, LV_OBJ_FLAG_HIDDEN);
-      ESP_LOGW(TAG_UI_HELPERS, "[ICON INIT] screen=%d gauge=%d empty path - cleared src and hid icon", screen, gauge);
+      DIAG_D("[ICON INIT] screen=%d gauge=%d empty path - cleared src and hid icon", screen, gauge);
       lv_obj_invalidate(img);
       return;
    }
@@ -303,7 +306,7 @@ void _ui_apply_icon_style(lv_obj_t *img, int screen, int gauge)
    // bottom icon remains hidden and skip further styling.
    if (gauge == 1 && screen_configs[screen].show_bottom == 0) {
       lv_obj_add_flag(img, LV_OBJ_FLAG_HIDDEN);
-      ESP_LOGW(TAG_UI_HELPERS, "[ICON INIT] screen=%d gauge=%d bottom disabled - hiding icon", screen, gauge);
+      DIAG_D("[ICON INIT] screen=%d gauge=%d bottom disabled - hiding icon", screen, gauge);
       return;
    }
 
@@ -326,7 +329,7 @@ void _ui_apply_icon_style(lv_obj_t *img, int screen, int gauge)
 
    // Diagnostic: Print transparent value for Min2 (zone 2) at runtime
    if (chosen_zone == 2) {
-      ESP_LOGI(TAG_UI_HELPERS, "[DIAG] Min2 zone selected: screen=%d gauge=%d color='%s' transparent=%d min=%.2f max=%.2f runtime=%.2f",
+      DIAG_D("[DIAG] Min2 zone selected: screen=%d gauge=%d color='%s' transparent=%d min=%.2f max=%.2f runtime=%.2f",
          screen, gauge, screen_configs[screen].color[gauge][2], screen_configs[screen].transparent[gauge][2],
          screen_configs[screen].min[gauge][2], screen_configs[screen].max[gauge][2], runtime_value);
    }
@@ -334,7 +337,7 @@ void _ui_apply_icon_style(lv_obj_t *img, int screen, int gauge)
    // Extra diagnostics for Screen 1, Gauge 1 (fuel icon)
    if (screen == 1 && gauge == 1) {
       bool is_hidden = lv_obj_has_flag(img, LV_OBJ_FLAG_HIDDEN);
-      ESP_LOGI(TAG_UI_HELPERS, "[DIAG] Fuel icon: screen=%d gauge=%d chosen_zone=%d runtime=%.2f hidden=%d",
+      DIAG_D("[DIAG] Fuel icon: screen=%d gauge=%d chosen_zone=%d runtime=%.2f hidden=%d",
          screen, gauge, chosen_zone, runtime_value, is_hidden);
    }
 
@@ -413,7 +416,7 @@ void _ui_apply_icon_style(lv_obj_t *img, int screen, int gauge)
    bool final_hidden = lv_obj_has_flag(img, LV_OBJ_FLAG_HIDDEN);
    uint8_t final_opa = lv_obj_get_style_img_opa(img, LV_PART_MAIN);
    lv_img_src_t src_type = lv_img_src_get_type((const void*)screen_configs[screen].icon_paths[gauge]);
-   ESP_LOGW(TAG_UI_HELPERS, "[ICON FINAL] screen=%d gauge=%d hidden=%d opa=%d src_type=%d", 
+   DIAG_D("[ICON FINAL] screen=%d gauge=%d hidden=%d opa=%d src_type=%d", 
       screen, gauge, final_hidden, final_opa, src_type);
    
       /* Apply configured icon position (override default UI-generated coords).